@@ -0,0 +1,321 @@
+#include "databender.h"
+#include "DataBenderEngine.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <new>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DATABENDER_CAPI_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define DATABENDER_CAPI_NEON 1
+#endif
+
+static_assert(sizeof(databender_segment) == sizeof(CaptureSegment), "databender_segment must match CaptureSegment");
+
+// An engine plus the scratch the interleaved and mono paths go through, and
+// the meters other threads read
+struct databender_engine {
+    static constexpr int CHUNK = 256;
+
+    DataBenderEngine engine;
+
+    alignas(CACHE_LINE_SIZE) float scratchL[CHUNK];
+    float scratchR[CHUNK];
+    float scratchOutL[CHUNK];
+    float scratchOutR[CHUNK];
+
+    std::atomic<float> inputPeak[2];
+    std::atomic<float> inputRms[2];
+    std::atomic<float> outputPeak[2];
+    std::atomic<float> outputRms[2];
+    std::atomic<int> frozen{0};
+    std::atomic<float> playbackSpeed{1.0f};
+    std::atomic<float> repeats{0.0f};
+    std::atomic<int> onsetCount{0};
+    std::atomic<int> trimmedLength{0};
+};
+
+namespace {
+
+// Peak and sum of squares over one call, built up chunk by chunk
+struct Levels {
+    float peak[2] = {};
+    float sumSquares[2] = {};
+    int frames = 0;
+};
+
+void measure(const float* data, int numFrames, float& peak, float& sumSquares) {
+    if (!data) {
+        return;
+    }
+
+    // Independent lanes, so the loop vectorizes
+    float peaks[8] = {};
+    float sums[8] = {};
+    int i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        for (int lane = 0; lane < 8; ++lane) {
+            float sample = data[i + lane];
+            peaks[lane] = std::max(peaks[lane], std::fabs(sample));
+            sums[lane] += sample * sample;
+        }
+    }
+    for (; i < numFrames; ++i) {
+        peaks[0] = std::max(peaks[0], std::fabs(data[i]));
+        sums[0] += data[i] * data[i];
+    }
+    for (int lane = 0; lane < 8; ++lane) {
+        peak = std::max(peak, peaks[lane]);
+        sumSquares += sums[lane];
+    }
+}
+
+void publishLevels(const Levels& levels, std::atomic<float>* peak, std::atomic<float>* rms) {
+    for (int channel = 0; channel < 2; ++channel) {
+        float meanSquare = levels.frames > 0 ? levels.sumSquares[channel] / levels.frames : 0.0f;
+        peak[channel].store(levels.peak[channel], std::memory_order_relaxed);
+        rms[channel].store(std::sqrt(meanSquare), std::memory_order_relaxed);
+    }
+}
+
+void deinterleave(const float* input, float* left, float* right, int numFrames) {
+    int i = 0;
+#if defined(DATABENDER_CAPI_SSE2)
+    for (; i + 4 <= numFrames; i += 4) {
+        __m128 first = _mm_loadu_ps(input + 2 * i);
+        __m128 second = _mm_loadu_ps(input + 2 * i + 4);
+        _mm_store_ps(left + i, _mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_store_ps(right + i, _mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+#elif defined(DATABENDER_CAPI_NEON)
+    for (; i + 4 <= numFrames; i += 4) {
+        float32x4x2_t frames = vld2q_f32(input + 2 * i);
+        vst1q_f32(left + i, frames.val[0]);
+        vst1q_f32(right + i, frames.val[1]);
+    }
+#endif
+    for (; i < numFrames; ++i) {
+        left[i] = input[2 * i];
+        right[i] = input[2 * i + 1];
+    }
+}
+
+void interleave(const float* left, const float* right, float* output, int numFrames) {
+    int i = 0;
+#if defined(DATABENDER_CAPI_SSE2)
+    for (; i + 4 <= numFrames; i += 4) {
+        __m128 l = _mm_load_ps(left + i);
+        __m128 r = _mm_load_ps(right + i);
+        _mm_storeu_ps(output + 2 * i, _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(output + 2 * i + 4, _mm_unpackhi_ps(l, r));
+    }
+#elif defined(DATABENDER_CAPI_NEON)
+    for (; i + 4 <= numFrames; i += 4) {
+        float32x4x2_t frames = { { vld1q_f32(left + i), vld1q_f32(right + i) } };
+        vst2q_f32(output + 2 * i, frames);
+    }
+#endif
+    for (; i < numFrames; ++i) {
+        output[2 * i] = left[i];
+        output[2 * i + 1] = right[i];
+    }
+}
+
+// One engine call, metered
+void processMetered(databender_engine* wrapper, const float* left, const float* right,
+                    float* outputL, float* outputR, int numFrames, Levels& in, Levels& out) {
+    const float* inputs[2] = { left, right };
+    float* outputs[2] = { outputL, outputR };
+    measure(left, numFrames, in.peak[0], in.sumSquares[0]);
+    measure(right, numFrames, in.peak[1], in.sumSquares[1]);
+    wrapper->engine.process(inputs, outputs, numFrames);
+    measure(outputL, numFrames, out.peak[0], out.sumSquares[0]);
+    measure(outputR, numFrames, out.peak[1], out.sumSquares[1]);
+    in.frames += numFrames;
+    out.frames += numFrames;
+}
+
+void finishCall(databender_engine* wrapper, const Levels& in, const Levels& out) {
+    publishLevels(in, wrapper->inputPeak, wrapper->inputRms);
+    publishLevels(out, wrapper->outputPeak, wrapper->outputRms);
+    wrapper->onsetCount.store(wrapper->engine.getOnsetCount(), std::memory_order_relaxed);
+    wrapper->trimmedLength.store(wrapper->engine.getTrimmedLength(), std::memory_order_relaxed);
+}
+
+// Readback structs grow at the end: fill what the caller's size covers
+template <typename T>
+int fillSized(T* destination, T source) {
+    if (!destination || destination->size < sizeof(uint32_t)) {
+        return DATABENDER_ERROR_ARGUMENT;
+    }
+    size_t bytes = std::min<size_t>(destination->size, sizeof(T));
+    source.size = static_cast<uint32_t>(bytes);
+    std::memcpy(destination, &source, bytes);
+    return DATABENDER_OK;
+}
+
+} // namespace
+
+uint32_t databender_version(void) {
+    return DATABENDER_API_VERSION;
+}
+
+databender_engine* databender_create(uint32_t api_version, float sample_rate) {
+    if ((api_version >> 16) != DATABENDER_API_VERSION_MAJOR || sample_rate <= 0.0f) {
+        return nullptr;
+    }
+    databender_engine* wrapper = new (std::nothrow) databender_engine();
+    if (!wrapper) {
+        return nullptr;
+    }
+    wrapper->engine.init(sample_rate);
+    return wrapper;
+}
+
+void databender_destroy(databender_engine* engine) {
+    delete engine;
+}
+
+int databender_process_planar(databender_engine* engine, const float* const* inputs,
+                              float* const* outputs, int channels, int num_frames) {
+    if (!engine || !outputs || (channels != 1 && channels != 2) || num_frames < 0) {
+        return DATABENDER_ERROR_ARGUMENT;
+    }
+
+    Levels in, out;
+    const float* left = inputs ? inputs[0] : nullptr;
+    const float* right = inputs ? inputs[channels - 1] : nullptr;
+    if (channels == 2) {
+        // Straight through on the caller's buffers
+        processMetered(engine, left, right, outputs[0], outputs[1], num_frames, in, out);
+    } else {
+        // The input is copied first, since the output may overwrite it
+        for (int offset = 0; offset < num_frames; offset += databender_engine::CHUNK) {
+            int count = std::min(databender_engine::CHUNK, num_frames - offset);
+            const float* chunk = nullptr;
+            if (left) {
+                std::memcpy(engine->scratchL, left + offset, count * sizeof(float));
+                chunk = engine->scratchL;
+            }
+            processMetered(engine, chunk, chunk, outputs[0] + offset, engine->scratchOutR, count, in, out);
+        }
+    }
+    finishCall(engine, in, out);
+    return DATABENDER_OK;
+}
+
+int databender_process_interleaved(databender_engine* engine, const float* input,
+                                   float* output, int channels, int num_frames) {
+    if (channels == 1) {
+        const float* inputs[1] = { input };
+        float* outputs[1] = { output };
+        return databender_process_planar(engine, inputs, outputs, 1, num_frames);
+    }
+    if (!engine || !output || channels != 2 || num_frames < 0) {
+        return DATABENDER_ERROR_ARGUMENT;
+    }
+
+    Levels in, out;
+    for (int offset = 0; offset < num_frames; offset += databender_engine::CHUNK) {
+        int count = std::min(databender_engine::CHUNK, num_frames - offset);
+        const float* left = nullptr;
+        const float* right = nullptr;
+        if (input) {
+            deinterleave(input + 2 * offset, engine->scratchL, engine->scratchR, count);
+            left = engine->scratchL;
+            right = engine->scratchR;
+        }
+        processMetered(engine, left, right, engine->scratchOutL, engine->scratchOutR, count, in, out);
+        interleave(engine->scratchOutL, engine->scratchOutR, output + 2 * offset, count);
+    }
+    finishCall(engine, in, out);
+    return DATABENDER_OK;
+}
+
+void databender_set_freeze(databender_engine* engine, int frozen) {
+    if (engine) {
+        engine->engine.setFreeze(frozen != 0);
+        engine->frozen.store(frozen != 0, std::memory_order_relaxed);
+        engine->onsetCount.store(engine->engine.getOnsetCount(), std::memory_order_relaxed);
+        engine->trimmedLength.store(engine->engine.getTrimmedLength(), std::memory_order_relaxed);
+    }
+}
+
+void databender_set_playback_speed(databender_engine* engine, float speed) {
+    if (engine) {
+        engine->engine.setPlaybackSpeed(speed);
+        engine->playbackSpeed.store(engine->engine.getPlaybackSpeed(), std::memory_order_relaxed);
+    }
+}
+
+void databender_set_repeats(databender_engine* engine, float repeats) {
+    if (engine) {
+        engine->engine.setRepeats(repeats);
+        engine->repeats.store(engine->engine.getRepeats(), std::memory_order_relaxed);
+    }
+}
+
+void databender_set_timing(databender_engine* engine, int enabled) {
+    if (engine) {
+        engine->engine.setTimingEnabled(enabled != 0);
+    }
+}
+
+void databender_clear(databender_engine* engine) {
+    if (engine) {
+        engine->engine.clearBuffer();
+        engine->trimmedLength.store(0, std::memory_order_relaxed);
+    }
+}
+
+int databender_read_meters(const databender_engine* engine, databender_meters* meters) {
+    if (!engine) {
+        return DATABENDER_ERROR_ARGUMENT;
+    }
+    databender_meters levels;
+    for (int channel = 0; channel < 2; ++channel) {
+        levels.input_peak[channel] = engine->inputPeak[channel].load(std::memory_order_relaxed);
+        levels.input_rms[channel] = engine->inputRms[channel].load(std::memory_order_relaxed);
+        levels.output_peak[channel] = engine->outputPeak[channel].load(std::memory_order_relaxed);
+        levels.output_rms[channel] = engine->outputRms[channel].load(std::memory_order_relaxed);
+    }
+    levels.frozen = engine->frozen.load(std::memory_order_relaxed);
+    levels.playback_speed = engine->playbackSpeed.load(std::memory_order_relaxed);
+    levels.repeats = engine->repeats.load(std::memory_order_relaxed);
+    levels.onset_count = engine->onsetCount.load(std::memory_order_relaxed);
+    levels.trimmed_length = engine->trimmedLength.load(std::memory_order_relaxed);
+    return fillSized(meters, levels);
+}
+
+int databender_read_stats(const databender_engine* engine, databender_stats* stats) {
+    if (!engine) {
+        return DATABENDER_ERROR_ARGUMENT;
+    }
+    const EngineStats& engineStats = engine->engine.getStats();
+    EngineStats::Snapshot total = engineStats.getTotal();
+    const AnalysisArena& arena = engine->engine.getAnalysisArena();
+
+    databender_stats values;
+    values.blocks = total.blocks;
+    values.samples = total.samples;
+    values.mean_ns_per_sample = total.meanNsPerSample;
+    values.p99_ns_per_sample = total.p99NsPerSample;
+    values.max_ns_per_sample = total.maxNsPerSample;
+    values.overruns = engineStats.getOverruns();
+    values.analysis_bytes_used = arena.getUsedBytes();
+    values.analysis_bytes_peak = arena.getPeakBytes();
+    values.analysis_budget = arena.getCapacity();
+    values.analysis_overflows = arena.getOverflows();
+    return fillSized(stats, values);
+}
+
+int databender_read_trim_map(const databender_engine* engine, databender_segment* segments, int capacity) {
+    if (!engine || capacity < 0 || (!segments && capacity > 0)) {
+        return DATABENDER_ERROR_ARGUMENT;
+    }
+    return engine->engine.copyTrimMap(reinterpret_cast<CaptureSegment*>(segments), capacity);
+}
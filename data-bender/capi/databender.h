@@ -0,0 +1,128 @@
+#pragma once
+
+// C API for embedding the DataBender engine (libdatabender).
+//
+// Versioning: the major version changes only when existing calls or struct
+// layouts change incompatibly; minor versions only add. Pass
+// DATABENDER_API_VERSION to databender_create() so a library with another
+// major version refuses rather than misbehaves. Readback structs start
+// with their own size, so newer libraries fill only what older callers
+// know about.
+//
+// Memory ownership:
+// - The library owns engines, from databender_create() until
+//   databender_destroy(). Nothing else it allocates is ever handed out.
+// - The caller owns every buffer passed in, and the library keeps no
+//   pointer to one after the call returns. Inputs are only read, so they
+//   can point straight into a read-only mmap'd file.
+// - Planar stereo processing reads and writes the caller's channels
+//   directly (zero-copy). Interleaved and mono processing go through
+//   scratch space inside the engine, a chunk at a time.
+//
+// Threading: one engine is driven from one thread at a time. The process
+// and control calls are real-time safe unless marked otherwise (freezing
+// runs the silence analysis on the calling thread, as the engine does).
+// databender_read_meters() and databender_read_stats() may be called from
+// any thread.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(DATABENDER_BUILDING_LIBRARY)
+#define DATABENDER_API __declspec(dllexport)
+#else
+#define DATABENDER_API __declspec(dllimport)
+#endif
+#else
+#define DATABENDER_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DATABENDER_API_VERSION_MAJOR 1
+#define DATABENDER_API_VERSION_MINOR 0
+#define DATABENDER_API_VERSION ((DATABENDER_API_VERSION_MAJOR << 16) | DATABENDER_API_VERSION_MINOR)
+
+// Status codes returned by calls that can fail
+enum {
+    DATABENDER_OK = 0,
+    DATABENDER_ERROR_ARGUMENT = -1 // Null engine, bad channel count, short struct
+};
+
+typedef struct databender_engine databender_engine;
+
+// Frame range of the capture that holds audio
+typedef struct {
+    int32_t start;
+    int32_t length;
+} databender_segment;
+
+// Levels of the last processed call, per channel (right = left for mono)
+typedef struct {
+    uint32_t size; // sizeof(databender_meters), set by the caller
+    float input_peak[2];
+    float input_rms[2];
+    float output_peak[2];
+    float output_rms[2];
+    int32_t frozen;
+    float playback_speed;
+    float repeats;
+    int32_t onset_count;    // Onsets in the playing take
+    int32_t trimmed_length; // Frames the trimmed take plays, 0 when raw
+} databender_meters;
+
+// Block timing (only collected with timing enabled) and analysis memory
+typedef struct {
+    uint32_t size; // sizeof(databender_stats), set by the caller
+    uint64_t blocks;
+    uint64_t samples;
+    double mean_ns_per_sample;
+    double p99_ns_per_sample;
+    double max_ns_per_sample;
+    uint64_t overruns;
+    uint64_t analysis_bytes_used;
+    uint64_t analysis_bytes_peak;
+    uint64_t analysis_budget;
+    int32_t analysis_overflows;
+} databender_stats;
+
+// Version the library was built as (DATABENDER_API_VERSION layout)
+DATABENDER_API uint32_t databender_version(void);
+
+// Create an engine for sample_rate, or NULL on a major version mismatch or
+// allocation failure. Not real-time safe.
+DATABENDER_API databender_engine* databender_create(uint32_t api_version, float sample_rate);
+DATABENDER_API void databender_destroy(databender_engine* engine);
+
+// Process num_frames frames of 1 or 2 channels. inputs may be NULL (or
+// hold NULL channels) for silence. Mono input is recorded on both
+// channels and the left output is returned. Inputs and outputs may be the
+// same buffers.
+DATABENDER_API int databender_process_planar(databender_engine* engine, const float* const* inputs,
+                                             float* const* outputs, int channels, int num_frames);
+DATABENDER_API int databender_process_interleaved(databender_engine* engine, const float* input,
+                                                  float* output, int channels, int num_frames);
+
+// Controls
+DATABENDER_API void databender_set_freeze(databender_engine* engine, int frozen);
+DATABENDER_API void databender_set_playback_speed(databender_engine* engine, float speed);
+DATABENDER_API void databender_set_repeats(databender_engine* engine, float repeats);
+DATABENDER_API void databender_set_timing(databender_engine* engine, int enabled);
+DATABENDER_API void databender_clear(databender_engine* engine); // Not real-time safe
+
+// Readback into caller-owned memory
+DATABENDER_API int databender_read_meters(const databender_engine* engine, databender_meters* meters);
+DATABENDER_API int databender_read_stats(const databender_engine* engine, databender_stats* stats);
+
+// Trim map of the playing take, oldest first. Copies up to capacity
+// segments and returns how many there are, or a negative status. Not
+// concurrent with processing.
+DATABENDER_API int databender_read_trim_map(const databender_engine* engine, databender_segment* segments,
+                                            int capacity);
+
+#ifdef __cplusplus
+}
+#endif
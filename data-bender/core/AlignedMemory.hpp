@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+// Cache-line aligned sample storage. Capture buffers start on a cache line so
+// SIMD loads are aligned and two engines' buffers never share a line.
+static constexpr size_t CACHE_LINE_SIZE = 64;
+
+template <typename T>
+inline T* allocateAligned(size_t count) {
+    return static_cast<T*>(::operator new[](count * sizeof(T), std::align_val_t(CACHE_LINE_SIZE)));
+}
+
+template <typename T>
+inline void freeAligned(T* data) {
+    ::operator delete[](data, std::align_val_t(CACHE_LINE_SIZE));
+}
+
+inline float* allocateAlignedFloats(size_t count) {
+    return allocateAligned<float>(count);
+}
+
+inline void freeAlignedFloats(float* data) {
+    freeAligned(data);
+}
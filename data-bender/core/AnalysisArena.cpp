@@ -0,0 +1,158 @@
+#include "AnalysisArena.hpp"
+#include "AlignedMemory.hpp"
+
+AnalysisArena::~AnalysisArena() {
+    if (base) {
+        freeAligned(base);
+    }
+}
+
+void AnalysisArena::reserve(size_t bytes) {
+    if (base) {
+        freeAligned(base);
+        base = nullptr;
+    }
+
+    // Allocated without touching it, so only what is used takes memory
+    capacity = (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (capacity > 0) {
+        base = allocateAligned<char>(capacity);
+    }
+
+    for (Generation& generation : generations) {
+        generation = Generation();
+    }
+    head = 0;
+    tail = 0;
+    used = 0;
+    newest = 0;
+    newestSize = 0;
+    open = NO_GENERATION;
+    orderHead = 0;
+    orderCount = 0;
+    usedBytes.store(0, std::memory_order_relaxed);
+    peakBytes.store(0, std::memory_order_relaxed);
+    liveGenerations.store(0, std::memory_order_relaxed);
+    overflows.store(0, std::memory_order_relaxed);
+}
+
+int AnalysisArena::begin() {
+    if (orderCount == MAX_GENERATIONS) {
+        open = NO_GENERATION;
+        return NO_GENERATION;
+    }
+
+    // Any entry out of the order ring will do; the ring keeps the sequence
+    int index = 0;
+    while (generations[index].queued) {
+        ++index;
+    }
+    Generation& generation = generations[index];
+    generation.start = head;
+    generation.bytes = 0;
+    generation.refs = 1;
+    generation.queued = true;
+    order[(orderHead + orderCount) % MAX_GENERATIONS] = index;
+    ++orderCount;
+    liveGenerations.store(orderCount, std::memory_order_relaxed);
+
+    open = index;
+    newestSize = 0;
+    return index;
+}
+
+void AnalysisArena::retain(int generation) {
+    if (generation != NO_GENERATION) {
+        ++generations[generation].refs;
+    }
+}
+
+void AnalysisArena::release(int generation) {
+    if (generation == NO_GENERATION || --generations[generation].refs > 0) {
+        return;
+    }
+    if (generation == open) {
+        open = NO_GENERATION;
+    }
+
+    // Reclaim from the oldest end up to the first generation still held
+    while (orderCount > 0 && generations[order[orderHead]].refs == 0) {
+        used -= generations[order[orderHead]].bytes;
+        generations[order[orderHead]].queued = false;
+        orderHead = (orderHead + 1) % MAX_GENERATIONS;
+        --orderCount;
+        tail = orderCount > 0 ? generations[order[orderHead]].start : head;
+    }
+    if (orderCount == 0) {
+        head = 0;
+        tail = 0;
+        used = 0;
+    }
+    usedBytes.store(used, std::memory_order_relaxed);
+    liveGenerations.store(orderCount, std::memory_order_relaxed);
+}
+
+void* AnalysisArena::allocate(size_t bytes) {
+    if (open == NO_GENERATION || bytes == 0) {
+        return nullptr;
+    }
+    size_t size = (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+    // Free space is [head, capacity) and [0, tail) while the head is ahead
+    // of the tail, [head, tail) once it has wrapped
+    size_t at = head;
+    size_t skipped = 0;
+    if (used == capacity) {
+        return nullptr;
+    } else if (head >= tail) {
+        if (capacity - head < size) {
+            if (size > tail) {
+                return nullptr;
+            }
+            at = 0;
+            skipped = capacity - head;
+        }
+    } else if (tail - head < size) {
+        return nullptr;
+    }
+
+    head = at + size;
+    if (head == capacity) {
+        head = 0;
+    }
+    used += skipped + size;
+    generations[open].bytes += skipped + size;
+    newest = at;
+    newestSize = size;
+    usedBytes.store(used, std::memory_order_relaxed);
+    if (used > peakBytes.load(std::memory_order_relaxed)) {
+        peakBytes.store(used, std::memory_order_relaxed);
+    }
+    return base + at;
+}
+
+bool AnalysisArena::resize(void* block, size_t bytes) {
+    if (open == NO_GENERATION || newestSize == 0 || block != base + newest) {
+        return false;
+    }
+    size_t size = (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+    // The newest block can grow up to the end of the block or the tail
+    size_t limit = newest < tail ? tail : capacity;
+    if (size == 0 || newest + size > limit) {
+        return false;
+    }
+
+    used = used - newestSize + size;
+    generations[open].bytes = generations[open].bytes - newestSize + size;
+    newestSize = size;
+    head = newest + size;
+    if (head == capacity) {
+        head = 0;
+    }
+    usedBytes.store(used, std::memory_order_relaxed);
+    if (used > peakBytes.load(std::memory_order_relaxed)) {
+        peakBytes.store(used, std::memory_order_relaxed);
+    }
+    return true;
+}
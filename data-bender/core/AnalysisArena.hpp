@@ -0,0 +1,180 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+// Per-engine memory for analysis products: trim maps, onset indexes and
+// the tables snapshots keep of them.
+//
+// One block is reserved up front and handed out by bumping a head. Each
+// analysis pass opens a generation and allocates into it; generations are
+// reference counted and released whole, never block by block. Space comes
+// back from the oldest end, so a generation released out of order waits
+// for the ones before it. The heap is never touched after reserve(): an
+// allocation that doesn't fit returns nullptr and the caller makes do.
+//
+// Not thread safe: all calls come from the thread that runs the analysis,
+// apart from the monitoring getters.
+class AnalysisArena {
+public:
+    static constexpr int MAX_GENERATIONS = 64;
+    static constexpr int NO_GENERATION = -1;
+    static constexpr size_t ALIGNMENT = 64;
+
+    AnalysisArena() = default;
+    ~AnalysisArena();
+
+    AnalysisArena(const AnalysisArena&) = delete;
+    AnalysisArena& operator=(const AnalysisArena&) = delete;
+
+    // Replace the block with one of this many bytes (rounded up to
+    // ALIGNMENT), dropping every generation. Not real-time safe.
+    void reserve(size_t bytes);
+
+    // Open a generation for the next allocations, holding one reference
+    // for the caller. NO_GENERATION when the generation table is full.
+    int begin();
+    void retain(int generation);
+    void release(int generation);
+
+    // Allocate in the open generation (nullptr if there is none or the
+    // block is out of room)
+    void* allocate(size_t bytes);
+    template <typename T>
+    T* allocate(int count) { return static_cast<T*>(allocate(count * sizeof(T))); }
+
+    // Resize the newest allocation of the open generation in place
+    bool resize(void* block, size_t bytes);
+
+    // Count an analysis product that was cut short for lack of room
+    void countOverflow() { overflows.fetch_add(1, std::memory_order_relaxed); }
+
+    // Monitoring (any thread)
+    size_t getCapacity() const { return capacity; }
+    size_t getUsedBytes() const { return usedBytes.load(std::memory_order_relaxed); }
+    size_t getPeakBytes() const { return peakBytes.load(std::memory_order_relaxed); }
+    int getGenerations() const { return liveGenerations.load(std::memory_order_relaxed); }
+    int getOverflows() const { return overflows.load(std::memory_order_relaxed); }
+
+private:
+    struct Generation {
+        size_t start = 0; // Where the head was when it opened
+        size_t bytes = 0; // Including the skipped end of the block if it wrapped
+        int refs = 0;
+        bool queued = false; // Still in order, even once released
+    };
+
+    char* base = nullptr;
+    size_t capacity = 0;
+    size_t head = 0;
+    size_t tail = 0;  // Start of the oldest generation
+    size_t used = 0;  // Bytes between tail and head
+    size_t newest = 0; // Offset and size of the newest allocation
+    size_t newestSize = 0;
+    int open = NO_GENERATION;
+
+    // Generations in the order they opened
+    Generation generations[MAX_GENERATIONS];
+    int order[MAX_GENERATIONS];
+    int orderHead = 0;
+    int orderCount = 0;
+
+    std::atomic<size_t> usedBytes{0};
+    std::atomic<size_t> peakBytes{0};
+    std::atomic<int> liveGenerations{0};
+    std::atomic<int> overflows{0};
+};
+
+// Growable array in an arena generation, with the parts of std::vector the
+// engine uses. Growth reallocates within the open generation - in place
+// while the list is its newest allocation - backing off to a single item
+// when doubling doesn't fit, and push_back() returns false once the arena
+// is out of room.
+template <typename T>
+class ArenaList {
+public:
+    // Start empty in the arena's open generation
+    void start(AnalysisArena& arena) {
+        this->arena = &arena;
+        items = nullptr;
+        count = 0;
+        capacity = 0;
+    }
+
+    // Forget the items (their generation keeps the memory)
+    void clear() {
+        count = 0;
+    }
+
+    // Stop growing: later pushes fail until start()
+    void detach() {
+        arena = nullptr;
+    }
+
+    bool reserve(int wanted) {
+        return wanted <= capacity || grow(wanted);
+    }
+
+    bool push_back(const T& item) {
+        if (count == capacity && !grow(capacity > 0 ? capacity * 2 : MIN_CAPACITY) && !grow(capacity + 1)) {
+            if (arena) {
+                arena->countOverflow();
+            }
+            return false;
+        }
+        items[count++] = item;
+        return true;
+    }
+
+    // Within the reserved capacity; new items are left for the caller to fill
+    void resize(int newCount) {
+        count = newCount < capacity ? newCount : capacity;
+    }
+
+    // Give unused capacity back if the list is still the newest allocation
+    void shrinkToFit() {
+        if (arena && items && arena->resize(items, count * sizeof(T))) {
+            capacity = count;
+        }
+    }
+
+    T* data() { return items; }
+    const T* data() const { return items; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    T& operator[](int index) { return items[index]; }
+    const T& operator[](int index) const { return items[index]; }
+    T* begin() { return items; }
+    T* end() { return items + count; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+
+private:
+    static constexpr int MIN_CAPACITY = 64;
+
+    bool grow(int wanted) {
+        if (!arena) {
+            return false;
+        }
+        if (items && arena->resize(items, wanted * sizeof(T))) {
+            capacity = wanted;
+            return true;
+        }
+        T* moved = arena->allocate<T>(wanted);
+        if (!moved) {
+            return false;
+        }
+        if (count > 0) {
+            std::memcpy(moved, items, count * sizeof(T));
+        }
+        items = moved;
+        capacity = wanted;
+        return true;
+    }
+
+    AnalysisArena* arena = nullptr;
+    T* items = nullptr;
+    int count = 0;
+    int capacity = 0;
+};
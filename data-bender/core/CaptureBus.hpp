@@ -0,0 +1,231 @@
+#pragma once
+
+#include "AlignedMemory.hpp"
+#include "PinnedMemory.hpp"
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Frame range of a capture holding audio (a trimmed segment)
+struct CaptureSegment {
+    int start;
+    int length;
+};
+
+// A capture ring that can be shared between engines.
+//
+// Every engine records into one of these. Publishing it on the CaptureBus
+// lets other engines attach read-only: they play the same memory with their
+// own read heads and effect state, so N instances on one source cost one
+// ring. Lifetime is by shared_ptr - the ring outlives its writer for as long
+// as any reader holds it.
+//
+// The writer publishes how far the ring is filled once per block, and its
+// trim map whenever it freezes. The trim map is a sequence lock over relaxed
+// atomics (like TraceRing's slots), so readers on other threads either get a
+// consistent copy or know to run their own analysis.
+template <typename Sample>
+class CaptureSource {
+public:
+    // channels == 1 makes the right ring alias the left one. A pinned ring
+    // is mapped on huge pages and locked where the system allows (see
+    // PinnedMemory), and falls back to the heap if it can't be mapped.
+    CaptureSource(int frames, int channels, int maxSegments, bool pinned = false) : frames(frames) {
+        size_t bytes = static_cast<size_t>(frames) * sizeof(Sample);
+        if (pinned) {
+            ringL = static_cast<Sample*>(pinnedL.allocate(bytes, true));
+            ringR = channels == 2 ? static_cast<Sample*>(pinnedR.allocate(bytes, true)) : ringL;
+        }
+        if (!ringL) {
+            ringL = allocateAligned<Sample>(frames);
+        }
+        if (!ringR) {
+            ringR = channels == 2 ? allocateAligned<Sample>(frames) : ringL;
+        }
+
+        // Writing every page also faults it in here rather than on the
+        // write head's first pass
+        std::memset(ringL, 0, bytes);
+        std::memset(ringR, 0, bytes);
+        trimCapacity = maxSegments;
+        trimSegments = maxSegments > 0 ? new SharedSegment[maxSegments] : nullptr;
+    }
+
+    ~CaptureSource() {
+        if (ringR != ringL && !pinnedR.data()) {
+            freeAligned(ringR);
+        }
+        if (!pinnedL.data()) {
+            freeAligned(ringL);
+        }
+        delete[] trimSegments;
+    }
+
+    CaptureSource(const CaptureSource&) = delete;
+    CaptureSource& operator=(const CaptureSource&) = delete;
+
+    Sample* getL() const { return ringL; }
+    Sample* getR() const { return ringR; }
+    int getFrames() const { return frames; }
+
+    // What backs the ring, for logs
+    std::string describeMemory() const {
+        if (!pinnedL.data()) {
+            return "heap";
+        }
+        return ringR != ringL && !pinnedR.data() ? pinnedL.describe() + " (right channel on the heap)"
+                                                  : pinnedL.describe();
+    }
+
+    // Writer side, once per block: next write position and whether the ring
+    // has wrapped (so all of it holds audio)
+    void publishExtent(int writePosition, bool wrapped) {
+        extent.store(static_cast<unsigned int>(writePosition) | (wrapped ? WRAPPED_BIT : 0u),
+                     std::memory_order_release);
+    }
+
+    void loadExtent(int& writePosition, bool& wrapped) const {
+        unsigned int value = extent.load(std::memory_order_acquire);
+        writePosition = static_cast<int>(value & ~WRAPPED_BIT);
+        wrapped = (value & WRAPPED_BIT) != 0;
+    }
+
+    // Writer side, at freeze. Wait-free; a map larger than the reserved
+    // capacity is published as unavailable.
+    void publishTrimMap(const CaptureSegment* segments, int count, int totalLength,
+                        int writePosition, bool wrapped) {
+        unsigned int sequence = trimSequence.load(std::memory_order_relaxed);
+        trimSequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        bool fits = count <= trimCapacity;
+        for (int i = 0; fits && i < count; ++i) {
+            trimSegments[i].start.store(segments[i].start, std::memory_order_relaxed);
+            trimSegments[i].length.store(segments[i].length, std::memory_order_relaxed);
+        }
+        trimCount.store(fits ? count : -1, std::memory_order_relaxed);
+        trimLength.store(totalLength, std::memory_order_relaxed);
+        trimExtent.store(static_cast<unsigned int>(writePosition) | (wrapped ? WRAPPED_BIT : 0u),
+                         std::memory_order_relaxed);
+
+        trimSequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    // Reader side. How many segments the published map has (-1 if none),
+    // so the reader can make room before reading it
+    int getTrimCount() const { return trimCount.load(std::memory_order_relaxed); }
+
+    // Copies the writer's trim map if it describes exactly this extent and
+    // fits in capacity segments (no allocation). Returns false when the
+    // reader has to analyze the ring itself.
+    bool readTrimMap(CaptureSegment* segments, int capacity, int& count, int& totalLength,
+                     int writePosition, bool wrapped) const {
+        unsigned int before = trimSequence.load(std::memory_order_acquire);
+        if (before == 0 || (before & 1u) != 0) {
+            return false;
+        }
+
+        unsigned int expected = static_cast<unsigned int>(writePosition) | (wrapped ? WRAPPED_BIT : 0u);
+        count = trimCount.load(std::memory_order_relaxed);
+        if (trimExtent.load(std::memory_order_relaxed) != expected || count < 0 || count > capacity) {
+            return false;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            segments[i] = { trimSegments[i].start.load(std::memory_order_relaxed),
+                            trimSegments[i].length.load(std::memory_order_relaxed) };
+        }
+        totalLength = trimLength.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return trimSequence.load(std::memory_order_relaxed) == before;
+    }
+
+    // Cleared when the writing engine goes away; the audio stays
+    void setWriterAttached(bool attached) { writerAttached.store(attached, std::memory_order_release); }
+    bool isWriterAttached() const { return writerAttached.load(std::memory_order_acquire); }
+
+private:
+    static constexpr unsigned int WRAPPED_BIT = 0x80000000u;
+
+    struct SharedSegment {
+        std::atomic<int> start{0};
+        std::atomic<int> length{0};
+    };
+
+    Sample* ringL = nullptr;
+    Sample* ringR = nullptr;
+    int frames;
+    PinnedMemory pinnedL;
+    PinnedMemory pinnedR;
+
+    std::atomic<unsigned int> extent{0};
+    std::atomic<bool> writerAttached{true};
+
+    SharedSegment* trimSegments;
+    int trimCapacity;
+    std::atomic<unsigned int> trimSequence{0}; // Odd while the writer updates the map
+    std::atomic<int> trimCount{-1};
+    std::atomic<int> trimLength{0};
+    std::atomic<unsigned int> trimExtent{0};
+};
+
+// Process-wide registry of named capture sources, one per sample type.
+// Not real-time safe (takes a lock); used when wiring engines up.
+template <typename Sample>
+class CaptureBus {
+public:
+    using SourcePtr = std::shared_ptr<CaptureSource<Sample>>;
+
+    static CaptureBus& global() {
+        static CaptureBus bus;
+        return bus;
+    }
+
+    // Fails if the name is held by another live source
+    bool add(const std::string& name, const SourcePtr& source) {
+        std::lock_guard<std::mutex> lock(mutex);
+        SourcePtr existing = sources[name].lock();
+        if (existing && existing != source) {
+            return false;
+        }
+        sources[name] = source;
+        return true;
+    }
+
+    // Only removes the name if it still refers to this source
+    void remove(const std::string& name, const SourcePtr& source) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = sources.find(name);
+        if (found != sources.end() && found->second.lock() == source) {
+            sources.erase(found);
+        }
+    }
+
+    SourcePtr find(const std::string& name) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = sources.find(name);
+        return found != sources.end() ? found->second.lock() : SourcePtr();
+    }
+
+    std::vector<std::string> getNames() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<std::string> names;
+        for (const auto& entry : sources) {
+            if (!entry.second.expired()) {
+                names.push_back(entry.first);
+            }
+        }
+        return names;
+    }
+
+private:
+    CaptureBus() = default;
+
+    mutable std::mutex mutex;
+    std::map<std::string, std::weak_ptr<CaptureSource<Sample>>> sources;
+};
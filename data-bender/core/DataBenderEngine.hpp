@@ -1,12 +1,122 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
+#include "AlignedMemory.hpp"
+#include "AnalysisArena.hpp"
+#include "CaptureBus.hpp"
+#include "EngineStats.hpp"
+#include "GrainCloud.hpp"
+#include "OnsetIndex.hpp"
+#include "PostFilter.hpp"
+#include "RtCheck.hpp"
+#include "SilenceMap.hpp"
+#include "SnapshotStore.hpp"
+#include "SpectralFreeze.hpp"
+#include "TimeStretch.hpp"
+#include "WorkerPool.hpp"
+
+class DiskCaptureStore;
+
+// Compile-time engine configuration. Derive from it and override what you
+// need; disabled features compile away. For example a pure looper:
+//
+//     struct LooperConfig : DefaultDataBenderConfig {
+//         static constexpr bool ENABLE_REPEATS = false;
+//         static constexpr bool ENABLE_TRIMMING = false;
+//         static constexpr bool ENABLE_POST_FILTER = false;
+//     };
+//     BasicDataBenderEngine<LooperConfig> looper;
+//
+// Configurations other than the default must include
+// DataBenderEngineImpl.hpp in one translation unit.
+struct DefaultDataBenderConfig {
+    // Capture buffer
+    static constexpr int BUFFER_SECONDS = 60;
+    static constexpr int BUFFER_SAMPLE_RATE = 44100;
+    
+    // Silence detection parameters
+    static constexpr float SILENCE_THRESHOLD = 0.001f;
+    static constexpr int MIN_SILENCE_LENGTH = 1024; // Minimum silence block to trim (about 23ms at 44.1kHz)
+    static constexpr int MIN_AUDIO_LENGTH = 512; // Minimum audio block to keep (about 12ms at 44.1kHz)
+    
+    static constexpr int CROSSFADE_LENGTH = 256; // About 6ms at 44.1kHz (was 128)
+    
+    // 2 = stereo, 1 = mono (captures input 0 only; frozen playback sends
+    // it to both outputs)
+    static constexpr int CHANNELS = 2;
+    
+    // Capture storage: float, or int16_t for half the memory. Long-capture
+    // mode needs float.
+    using Sample = float;
+    
+    // Feature toggles
+    static constexpr bool ENABLE_REPEATS = true;
+    static constexpr bool ENABLE_TRIMMING = true;
+    static constexpr bool ENABLE_POST_FILTER = true; // DC blocking and smoothing
+    static constexpr bool ENABLE_ONSET_INDEX = true; // Onsets for snapping repeat jumps
+    
+    // Playhead interpolation: 0 = nearest (truncating), 1 = linear
+    static constexpr int INTERPOLATION_ORDER = 0;
+    
+    // Per-engine budget for trim maps, onset indexes and the tables
+    // snapshots keep (see AnalysisArena.hpp). A 60 second take needs at
+    // most about 50KB.
+    static constexpr size_t ANALYSIS_BUDGET = 1 << 20;
+};
+
+// Conversion between capture storage and float
+template <typename T>
+struct CaptureSample;
+
+template <>
+struct CaptureSample<float> {
+    static float fromFloat(float value) { return value; }
+    static float toFloat(float value) { return value; }
+};
+
+template <>
+struct CaptureSample<int16_t> {
+    static int16_t fromFloat(float value) {
+        value = value > 1.0f ? 1.0f : (value < -1.0f ? -1.0f : value);
+        return static_cast<int16_t>(value * 32767.0f + (value >= 0.0f ? 0.5f : -0.5f));
+    }
+    static float toFloat(int16_t value) { return value * (1.0f / 32767.0f); }
+};
+
+// Timestamped control change for process(), applied at an exact sample
+struct DataBenderEvent {
+    enum Type {
+        SET_FREEZE,         // value != 0 freezes
+        SET_PLAYBACK_SPEED,
+        SET_REPEATS,
+        TAKE_SNAPSHOT,      // value = slot
+        RECALL_SNAPSHOT     // value = slot, or LIVE_TAKE
+    };
+    
+    int sampleOffset; // From the start of the block
+    Type type;
+    float value;
+};
 
 // Core DSP engine - designed to be portable across platforms
-class DataBenderEngine {
+template <typename Config>
+class alignas(CACHE_LINE_SIZE) BasicDataBenderEngine {
 public:
-    DataBenderEngine();
-    ~DataBenderEngine();
+    using Sample = typename Config::Sample;
+    
+    // Snapshot slot number of the current capture
+    static constexpr int LIVE_TAKE = -1;
+    
+    static_assert(Config::CHANNELS == 1 || Config::CHANNELS == 2, "CHANNELS must be 1 or 2");
+    static_assert(Config::INTERPOLATION_ORDER == 0 || Config::INTERPOLATION_ORDER == 1,
+                  "INTERPOLATION_ORDER must be 0 or 1");
+    
+    BasicDataBenderEngine();
+    ~BasicDataBenderEngine();
     
     // Initialize the DSP engine
     void init(float sampleRate);
@@ -14,12 +124,44 @@ public:
     // Process audio - designed to be called from any platform
     void process(const float* inputs[2], float* outputs[2], int numFrames);
     
-    // Buffer freeze controls
+    // Process with control events sorted by sampleOffset. The block is split
+    // at each event so the change lands on its exact sample; events at or
+    // past numFrames are applied after the block.
+    void process(const float* inputs[2], float* outputs[2], int numFrames,
+                 const DataBenderEvent* events, int numEvents);
+    
+    // Double-precision I/O. Passthrough keeps full precision; capture
+    // storage stays Config::Sample, so memory use doesn't change.
+    void process(const double* inputs[2], double* outputs[2], int numFrames);
+    void process(const double* inputs[2], double* outputs[2], int numFrames,
+                 const DataBenderEvent* events, int numEvents);
+    
+    // One frame at a time, for hosts that call once per sample (VCV Rack).
+    // Recording and trimmed frozen playback run inline; the block boundary
+    // work of process() (snapshot requests, rate conversion swaps, onset
+    // scans, read-ahead hints) runs every SAMPLE_BLOCK frames, and other
+    // modes render a frame per call. With timing enabled each call is timed
+    // as a one-frame process().
+    static constexpr int SAMPLE_BLOCK = 32;
+    void processSample(float inputL, float inputR, float& outputL, float& outputR);
+    
+    // Micro-block mode for processSample: frames are queued and processed
+    // through process() frames at a time, which is cheaper per frame but
+    // delays the output by that many frames. 0 turns it off. Real-time
+    // safe, but not concurrent with processSample.
+    static constexpr int MAX_MICRO_BLOCK = 256;
+    void setMicroBlockSize(int frames);
+    int getMicroBlockSize() const; // Also the added latency in frames
+    
+    // Buffer freeze controls. setFreeze() and clearBuffer() first finish
+    // any event freeze still being analyzed (see enableLongCapture), which
+    // may sleep-poll its pool task - call them from a control thread, never
+    // the audio thread; use SET_FREEZE events there.
     void setFreeze(bool freeze);
     bool getFreeze() const;
     void clearBuffer();
     
-    // Helper method to find start of audio in buffer
+    // Frames from the oldest captured frame to the first audible one
     int findAudioStart() const;
     
     // Parameter setters for future effects
@@ -30,81 +172,539 @@ public:
     void setSampleRate(float sampleRate);
     float getSampleRate() const;
     
+    // Rate change that keeps the capture. A task on the shared WorkerPool
+    // converts the ring with a polyphase resampler (see Resampler.hpp) while
+    // recording and playback carry on; the converted ring swaps in at a block boundary
+    // with the trim map, onsets and playhead rescaled. When the ring is full
+    // the oldest RESAMPLE_HEADROOM frames make room for what is recorded
+    // meanwhile. Snapshots keep their audio as taken. Readers only take the
+    // rate (their writer converts), long-capture mode restarts the capture.
+    // Not real-time safe - call while audio is stopped, like init().
+    void convertSampleRate(float sampleRate);
+    bool isConvertingSampleRate() const;
+    
     // Progressive silence trimming methods
     void analyzeAndTrimSilence();
     void clearTrimmedSegments();
     void readFromTrimmedBuffer(float& outputL, float& outputR);
-    bool isSilence(int start, int length) const;
+    bool isSilence(int start, int length) const; // Ring frames, wrapping at the end
+    
+    // Trim map of the playing take, oldest first, as frame ranges of the
+    // capture. Copies up to capacity segments and returns how many there
+    // are (0 when the take plays raw). Not concurrent with process().
+    int copyTrimMap(CaptureSegment* segments, int capacity) const;
+    int getTrimmedLength() const; // Frames the trimmed take plays
     
     // Playback speed control
     void setPlaybackSpeed(float speed);
     float getPlaybackSpeed() const;
     
+    // Speed changes glide linearly over this many samples (0 = immediate)
+    void setSpeedRampLength(int samples);
+    int getSpeedRampLength() const;
+    
     // Repeats/stuttering control
     void setRepeats(float repeats);
     float getRepeats() const;
     
-private:
-    float sampleRate;
-    float parameters[16]; // Space for future parameters
+    // Seed the per-engine random generator used for repeats
+    void setRandomSeed(unsigned int seed);
     
-    // Buffer management
-    static const int BUFFER_SIZE = 60 * 44100; // 60 seconds at 44.1kHz
-    float* bufferL;
-    float* bufferR;
-    int writePosition;
-    float readPosition; // Changed to float for speed control
-    int audioStartPosition; // Store where audio starts (trim silence)
-    bool isFrozen;
-    bool bufferInitialized;
+    // Snap repeat jumps to the nearest onset of the take (off by default).
+    // Onsets are found while capturing, so freezing only sorts them.
+    void setOnsetSnap(bool enabled);
+    bool getOnsetSnap() const;
+    int getOnsetCount() const; // Onsets in the playing take
+    
+    // Pitch-preserving playback: while frozen, the playback speed changes
+    // tempo only. The read head is replaced by a WSOLA time stretch over the
+    // take (see TimeStretch.hpp); repeats jump its position. Granular and
+    // spectral playback take priority. setPreservePitch is not real-time
+    // safe (it allocates the stretch buffers on first use).
+    void setPreservePitch(bool enabled);
+    bool getPreservePitch() const;
+    
+    // Granular playback: while frozen, a cloud of up to
+    // GrainCloud<Sample>::MAX_GRAINS windowed grains replaces the read head.
+    // Grains start at random around a playhead that moves at the playback
+    // speed, and play at that speed. Repeats do not apply. setGranularMode
+    // is not real-time safe (it allocates the voice pool on first use).
+    void setGranularMode(bool enabled);
+    bool getGranularMode() const;
+    void setGrainDensity(float grainsPerSecond);
+    float getGrainDensity() const;
+    void setGrainLength(float seconds);
+    float getGrainLength() const;
+    void setGrainSpray(float seconds); // Start up to this far behind the playhead
+    float getGrainSpray() const;
+    int getActiveGrains() const;
+    
+    // Spectral freeze: while frozen, the moment before the freeze point is
+    // held as magnitude spectra and resynthesized with random phases. The
+    // playback speed sets how fast it drifts through the kept frames.
+    // Takes priority over granular playback. Both setters are not real-time
+    // safe (they allocate and plan the FFT); the frame size is a power of
+    // two between SpectralFreeze::MIN_SIZE and SpectralFreeze::MAX_SIZE.
+    void setSpectralFreeze(bool enabled);
+    bool getSpectralFreeze() const;
+    bool setSpectralFrameSize(int frames);
+    int getSpectralFrameSize() const;
+    
+    // Long-capture mode: record into a disk-backed store instead of the
+    // 60 second RAM ring. The ring and the snapshot slots are freed while
+    // it is active; disableLongCapture() brings back an empty ring. Not
+    // real-time safe - call while audio is stopped.
+    // A SET_FREEZE event here is analyzed on the shared WorkerPool once the
+    // store has spilled: recording stops at the event, the input passes
+    // through, and the take starts at the first block boundary after.
+    bool enableLongCapture(const std::string& path, float seconds);
+    void disableLongCapture();
+    bool isLongCaptureActive() const;
+    
+    // Silence-gated capture: silent MIN_SILENCE_LENGTH blocks are dropped
+    // as they arrive, so the ring holds only audio and freeze needs no
+    // analysis. Not real-time safe - clears the capture.
+    bool setCompactCapture(bool enabled);
+    bool isCompactCaptureActive() const;
+    
+    // Pinned capture memory for dedicated machines: the RAM ring is mapped
+    // on 2MB huge pages where the system has them and locked with mlock, so
+    // neither the write head nor stutter jumps across it take page faults,
+    // and jumps miss the TLB far less. Whatever the system refuses falls
+    // back to ordinary pages; getCaptureMemory() says what is active. Not
+    // real-time safe - clears the capture.
+    bool setPinnedCapture(bool enabled);
+    bool isPinnedCaptureActive() const;
+    std::string getCaptureMemory() const;
+    
+    // Snapshot slots: copy-on-write copies of frozen takes, recalled while
+    // frozen with a crossfade. setSnapshotSlots is not real-time safe. Take
+    // and recall requests are lock-free and apply at the next block (or use
+    // the TAKE_SNAPSHOT/RECALL_SNAPSHOT events). Not available in
+    // long-capture mode.
+    void setSnapshotSlots(int numSlots);
+    int getSnapshotSlots() const;
+    void takeSnapshot(int slot);
+    void recallSnapshot(int slot); // LIVE_TAKE returns to the current capture
+    int getPlayingSlot() const;
+    
+    // Shared capture bus: publish this engine's RAM ring under a name, or
+    // attach to a published ring read-only. Readers record nothing, play the
+    // shared audio with their own read heads and effects, and use the
+    // writer's trim map when it matches. The ring lives until its writer and
+    // every reader are gone. Not real-time safe. Readers freeze on a
+    // SET_FREEZE event as long-capture mode does, a block or more late.
+    bool publishCapture(const std::string& name);
+    void unpublishCapture();
+    bool attachCapture(const std::string& name);
+    void detachCapture();
+    bool isCaptureAttached() const;
+    
+    // Analysis products live in a fixed per-engine arena, reserved by init()
+    // and never grown. A freeze that runs out of room keeps what fits:
+    // fewer segments or onsets, or raw playback. A new budget applies at the
+    // next init(), which empties the snapshot slots. Not real-time safe.
+    void setAnalysisBudget(size_t bytes);
+    size_t getAnalysisBudget() const;
+    const AnalysisArena& getAnalysisArena() const; // Usage, for monitoring
+    
+    // Per-block timing instrumentation (off by default, one branch when off)
+    void setTimingEnabled(bool enabled);
+    bool isTimingEnabled() const;
+    EngineStats& getStats();
+    const EngineStats& getStats() const;
+    
+    // RAM ring footprint of this configuration
+    static constexpr size_t captureBytes() {
+        return static_cast<size_t>(BUFFER_SIZE) * Config::CHANNELS * sizeof(Sample);
+    }
+    
+private:
+    // Member layout: per-sample state is packed into the first two cache
+    // lines of the (cache-line aligned) object, followed by cold config and
+    // the crossfade scratch on their own lines, so engines running on
+    // different cores never share a line and the audio path touches as few
+    // lines as possible.
     
     // Progressive silence trimming
-    struct AudioSegment {
-        int start;
-        int length;
-        float* dataL;
-        float* dataR;
+    // Segments are frame ranges of the capture rather than copies, so
+    // trimming costs no extra memory however long the capture is.
+    using AudioSegment = CaptureSegment;
+    
+    // A frozen take kept in a snapshot slot. Its tables are the ones the
+    // take was playing, kept alive by a reference to their arena generation.
+    struct Take {
+        const AudioSegment* segments = nullptr;
+        int segmentCount = 0;
+        int trimmedLength = 0;
+        int capturedSamples = 0;
+        const int* onsets = nullptr;
+        int onsetCount = 0;
+        int oldest = 0; // Ring frame of the oldest audio, where raw playback starts
+        int generation = AnalysisArena::NO_GENERATION;
+        bool filled = false;
     };
     
-    std::vector<AudioSegment> trimmedSegments;
-    int totalTrimmedLength;
-    bool segmentsInitialized;
-    float trimmedReadPosition = 0.0f; // For trimmed buffer playback
+    using Pages = SnapshotStore<Sample>;
     
-    // Silence detection parameters
-    static constexpr float SILENCE_THRESHOLD = 0.001f;
-    static constexpr int MIN_SILENCE_LENGTH = 1024; // Minimum silence block to trim (about 23ms at 44.1kHz)
-    static constexpr int MIN_AUDIO_LENGTH = 512; // Minimum audio block to keep (about 12ms at 44.1kHz)
-    
-    // Internal processing state
-    void processFrame(float inputL, float inputR, float& outputL, float& outputR);
-    void updateBuffer(float inputL, float inputR);
-    void readFromBuffer(float& outputL, float& outputR);
+    //==========================================================================
+    // Hot: touched on every sample
     
+    // Take frozen playback reads: page tables over the live capture view, or
+    // a recalled snapshot. Pages are Pages::PAGE_FRAMES long. Takes are
+    // read in chronological order: segments are listed oldest first, and raw
+    // positions count from playOldest, so a wrapped ring is never rotated.
+    alignas(CACHE_LINE_SIZE) const Sample* const* playPagesL;
+    const Sample* const* playPagesR;
+    const AudioSegment* playSegments = nullptr;
+    Sample* bufferL;
+    Sample* bufferR; // Aliases bufferL in mono configurations
+    DiskCaptureStore* diskStore = nullptr;
+    int playSegmentCount = 0;
+    int playTrimmedLength = 0;
+    int playCapturedSamples = 0;
+    int playOldest = 0; // Ring frame of raw take position 0
+    int captureSize;
+    int writePosition;
+    float readPosition; // Raw take position, oldest frame first
+    float trimmedReadPosition = 0.0f; // For trimmed buffer playback
     float playbackSpeed = 1.0f;
     float repeats = 0.0f;
     
-    // Crossfade state to prevent pops when jumping
-    static constexpr int CROSSFADE_LENGTH = 256; // About 6ms at 44.1kHz (was 128)
-    float crossfadeBufferL[CROSSFADE_LENGTH];
-    float crossfadeBufferR[CROSSFADE_LENGTH];
     int crossfadeIndex = 0;
+    int playheadFrame = 0; // Physical frame last read, for disk read-ahead
+    int sampleCountdown = 0; // processSample frames to the next block boundary
+    int microBlockSize = 0;
+    int microBlockFill = 0;
+    
+    // Per-engine PRNG (xorshift32) - real-time safe replacement for rand()
+    unsigned int randomState = 0x9E3779B9u;
+    
+    bool isFrozen;
+    bool bufferInitialized;
     bool inCrossfade = false;
+    bool timingEnabled = false;
+    bool compactCapture = false;
+    bool captureReader = false; // Attached to another engine's ring
+    bool granular = false;
+    bool spectralFreeze = false;
+    bool preservePitch = false;
+    bool sampleFastPath = true; // No speed ramp or take fade in progress
+    
+    //==========================================================================
+    // Cold: configuration and bookkeeping
+    
+    alignas(CACHE_LINE_SIZE) float sampleRate;
+    
+    // Ring storage: our own (bufferL/bufferR), or a published ring we are
+    // attached to (bufferL/bufferR null)
+    std::shared_ptr<CaptureSource<Sample>> captureSource;
+    std::string publishedName;
+    bool pinnedCapture = false; // New rings are pinned (see PinnedMemory.hpp)
+    
+    // Active capture view - the RAM ring, or the mapped file in long-capture
+    // mode - and its identity page tables
+    const Sample* captureL;
+    const Sample* captureR;
+    std::vector<const Sample*> livePagesL;
+    std::vector<const Sample*> livePagesR;
+    
+    // Arena for the analysis tables. Each freeze builds the live take's
+    // segments and onsets in a fresh generation, liveGeneration.
+    AnalysisArena arena;
+    size_t analysisBudget = Config::ANALYSIS_BUDGET;
+    int liveGeneration = AnalysisArena::NO_GENERATION;
+    
+    // Live take segments, rebuilt at each freeze
+    ArenaList<AudioSegment> trimmedSegments;
+    int totalTrimmedLength;
+    bool segmentsInitialized;
+
+    float parameters[16]; // Space for future parameters
+    int audioStartPosition; // Store where audio starts (trim silence)
     float crossfadeGain = 1.0f;
+    int jumpCount = 0; // Repeat jumps so far, lets a block tell it crossfaded
+    
+    // Event tracing (see TraceRing.hpp) - audio events on traceTrack,
+    // control calls on traceTrack + 1
+    unsigned int traceTrack = 0;
+    
+    // Additional smoothing and DC blocking to prevent pops (raw frozen
+    // playback only). Its state is loaded once per block, so it lives here
+    // rather than on the hot lines.
+    PostFilter postFilter;
+    
+    // Speed ramp: playbackSpeed glides from speedRampStart to speedTarget
+    float speedTarget = 1.0f;
+    float speedRampStart = 1.0f;
+    float speedRampStep = 0.0f;
+    int speedRampLength = 0;
+    int speedRampPosition = 0;
+    int speedRampRemaining = 0;
+    
+    // Compact capture gate: the current block is held back in gatePending
+    // until it is known to be audible, then appended to the ring. Ring
+    // positions where segments begin are kept oldest first in segmentStarts.
+    Sample* gatePendingL = nullptr;
+    Sample* gatePendingR = nullptr;
+    int gatePendingCount = 0;
+    bool gatePendingAudible = false;
+    bool gateOpen = false;
+    std::vector<int> segmentStarts;
+    int segmentStartHead = 0;
+    int segmentStartCount = 0;
+    
+    // Onset index: hop starts found by onsetDetector behind the write head,
+    // kept oldest first in onsetStarts like segmentStarts. Freezing turns
+    // them into liveOnsets, sorted in the take's playback positions.
+    OnsetDetector onsetDetector;
+    std::vector<int> onsetStarts;
+    int onsetStartHead = 0;
+    int onsetStartCount = 0;
+    int onsetScanPosition = 0; // Next ring frame the detector reads
+    int onsetHopFill = 0;
+    float onsetHopEnergy = 0.0f;
+    std::vector<int> onsetScratch;
+    ArenaList<int> liveOnsets;
+    const int* playOnsets = nullptr; // Read only when a repeat jumps
+    int playOnsetCount = 0;
+    bool onsetSnap = false;
     
-    // Additional smoothing to prevent pops
-    float lastOutputL = 0.0f;
-    float lastOutputR = 0.0f;
-    static constexpr float SMOOTHING_FACTOR = 0.98f; // Stronger smoothing (was 0.95f)
+    // Where the RAM ring holds audio, kept behind the write head like the
+    // onset scan, so trimming at freeze doesn't read the whole capture
+    SilenceMap silenceMap;
     
-    // DC blocking to prevent low-frequency pops
-    float dcBlockL = 0.0f;
-    float dcBlockR = 0.0f;
-    static constexpr float DC_BLOCK_COEFF = 0.995f;
+    // Granular playback. The voice pool is allocated by setGranularMode;
+    // grainSegment caches the segment the last grain started in, so finding
+    // the next one in a trimmed take is a step or two.
+    using Grains = GrainCloud<Sample>;
+    Grains* grains = nullptr;
+    float grainDensity = 20.0f;
+    float grainLength = 0.05f;
+    float grainSpray = 0.1f;
+    int grainCountdown = 0; // Samples until the next grain starts
+    int grainSegment = 0;
+    int grainSegmentOffset = 0; // Take position where grainSegment starts
+    
+    // Pitch-preserving playback, allocated by setPreservePitch. The stretch
+    // reads through gatherTake, which caches the segment it last read in
+    // trimmed takes.
+    TimeStretch* stretch = nullptr;
+    int gatherSegment = 0;
+    int gatherSegmentOffset = 0; // Take position where gatherSegment starts
+    
+    // Spectral freeze, allocated by setSpectralFreeze. spectralPoint is the
+    // take position the playing take froze at.
+    SpectralFreeze* spectral = nullptr;
+    int spectralSize = 2048;
+    int spectralPoint = 0;
+    
+    // Capture conversion after a rate change, owned by its task until it
+    // is ready to swap in (see convertSampleRate)
+    struct ResampleJob;
+    ResampleJob* resampleJob = nullptr;
+    bool resamplePending = false; // Until the audio thread swaps it in
+    static constexpr int RESAMPLE_HEADROOM = Config::BUFFER_SAMPLE_RATE * 2;
+    
+    // Event freezes that need the disk or another engine's ring are
+    // analyzed by a pool task (see startFreezeJob). Recording stops while
+    // freezePending; freezeWanted is the latest SET_FREEZE since.
+    enum FreezeJobState { FREEZE_IDLE, FREEZE_REQUESTED, FREEZE_RUNNING, FREEZE_READY };
+    std::atomic<int> freezeJob{FREEZE_IDLE};
+    std::atomic<bool> freezePending{false};
+    std::atomic<bool> freezeWanted{false};
+    
+    // What this engine has queued on the shared WorkerPool
+    TaskGroup backgroundTasks;
+    
+    // Micro-block queues: frames going in, and the last block's output
+    // going out
+    alignas(CACHE_LINE_SIZE) float microInputL[MAX_MICRO_BLOCK];
+    float microInputR[MAX_MICRO_BLOCK];
+    float microOutputL[MAX_MICRO_BLOCK];
+    float microOutputR[MAX_MICRO_BLOCK];
+    
+    // Snapshot slots and the pending lock-free requests (NO_REQUEST when idle)
+    static constexpr int NO_REQUEST = -2;
+    Pages* snapshotPages = nullptr;
+    std::vector<Take> snapshots;
+    std::atomic<int> pendingSnapshot{NO_REQUEST};
+    std::atomic<int> pendingRecall{NO_REQUEST};
+    std::atomic<int> playingSlot{LIVE_TAKE};
+    int takeFadeIndex = CROSSFADE_LENGTH; // CROSSFADE_LENGTH when no switch is fading
     
     // Stuttering state
     int stutterCounter = 0;
     int stutterLength = 0;
     int stutterPosition = 0;
     bool inStutter = false;
-}; 
\ No newline at end of file
+    
+    // Buffer management
+    static constexpr int BUFFER_SIZE = Config::BUFFER_SECONDS * Config::BUFFER_SAMPLE_RATE;
+    
+    // Silence detection parameters
+    static constexpr float SILENCE_THRESHOLD = Config::SILENCE_THRESHOLD;
+    static constexpr int MIN_SILENCE_LENGTH = Config::MIN_SILENCE_LENGTH;
+    static constexpr int MIN_AUDIO_LENGTH = Config::MIN_AUDIO_LENGTH;
+    
+    // Crossfade state to prevent pops when jumping - scratch written only
+    // when a repeat jump starts, kept off the hot lines
+    static constexpr int CROSSFADE_LENGTH = Config::CROSSFADE_LENGTH;
+    alignas(CACHE_LINE_SIZE) float crossfadeBufferL[CROSSFADE_LENGTH];
+    float crossfadeBufferR[CROSSFADE_LENGTH];
+    
+    // Outgoing take, faded out over the first frames after a recall
+    alignas(CACHE_LINE_SIZE) float takeFadeL[CROSSFADE_LENGTH];
+    float takeFadeR[CROSSFADE_LENGTH];
+    
+    // Per-sample speeds for the ramp, filled one chunk at a time
+    static constexpr int SPEED_RAMP_CHUNK = 64;
+    alignas(CACHE_LINE_SIZE) float speedRamp[SPEED_RAMP_CHUNK];
+    
+    // Timing statistics, written once per block when enabled
+    alignas(CACHE_LINE_SIZE) EngineStats stats;
+    
+    // Internal processing state
+    // Kernels are templated on the I/O sample type (float or double)
+    template <typename IO>
+    void processBlock(const IO* inputs[2], IO* outputs[2], int numFrames,
+                      const DataBenderEvent* events, int numEvents);
+    void startBlock();
+    void finishBlock();
+    void sampleBlockBoundary();
+    void renderSample(float inputL, float inputR, float& outputL, float& outputR);
+    void processMicroBlock();
+    template <typename IO>
+    void processSpan(const IO* inputs[2], IO* outputs[2], int offset, int numFrames);
+    template <typename IO>
+    void renderFrames(const IO* inputL, const IO* inputR, IO* outputL, IO* outputR,
+                      int numFrames, const float* speeds);
+    template <typename IO>
+    void processFrame(IO inputL, IO inputR, IO& outputL, IO& outputR);
+    void updateBuffer(float inputL, float inputR);
+    void gateSample(float inputL, float inputR);
+    void commitGateBlock();
+    void buildCompactSegments();
+    void addRingSegment(int start, int length);
+    void resetGate();
+    void beginLiveTables();
+    void reserveAnalysis();
+    void reserveOnsets();
+    void resetOnsets();
+    void scanOnsets(int numFrames);
+    void buildOnsetIndex();
+    void indexOnsets();
+    static void scanSilence(SilenceMap& map, const Sample* left, const Sample* right, int numFrames);
+    bool usesSilenceMap() const;
+    bool isSilentBlock(int start, int length) const;
+    void beginFreeze();
+    void analyzeTake();
+    void startTake();
+    void startFreezeJob();
+    void pollFreezeJob();
+    void finishFreezeJob();
+    void settleFreezeJob();
+    static void freezeTask(void* context);
+    int snapJump(int target, int skipBack) const;
+    std::shared_ptr<CaptureSource<Sample>> makeCaptureSource() const;
+    void rebuildLivePages();
+    void selectLiveTake();
+    void applySnapshot(int slot);
+    void applyRecall(int slot);
+    template <typename IO>
+    void mixTakeFade(IO* outputL, IO* outputR, int numFrames);
+    void destroySnapshots();
+    void closeDiskStore();
+    template <typename IO>
+    void renderGrains(IO* outputL, IO* outputR, int numFrames, const float* speeds);
+    void startGrain(int takeLength);
+    int nextGrainInterval();
+    void resetGrains();
+    void analyzeSpectrum();
+    template <typename IO>
+    void renderStretch(IO* outputL, IO* outputR, int numFrames, const float* speeds);
+    void gatherTake(int position, int count, float* left, float* right);
+    void startCrossfade(int position);
+    void mixCrossfade(float& left, float& right);
+    void resetStretch();
+    static void resampleTask(void* context);
+    static void releaseRetired(void* context);
+    void applyResample();
+    void finishResample();
+    void cancelResample();
+    int mapResampledFrame(int frame, bool* kept = nullptr) const;
+    void remapResampledSegments(const AudioSegment* segments, int count);
+    void remapResampledStarts(std::vector<int>& starts, int head, int& count);
+    template <typename IO>
+    bool readFromBuffer(IO* outputL, IO* outputR, int numFrames, const float* speeds);
+    void applyEvent(const DataBenderEvent& event);
+    void fillSpeedRamp(int numFrames);
+    bool usesTrimmedPlayback() const;
+    EngineStats::Mode currentMode() const;
+    
+    unsigned int nextRandom();
+    float randomUnit();          // [0, 1)
+    int randomBelow(int range);  // [0, range), 0 when range <= 0
+    void reserveSegments();
+    
+    static float toFloat(Sample value) { return CaptureSample<Sample>::toFloat(value); }
+    
+    // Ring frame of a raw take position in [0, playCapturedSamples)
+    int rawFrame(int position) const {
+        int frame = position + playOldest;
+        return frame < playCapturedSamples ? frame : frame - playCapturedSamples;
+    }
+    
+    // Frame of the playing take
+    float playL(int frame) const {
+        return toFloat(playPagesL[frame >> Pages::PAGE_SHIFT][frame & Pages::PAGE_MASK]);
+    }
+    float playR(int frame) const {
+        return toFloat(playPagesR[frame >> Pages::PAGE_SHIFT][frame & Pages::PAGE_MASK]);
+    }
+};
+
+// Defined here rather than in DataBenderEngineImpl.hpp so the per-sample
+// call inlines into the host
+template <typename Config>
+inline void BasicDataBenderEngine<Config>::processSample(float inputL, float inputR, float& outputL, float& outputR) {
+    DATABENDER_RT_SCOPE();
+    
+    if (microBlockSize > 0) {
+        outputL = microOutputL[microBlockFill];
+        outputR = microOutputR[microBlockFill];
+        microInputL[microBlockFill] = inputL;
+        microInputR[microBlockFill] = inputR;
+        if (++microBlockFill == microBlockSize) {
+            processMicroBlock();
+        }
+        return;
+    }
+    if (timingEnabled) {
+        const float* inputs[2] = { &inputL, &inputR };
+        float* outputs[2] = { &outputL, &outputR };
+        process(inputs, outputs, 1);
+        return;
+    }
+    
+    if (sampleCountdown == 0) {
+        sampleBlockBoundary();
+    }
+    --sampleCountdown;
+    
+    if (!isFrozen && sampleFastPath) {
+        outputL = inputL;
+        outputR = inputR;
+        updateBuffer(inputL, inputR);
+    } else if (isFrozen && sampleFastPath && !spectralFreeze && !granular && !preservePitch &&
+               Config::ENABLE_TRIMMING && playSegmentCount > 0) {
+        readFromTrimmedBuffer(outputL, outputR);
+    } else {
+        renderSample(inputL, inputR, outputL, outputR);
+    }
+}
+
+// The standard engine used by the plugins. Compiled once in
+// DataBenderEngine.cpp.
+extern template class BasicDataBenderEngine<DefaultDataBenderConfig>;
+using DataBenderEngine = BasicDataBenderEngine<DefaultDataBenderConfig>;
\ No newline at end of file
@@ -0,0 +1,2853 @@
+#pragma once
+
+// Member definitions for BasicDataBenderEngine. Only needed by translation
+// units that instantiate a non-default configuration; everyone else uses
+// the DataBenderEngine instantiation compiled in DataBenderEngine.cpp.
+
+#include "DataBenderEngine.hpp"
+#include "Denormals.hpp"
+#include "DiskCaptureStore.hpp"
+#include "Resampler.hpp"
+#include "RtCheck.hpp"
+#include "TraceRing.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// A capture conversion in flight. A pool task fills the new ring from the
+// old one and marks the job READY; the audio thread claims it, copies what
+// was recorded meanwhile, swaps the rings and hands the old one back in
+// retired, which a second task then lets go of.
+template <typename Config>
+struct BasicDataBenderEngine<Config>::ResampleJob {
+    enum State { RUNNING, READY, SWAPPING, SWAPPED, CANCELLED };
+    
+    std::atomic<int> state{RUNNING};
+    std::shared_ptr<CaptureSource<Sample>> fresh;   // The converted ring
+    std::shared_ptr<CaptureSource<Sample>> retired; // The old ring, after the swap
+    std::string publishedName;
+    
+    const Sample* oldL = nullptr;
+    const Sample* oldR = nullptr;
+    double ratio = 1.0;   // New rate over old rate
+    double skip = 0.0;    // Oldest frames left out, in old frames
+    int oldStart = 0;     // Ring frame of the oldest audio
+    int oldLength = 0;    // Frames of audio in the old ring
+    int startWrite = 0;   // Write position when the conversion started
+    int newLength = 0;    // Converted frames, at the start of the new ring
+    int recorded = 0;     // Frames recorded during the conversion, set at the swap
+    int kept = 0;         // How many of those fit after the converted audio
+    SilenceMap silence;   // Of the converted audio, swapped in with the ring
+};
+
+template <typename Config>
+BasicDataBenderEngine<Config>::BasicDataBenderEngine() : writePosition(0), readPosition(0), trimmedReadPosition(0.0f), playbackSpeed(1.0f), repeats(0.0f), isFrozen(false), bufferInitialized(false), sampleRate(44100.0f), totalTrimmedLength(0), segmentsInitialized(false), audioStartPosition(0) {
+    // Initialize parameters to default values
+    for (int i = 0; i < 16; ++i) {
+        parameters[i] = 0.0f;
+    }
+    
+    // Allocate buffer memory (cache-line aligned for SIMD loads, cleared).
+    // The ring is shareable, so it is owned by a CaptureSource.
+    captureSource = makeCaptureSource();
+    bufferL = captureSource->getL();
+    bufferR = captureSource->getR();
+    
+    // Capture into the RAM ring until long-capture mode is enabled
+    captureL = bufferL;
+    captureR = bufferR;
+    captureSize = BUFFER_SIZE;
+    reserveAnalysis();
+    reserveSegments();
+    rebuildLivePages();
+    
+    // Start the shared pool here, not on the audio thread's first submission
+    WorkerPool::global();
+    
+#ifdef DATABENDER_TRACE
+    traceTrack = TraceRing::newTrack();
+#endif
+}
+
+template <typename Config>
+BasicDataBenderEngine<Config>::~BasicDataBenderEngine() {
+    // A conversion still running is dropped with the engine, and so is
+    // anything else still queued for it
+    cancelResample();
+    backgroundTasks.cancel();
+    freezeJob.store(FREEZE_IDLE, std::memory_order_relaxed);
+    freezePending.store(false, std::memory_order_relaxed);
+    
+    // Stop spilling before the store goes away, without bringing the RAM
+    // ring back for it
+    closeDiskStore();
+    destroySnapshots();
+    
+    // Readers may keep our ring (and its last audio) alive after us
+    unpublishCapture();
+    if (captureSource && !captureReader) {
+        captureSource->setWriterAttached(false);
+    }
+    if (gatePendingR != gatePendingL) {
+        freeAligned(gatePendingR);
+    }
+    if (gatePendingL) {
+        freeAligned(gatePendingL);
+    }
+    
+    // Cleanup trimmed segments (the arena frees their memory)
+    clearTrimmedSegments();
+    arena.release(liveGeneration);
+    delete grains;
+    delete spectral;
+    delete stretch;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::init(float sampleRate) {
+    cancelResample();
+    settleFreezeJob();
+    this->sampleRate = sampleRate;
+    
+    // Recalculate buffer size based on new sample rate
+    // Note: For simplicity, we keep the 60-second buffer size
+    // In a real implementation, you might want to reallocate based on sample rate
+    
+    // Snapshots keep whatever they share with the ring
+    if (snapshotPages) {
+        snapshotPages->preserveAll();
+    }
+    
+    // Reset buffer positions
+    writePosition = 0;
+    readPosition = 0;
+    audioStartPosition = 0;
+    isFrozen = false;
+    bufferInitialized = false;
+    playingSlot.store(LIVE_TAKE, std::memory_order_relaxed);
+    takeFadeIndex = CROSSFADE_LENGTH;
+    sampleCountdown = 0;
+    microBlockFill = 0;
+    std::memset(microOutputL, 0, sizeof(microOutputL));
+    std::memset(microOutputR, 0, sizeof(microOutputR));
+    
+    // Reset trimming state
+    resetOnsets();
+    silenceMap.reset(0);
+    clearTrimmedSegments();
+    resetGate();
+    if (arena.getCapacity() != analysisBudget) {
+        reserveAnalysis();
+    }
+    
+    // Clear buffers (a shared ring belongs to its writer, and long capture
+    // has none). This also faults in any page that was dropped since, off
+    // the audio thread.
+    if (!captureReader && !diskStore) {
+        std::memset(bufferL, 0, BUFFER_SIZE * sizeof(Sample));
+        std::memset(bufferR, 0, BUFFER_SIZE * sizeof(Sample));
+    }
+    
+    if (diskStore) {
+        diskStore->reset();
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::process(const float* inputs[2], float* outputs[2], int numFrames) {
+    processBlock(inputs, outputs, numFrames, nullptr, 0);
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::process(const float* inputs[2], float* outputs[2], int numFrames,
+                                            const DataBenderEvent* events, int numEvents) {
+    processBlock(inputs, outputs, numFrames, events, numEvents);
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::process(const double* inputs[2], double* outputs[2], int numFrames) {
+    processBlock(inputs, outputs, numFrames, nullptr, 0);
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::process(const double* inputs[2], double* outputs[2], int numFrames,
+                                            const DataBenderEvent* events, int numEvents) {
+    processBlock(inputs, outputs, numFrames, events, numEvents);
+}
+
+template <typename Config>
+template <typename IO>
+void BasicDataBenderEngine<Config>::processBlock(const IO* inputs[2], IO* outputs[2], int numFrames,
+                                                 const DataBenderEvent* events, int numEvents) {
+    DATABENDER_RT_SCOPE();
+    
+    // Don't rely on the host to disable denormals for the filter tails
+    ScopedFlushDenormals noDenormals;
+    
+    // Timing is sampled around the whole block so the per-frame path stays untouched
+    std::chrono::steady_clock::time_point blockStart;
+    EngineStats::Mode blockMode = EngineStats::MODE_PASSTHROUGH;
+    int blockJumps = jumpCount;
+    if (timingEnabled) {
+        blockMode = currentMode();
+        blockStart = std::chrono::steady_clock::now();
+    }
+    DATABENDER_TRACE_BEGIN("process", traceTrack, numFrames);
+    startBlock();
+    
+    // Split the block at each event so changes land on their exact sample
+    int frame = 0;
+    int eventIndex = 0;
+    while (frame < numFrames) {
+        while (eventIndex < numEvents && events[eventIndex].sampleOffset <= frame) {
+            applyEvent(events[eventIndex++]);
+        }
+        int spanEnd = numFrames;
+        if (eventIndex < numEvents && events[eventIndex].sampleOffset < numFrames) {
+            spanEnd = events[eventIndex].sampleOffset;
+        }
+        processSpan(inputs, outputs, frame, spanEnd - frame);
+        frame = spanEnd;
+    }
+    
+    // Anything stamped at or past the end of the block takes effect after it
+    while (eventIndex < numEvents) {
+        applyEvent(events[eventIndex++]);
+    }
+    
+    finishBlock();
+    DATABENDER_TRACE_END("process", traceTrack, numFrames);
+    if (timingEnabled) {
+        auto elapsed = std::chrono::steady_clock::now() - blockStart;
+        if (blockMode == EngineStats::MODE_RAW_FROZEN && jumpCount != blockJumps) {
+            blockMode = EngineStats::MODE_CROSSFADE;
+        }
+        stats.record(blockMode, numFrames,
+                     static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+                     sampleRate);
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::startBlock() {
+    // A converted capture swaps in on the block boundary. Snapshot requests
+    // wait for it, so no slot shares pages of the old ring.
+    if (resamplePending) {
+        int ready = ResampleJob::READY;
+        if (resampleJob->state.compare_exchange_strong(ready, ResampleJob::SWAPPING, std::memory_order_acquire)) {
+            applyResample();
+        }
+    }
+    
+    // So does an event freeze analyzed on the pool
+    if (freezePending.load(std::memory_order_relaxed)) {
+        pollFreezeJob();
+    }
+    
+    // Snapshot requests from other threads land on the block boundary
+    if (snapshotPages && !resamplePending) {
+        int slot = pendingSnapshot.exchange(NO_REQUEST, std::memory_order_acquire);
+        if (slot != NO_REQUEST) {
+            applySnapshot(slot);
+        }
+        slot = pendingRecall.exchange(NO_REQUEST, std::memory_order_acquire);
+        if (slot != NO_REQUEST) {
+            applyRecall(slot);
+        }
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::finishBlock() {
+    // Tell readers of our ring how far it is filled, and look for onsets
+    // and silence in what this block recorded
+    if (!captureReader && !diskStore) {
+        captureSource->publishExtent(writePosition, bufferInitialized);
+        if (Config::ENABLE_ONSET_INDEX && !isFrozen) {
+            scanOnsets((writePosition - onsetScanPosition + captureSize) % captureSize);
+        }
+        if (usesSilenceMap() && !isFrozen) {
+            scanSilence(silenceMap, captureL, captureR,
+                        (writePosition - silenceMap.getPosition() + captureSize) % captureSize);
+        }
+    }
+    
+    // Let the disk store prefetch around the playhead and stutter targets
+    if (diskStore && isFrozen && playingSlot.load(std::memory_order_relaxed) == LIVE_TAKE) {
+        int stutterReach = static_cast<int>(repeats * captureSize * 0.02f) + captureSize / 200;
+        diskStore->setPlayhead(playheadFrame, stutterReach);
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::sampleBlockBoundary() {
+    DATABENDER_RT_SCOPE();
+    
+    // Ends the last SAMPLE_BLOCK frames and starts the next ones
+    finishBlock();
+    startBlock();
+    sampleFastPath = speedRampRemaining == 0 && takeFadeIndex >= CROSSFADE_LENGTH;
+    sampleCountdown = SAMPLE_BLOCK;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::renderSample(float inputL, float inputR, float& outputL, float& outputR) {
+    DATABENDER_RT_SCOPE();
+    ScopedFlushDenormals noDenormals;
+    
+    const float* inputs[2] = { &inputL, &inputR };
+    float* outputs[2] = { &outputL, &outputR };
+    processSpan(inputs, outputs, 0, 1);
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::processMicroBlock() {
+    const float* inputs[2] = { microInputL, microInputR };
+    float* outputs[2] = { microOutputL, microOutputR };
+    processBlock(inputs, outputs, microBlockSize, nullptr, 0);
+    microBlockFill = 0;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::setMicroBlockSize(int frames) {
+    frames = std::max(0, std::min(frames, MAX_MICRO_BLOCK));
+    if (frames == microBlockSize) {
+        return;
+    }
+    
+    // Frames still queued are dropped; the new delay starts out silent
+    microBlockSize = frames;
+    microBlockFill = 0;
+    std::memset(microOutputL, 0, sizeof(microOutputL));
+    std::memset(microOutputR, 0, sizeof(microOutputR));
+}
+
+template <typename Config>
+int BasicDataBenderEngine<Config>::getMicroBlockSize() const {
+    return microBlockSize;
+}
+
+template <typename Config>
+template <typename IO>
+void BasicDataBenderEngine<Config>::processSpan(const IO* inputs[2], IO* outputs[2], int offset, int numFrames) {
+    const IO* inputL = inputs[0] ? inputs[0] + offset : nullptr;
+    const IO* inputR = inputs[1] ? inputs[1] + offset : nullptr;
+    IO* outputL = outputs[0] + offset;
+    IO* outputR = outputs[1] + offset;
+    
+    // While the speed ramps, render in chunks with precomputed per-sample speeds
+    while (speedRampRemaining > 0 && numFrames > 0) {
+        int chunk = numFrames < SPEED_RAMP_CHUNK ? numFrames : SPEED_RAMP_CHUNK;
+        fillSpeedRamp(chunk);
+        renderFrames(inputL, inputR, outputL, outputR, chunk, speedRamp);
+        
+        inputL = inputL ? inputL + chunk : nullptr;
+        inputR = inputR ? inputR + chunk : nullptr;
+        outputL += chunk;
+        outputR += chunk;
+        numFrames -= chunk;
+    }
+    
+    if (numFrames > 0) {
+        renderFrames(inputL, inputR, outputL, outputR, numFrames, nullptr);
+    }
+}
+
+template <typename Config>
+template <typename IO>
+void BasicDataBenderEngine<Config>::renderFrames(const IO* inputL, const IO* inputR, IO* outputL, IO* outputR,
+                                                 int numFrames, const float* speeds) {
+    if (isFrozen && spectralFreeze) {
+        spectral->render(outputL, outputR, numFrames, playbackSpeed);
+    } else if (isFrozen && granular) {
+        renderGrains(outputL, outputR, numFrames, speeds);
+    } else if (isFrozen && preservePitch) {
+        renderStretch(outputL, outputR, numFrames, speeds);
+    } else if (isFrozen && !usesTrimmedPlayback()) {
+        // Raw frozen playback: read the whole span, then post-filter it in one pass
+        if (readFromBuffer(outputL, outputR, numFrames, speeds)) {
+            if constexpr (Config::ENABLE_POST_FILTER) {
+                postFilter.process(outputL, outputR, numFrames);
+            }
+        }
+    } else {
+        // Process each frame
+        for (int i = 0; i < numFrames; ++i) {
+            IO frameL, frameR;
+            if (speeds) {
+                playbackSpeed = speeds[i];
+            }
+            
+            processFrame(inputL ? inputL[i] : IO(0), inputR ? inputR[i] : IO(0), frameL, frameR);
+            
+            outputL[i] = frameL;
+            outputR[i] = frameR;
+        }
+    }
+    
+    // Fading out the take playing before a recall
+    if (takeFadeIndex < CROSSFADE_LENGTH) {
+        mixTakeFade(outputL, outputR, numFrames);
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::applyEvent(const DataBenderEvent& event) {
+    switch (event.type) {
+        case DataBenderEvent::SET_FREEZE:
+            if (freezePending.load(std::memory_order_relaxed)) {
+                // Lands with the freeze being analyzed
+                freezeWanted.store(event.value != 0.0f, std::memory_order_relaxed);
+            } else if ((event.value != 0.0f) != isFrozen) {
+                // Flushing the disk or reading another ring's whole capture
+                // is no work for the audio thread
+                if (event.value != 0.0f && (diskStore || captureReader)) {
+                    startFreezeJob();
+                } else {
+                    setFreeze(event.value != 0.0f);
+                }
+            }
+            break;
+        case DataBenderEvent::SET_PLAYBACK_SPEED:
+            setPlaybackSpeed(event.value);
+            break;
+        case DataBenderEvent::SET_REPEATS:
+            setRepeats(event.value);
+            break;
+        case DataBenderEvent::TAKE_SNAPSHOT:
+            applySnapshot(static_cast<int>(event.value));
+            break;
+        case DataBenderEvent::RECALL_SNAPSHOT:
+            applyRecall(static_cast<int>(event.value));
+            break;
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::fillSpeedRamp(int numFrames) {
+    // Each value is computed from the ramp start rather than accumulated, so
+    // the loop has no carried dependency and vectorizes
+    int rampFrames = numFrames < speedRampRemaining ? numFrames : speedRampRemaining;
+    float base = speedRampStart + speedRampStep * static_cast<float>(speedRampPosition + 1);
+    for (int i = 0; i < rampFrames; ++i) {
+        speedRamp[i] = base + speedRampStep * static_cast<float>(i);
+    }
+    for (int i = rampFrames; i < numFrames; ++i) {
+        speedRamp[i] = speedTarget;
+    }
+    
+    speedRampPosition += rampFrames;
+    speedRampRemaining -= rampFrames;
+    
+    // The last value is reached exactly, whatever the rounding along the way
+    if (speedRampRemaining == 0) {
+        speedRamp[rampFrames - 1] = speedTarget;
+    }
+    playbackSpeed = speedRamp[numFrames - 1];
+}
+
+template <typename Config>
+EngineStats::Mode BasicDataBenderEngine<Config>::currentMode() const {
+    if (!isFrozen) {
+        return EngineStats::MODE_PASSTHROUGH;
+    }
+    if (spectralFreeze) {
+        return EngineStats::MODE_SPECTRAL;
+    }
+    if (granular) {
+        return EngineStats::MODE_GRANULAR;
+    }
+    if (preservePitch) {
+        return EngineStats::MODE_STRETCH;
+    }
+    if (usesTrimmedPlayback()) {
+        return EngineStats::MODE_TRIMMED_FROZEN;
+    }
+    return inCrossfade ? EngineStats::MODE_CROSSFADE : EngineStats::MODE_RAW_FROZEN;
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::usesTrimmedPlayback() const {
+    if constexpr (!Config::ENABLE_TRIMMING) {
+        return false;
+    }
+    return playSegmentCount > 0;
+}
+
+template <typename Config>
+template <typename IO>
+void BasicDataBenderEngine<Config>::processFrame(IO inputL, IO inputR, IO& outputL, IO& outputR) {
+    if (isFrozen) {
+        // When frozen with trimmed segments, read from them (raw playback is
+        // handled per block in process())
+        float frozenL, frozenR;
+        readFromTrimmedBuffer(frozenL, frozenR);
+        outputL = frozenL;
+        outputR = frozenR;
+    } else {
+        // When not frozen, pass through (at full I/O precision) and update buffer
+        outputL = inputL;
+        outputR = inputR;
+        updateBuffer(static_cast<float>(inputL), static_cast<float>(inputR));
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::updateBuffer(float inputL, float inputR) {
+    // Readers play another engine's ring and record nothing, and nothing
+    // is recorded while a freeze is analyzed
+    if (captureReader || freezePending.load(std::memory_order_relaxed)) {
+        return;
+    }
+    
+    if (compactCapture) {
+        gateSample(inputL, inputR);
+        return;
+    }
+    
+    // Write to buffer
+    if (diskStore) {
+        diskStore->write(inputL, Config::CHANNELS == 2 ? inputR : inputL);
+    } else {
+        // Entering a page a snapshot still uses copies it out first
+        if ((writePosition & Pages::PAGE_MASK) == 0 && snapshotPages) {
+            snapshotPages->preservePage(writePosition >> Pages::PAGE_SHIFT);
+        }
+        bufferL[writePosition] = CaptureSample<Sample>::fromFloat(inputL);
+        if constexpr (Config::CHANNELS == 2) {
+            bufferR[writePosition] = CaptureSample<Sample>::fromFloat(inputR);
+        }
+    }
+    
+    // Advance write position
+    writePosition = (writePosition + 1) % captureSize;
+    
+    // Mark buffer as initialized after first complete cycle
+    if (writePosition == 0) {
+        bufferInitialized = true;
+        DATABENDER_TRACE_INSTANT("buffer-wrap", traceTrack, captureSize);
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::gateSample(float inputL, float inputR) {
+    // Hold the block back until we know whether it is silent. The whole
+    // block an onset falls in is kept, which gives up to MIN_SILENCE_LENGTH
+    // samples of pre-roll.
+    gatePendingL[gatePendingCount] = CaptureSample<Sample>::fromFloat(inputL);
+    if constexpr (Config::CHANNELS == 2) {
+        gatePendingR[gatePendingCount] = CaptureSample<Sample>::fromFloat(inputR);
+    }
+    
+    float levelR = Config::CHANNELS == 2 ? std::abs(inputR) : 0.0f;
+    if (std::abs(inputL) > SILENCE_THRESHOLD || levelR > SILENCE_THRESHOLD) {
+        gatePendingAudible = true;
+    }
+    
+    if (++gatePendingCount == MIN_SILENCE_LENGTH) {
+        commitGateBlock();
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::commitGateBlock() {
+    int count = gatePendingCount;
+    gatePendingCount = 0;
+    
+    // Hysteresis: the gate opens on any sample above the threshold but only
+    // closes after a whole block stays below it, same as the analysis pass
+    if (!gatePendingAudible) {
+        gateOpen = false;
+        return;
+    }
+    gatePendingAudible = false;
+    
+    // Segments whose start is about to be overwritten lose it to the ring
+    int capacity = static_cast<int>(segmentStarts.size());
+    while (segmentStartCount > 0) {
+        int start = segmentStarts[segmentStartHead];
+        int ahead = (start - writePosition + captureSize) % captureSize;
+        if (ahead >= count) {
+            break;
+        }
+        segmentStartHead = (segmentStartHead + 1) % capacity;
+        --segmentStartCount;
+    }
+    
+    if (!gateOpen) {
+        // New segment; merge the two oldest if the index is full
+        if (segmentStartCount == capacity) {
+            segmentStartHead = (segmentStartHead + 1) % capacity;
+            --segmentStartCount;
+        }
+        segmentStarts[(segmentStartHead + segmentStartCount) % capacity] = writePosition;
+        ++segmentStartCount;
+        gateOpen = true;
+        DATABENDER_TRACE_INSTANT("gate-open", traceTrack, writePosition);
+    }
+    
+    // Append the block, wrapping around the end of the ring
+    if (diskStore) {
+        for (int i = 0; i < count; ++i) {
+            diskStore->write(toFloat(gatePendingL[i]), toFloat(Config::CHANNELS == 2 ? gatePendingR[i] : gatePendingL[i]));
+        }
+    } else {
+        if (snapshotPages) {
+            snapshotPages->prepareWrite(writePosition, count);
+        }
+        int first = std::min(count, captureSize - writePosition);
+        std::memcpy(bufferL + writePosition, gatePendingL, first * sizeof(Sample));
+        std::memcpy(bufferL, gatePendingL + first, (count - first) * sizeof(Sample));
+        if constexpr (Config::CHANNELS == 2) {
+            std::memcpy(bufferR + writePosition, gatePendingR, first * sizeof(Sample));
+            std::memcpy(bufferR, gatePendingR + first, (count - first) * sizeof(Sample));
+        }
+    }
+    
+    writePosition += count;
+    if (writePosition >= captureSize) {
+        writePosition -= captureSize;
+        bufferInitialized = true;
+        DATABENDER_TRACE_INSTANT("buffer-wrap", traceTrack, captureSize);
+    }
+}
+
+template <typename Config>
+template <typename IO>
+void BasicDataBenderEngine<Config>::renderGrains(IO* outputL, IO* outputR, int numFrames, const float* speeds) {
+    bool trimmed = usesTrimmedPlayback();
+    int takeLength = trimmed ? playTrimmedLength : playCapturedSamples;
+    if (takeLength == 0) {
+        std::memset(outputL, 0, numFrames * sizeof(IO));
+        std::memset(outputR, 0, numFrames * sizeof(IO));
+        return;
+    }
+    
+    // The playhead the grains gather around is the one the read head uses
+    float& playhead = trimmed ? trimmedReadPosition : readPosition;
+    float* mixL = grains->getMixL();
+    float* mixR = grains->getMixR();
+    
+    for (int done = 0; done < numFrames;) {
+        int chunk = std::min(numFrames - done, static_cast<int>(Grains::MIX_FRAMES));
+        std::memset(mixL, 0, chunk * sizeof(float));
+        std::memset(mixR, 0, chunk * sizeof(float));
+        
+        // Split the chunk where grains start and end, so the cloud changes
+        // on the same samples whatever the block size
+        for (int frame = 0; frame < chunk;) {
+            if (grainCountdown <= 0) {
+                startGrain(takeLength);
+                grainCountdown = nextGrainInterval();
+            }
+            int span = std::min(std::min(chunk - frame, grainCountdown), grains->getNextEnd());
+            grains->template mix<CaptureSample<Sample>>(playPagesL, playPagesR, mixL + frame, mixR + frame, span);
+            
+            float distance = playbackSpeed * span;
+            if (speeds) {
+                distance = 0.0f;
+                for (int i = 0; i < span; ++i) {
+                    distance += speeds[done + frame + i];
+                }
+            }
+            playhead = std::fmod(playhead + distance, static_cast<float>(takeLength));
+            if (playhead < 0.0f) {
+                playhead += takeLength;
+            }
+            
+            grainCountdown -= span;
+            frame += span;
+        }
+        
+        for (int i = 0; i < chunk; ++i) {
+            outputL[done + i] = static_cast<IO>(mixL[i]);
+            outputR[done + i] = static_cast<IO>(mixR[i]);
+        }
+        done += chunk;
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::startGrain(int takeLength) {
+    if (grains->isFull() || grainDensity <= 0.0f) {
+        return;
+    }
+    
+    float step = std::min(std::max(std::abs(playbackSpeed), 0.0625f), 16.0f);
+    int length = std::max(static_cast<int>(grainLength * sampleRate), static_cast<int>(Grains::MIN_LENGTH));
+    
+    // Somewhere behind the playhead, within the spray
+    bool trimmed = usesTrimmedPlayback();
+    int position = static_cast<int>(trimmed ? trimmedReadPosition : readPosition);
+    position -= randomBelow(static_cast<int>(grainSpray * sampleRate) + 1);
+    position %= takeLength;
+    if (position < 0) {
+        position += takeLength;
+    }
+    
+    // A grain stays inside one stretch of audio: the ring on either side of
+    // the end when raw, its segment when trimmed. Segments are found by
+    // walking from the last one used.
+    int extentStart = 0;
+    int extentEnd = takeLength;
+    int first = 0;
+    if (!trimmed) {
+        first = rawFrame(position);
+        extentStart = first < playOldest ? 0 : playOldest;
+        extentEnd = first < playOldest ? playOldest : takeLength;
+    } else {
+        if (grainSegment >= playSegmentCount) {
+            grainSegment = 0;
+            grainSegmentOffset = 0;
+        }
+        while (position < grainSegmentOffset) {
+            --grainSegment;
+            grainSegmentOffset -= playSegments[grainSegment].length;
+        }
+        while (position >= grainSegmentOffset + playSegments[grainSegment].length) {
+            grainSegmentOffset += playSegments[grainSegment].length;
+            ++grainSegment;
+        }
+        const AudioSegment& segment = playSegments[grainSegment];
+        extentStart = segment.start;
+        extentEnd = segment.start + segment.length;
+        first = segment.start + position - grainSegmentOffset;
+    }
+    
+    // Reads reach (length - 1) * step + 1 frames past the first one. Move
+    // the grain back to fit, and shorten it if the stretch is too short.
+    int span = static_cast<int>(std::ceil((length - 1) * step)) + 2;
+    if (span > extentEnd - extentStart) {
+        length = static_cast<int>((extentEnd - extentStart - 2) / step) + 1;
+        if (length < Grains::MIN_LENGTH) {
+            return;
+        }
+        span = static_cast<int>(std::ceil((length - 1) * step)) + 2;
+    }
+    first = std::max(extentStart, std::min(first, extentEnd - span));
+    
+    // Keep the level steady however many grains overlap
+    float overlap = grainDensity * length / sampleRate;
+    grains->start(first, step, length, 1.0f / std::sqrt(std::max(overlap, 1.0f)));
+    playheadFrame = first;
+    DATABENDER_TRACE_INSTANT("grain", traceTrack, first);
+}
+
+template <typename Config>
+int BasicDataBenderEngine<Config>::nextGrainInterval() {
+    // Idle grains re-check the density every scratch block
+    if (grainDensity <= 0.0f) {
+        return Grains::MIX_FRAMES;
+    }
+    
+    // Jittered around the mean spacing so the cloud has no pulse
+    float spacing = sampleRate / grainDensity;
+    return std::max(1, static_cast<int>(spacing * (0.5f + randomUnit())));
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::resetGrains() {
+    // A new take starts a new cloud straight away
+    if (grains) {
+        grains->clear();
+    }
+    grainCountdown = 0;
+    grainSegment = 0;
+    grainSegmentOffset = 0;
+}
+
+template <typename Config>
+template <typename IO>
+void BasicDataBenderEngine<Config>::renderStretch(IO* outputL, IO* outputR, int numFrames, const float* speeds) {
+    bool trimmed = usesTrimmedPlayback();
+    int takeLength = trimmed ? playTrimmedLength : playCapturedSamples;
+    if (takeLength == 0) {
+        std::memset(outputL, 0, numFrames * sizeof(IO));
+        std::memset(outputR, 0, numFrames * sizeof(IO));
+        return;
+    }
+    
+    // The analysis position is the read head the other paths use
+    float& playhead = trimmed ? trimmedReadPosition : readPosition;
+    auto gather = [this](int position, int count, float* left, float* right) {
+        gatherTake(position, count, left, right);
+    };
+    
+    for (int done = 0; done < numFrames;) {
+        if (stretch->needsHop()) {
+            // Repeats at the per-sample rate of the other paths, decided once
+            // per hop. The jump is crossfaded by the next frame's overlap.
+            if (Config::ENABLE_REPEATS && repeats > 0.0f
+                && randomUnit() < repeats * 0.0003f * TimeStretch::HOP) {
+                int maxSkipBack = static_cast<int>(repeats * takeLength * 0.02f);
+                int skipBack = randomBelow(maxSkipBack) + (takeLength / 200);
+                playhead -= skipBack;
+                if (playhead < 0.0f) {
+                    playhead += takeLength;
+                }
+                if (onsetSnap && playOnsetCount > 0) {
+                    playhead = static_cast<float>(snapJump(static_cast<int>(playhead), skipBack));
+                }
+                ++jumpCount;
+                DATABENDER_TRACE_INSTANT("repeat-jump", traceTrack, skipBack);
+            }
+            
+            stretch->synthesize(gather, static_cast<int>(playhead));
+            
+            // The speed moves the analysis position only
+            float speed = speeds ? speeds[done] : playbackSpeed;
+            playhead = std::fmod(playhead + speed * TimeStretch::HOP, static_cast<float>(takeLength));
+            if (playhead < 0.0f) {
+                playhead += takeLength;
+            }
+        }
+        done += stretch->read(outputL + done, outputR + done, numFrames - done);
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::gatherTake(int position, int count, float* left, float* right) {
+    bool trimmed = usesTrimmedPlayback();
+    int takeLength = trimmed ? playTrimmedLength : playCapturedSamples;
+    position %= takeLength;
+    if (position < 0) {
+        position += takeLength;
+    }
+    
+    if (!trimmed) {
+        // Ring order is take order from here, apart from the wrap
+        position = rawFrame(position);
+        playheadFrame = position;
+        for (int i = 0; i < count; ++i) {
+            left[i] = playL(position);
+            right[i] = playR(position);
+            if (++position == takeLength) {
+                position = 0;
+            }
+        }
+        return;
+    }
+    
+    // Walk to the segment holding position from the one read last
+    if (gatherSegment >= playSegmentCount) {
+        gatherSegment = 0;
+        gatherSegmentOffset = 0;
+    }
+    while (position < gatherSegmentOffset) {
+        --gatherSegment;
+        gatherSegmentOffset -= playSegments[gatherSegment].length;
+    }
+    while (position >= gatherSegmentOffset + playSegments[gatherSegment].length) {
+        gatherSegmentOffset += playSegments[gatherSegment].length;
+        ++gatherSegment;
+    }
+    
+    // Copy segment by segment, wrapping to the first after the last
+    int segment = gatherSegment;
+    int offset = position - gatherSegmentOffset;
+    playheadFrame = playSegments[segment].start + offset;
+    for (int i = 0; i < count;) {
+        const AudioSegment& current = playSegments[segment];
+        int run = std::min(count - i, current.length - offset);
+        for (int j = 0; j < run; ++j) {
+            left[i + j] = playL(current.start + offset + j);
+            right[i + j] = playR(current.start + offset + j);
+        }
+        i += run;
+        offset = 0;
+        segment = segment + 1 == playSegmentCount ? 0 : segment + 1;
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::resetStretch() {
+    // A new take starts without searching against the old one
+    if (stretch) {
+        stretch->reset();
+    }
+    gatherSegment = 0;
+    gatherSegmentOffset = 0;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::analyzeSpectrum() {
+    int length = spectral->getHistoryLength();
+    float* historyL = spectral->getHistoryL();
+    float* historyR = spectral->getHistoryR();
+    
+    // The audio leading up to the freeze point: the end of a trimmed take
+    // (its silence is already gone), or the frames before spectralPoint.
+    // Takes shorter than the history wrap around.
+    if (usesTrimmedPlayback() && playTrimmedLength > 0) {
+        int segment = playSegmentCount - 1;
+        int remaining = playSegments[segment].length;
+        for (int i = length - 1; i >= 0; --i) {
+            while (remaining == 0) {
+                segment = segment == 0 ? playSegmentCount - 1 : segment - 1;
+                remaining = playSegments[segment].length;
+            }
+            --remaining;
+            int frame = playSegments[segment].start + remaining;
+            historyL[i] = playL(frame);
+            historyR[i] = playR(frame);
+        }
+    } else if (playCapturedSamples > 0) {
+        int frame = (spectralPoint - length) % playCapturedSamples;
+        if (frame < 0) {
+            frame += playCapturedSamples;
+        }
+        frame = rawFrame(frame);
+        for (int i = 0; i < length; ++i) {
+            historyL[i] = playL(frame);
+            historyR[i] = playR(frame);
+            if (++frame == playCapturedSamples) {
+                frame = 0;
+            }
+        }
+    } else {
+        std::memset(historyL, 0, length * sizeof(float));
+        std::memset(historyR, 0, length * sizeof(float));
+    }
+    
+    spectral->analyze(nextRandom());
+    DATABENDER_TRACE_INSTANT("spectral-analyze", traceTrack, spectralPoint);
+}
+
+template <typename Config>
+template <typename IO>
+bool BasicDataBenderEngine<Config>::readFromBuffer(IO* outputL, IO* outputR, int numFrames, const float* speeds) {
+    // Raw (untrimmed) playback of the whole take
+    int capturedSamples = playCapturedSamples;
+    
+    // If no audio captured yet, output silence
+    if (capturedSamples == 0) {
+        std::memset(outputL, 0, numFrames * sizeof(IO));
+        std::memset(outputR, 0, numFrames * sizeof(IO));
+        return false;
+    }
+    
+    // The newest frames crossfade into the oldest, so the loop is
+    // CROSSFADE_LENGTH shorter than the take
+    int loopLength = capturedSamples > 2 * CROSSFADE_LENGTH ? capturedSamples - CROSSFADE_LENGTH : capturedSamples;
+    
+    for (int frame = 0; frame < numFrames; ++frame) {
+        // Apply stuttering/repeats effect
+        if (Config::ENABLE_REPEATS && repeats > 0.0f) {
+            // Calculate skipping probability based on repeats value - more noticeable
+            float skipProb = repeats * 0.0003f; // 0-0.03% probability at max (was 0.0001f)
+            
+            // Check if we should skip the playhead back
+            if (randomUnit() < skipProb) {
+                // Calculate how far back to skip - very small amounts
+                int maxSkipBack = static_cast<int>(repeats * capturedSamples * 0.02f); // Up to 2% of buffer (was 0.08f)
+                int skipBack = randomBelow(maxSkipBack) + (capturedSamples / 200); // Minimum 0.5% of buffer (was /100)
+                
+                // Start crossfade to prevent pops
+                ++jumpCount;
+                DATABENDER_TRACE_INSTANT("repeat-jump", traceTrack, skipBack);
+                startCrossfade(static_cast<int>(readPosition));
+                
+                // Jump playhead back
+                readPosition = readPosition - skipBack;
+                
+                // Ensure we don't go negative
+                if (readPosition < 0) {
+                    readPosition = loopLength + readPosition;
+                }
+                
+                // Land on a note start if one is close
+                if (onsetSnap && playOnsetCount > 0) {
+                    readPosition = static_cast<float>(snapJump(static_cast<int>(readPosition), skipBack));
+                }
+            }
+        }
+        
+        // At the end of the take, loop back to the oldest audio. The rest of
+        // the take fades out under it.
+        if (readPosition >= loopLength) {
+            if (loopLength < capturedSamples) {
+                startCrossfade(static_cast<int>(readPosition));
+            }
+            readPosition -= loopLength;
+            if (readPosition >= loopLength) {
+                readPosition = 0;
+            }
+        }
+        
+        // Read from buffer with speed control
+        int readPos = static_cast<int>(readPosition);
+        int ringPos = rawFrame(readPos);
+        float currentL = playL(ringPos);
+        float currentR = playR(ringPos);
+        if constexpr (Config::INTERPOLATION_ORDER == 1) {
+            // Linear interpolation towards the next captured frame
+            int nextPos = readPos + 1 < capturedSamples ? rawFrame(readPos + 1) : playOldest;
+            float fraction = readPosition - readPos;
+            currentL += (playL(nextPos) - currentL) * fraction;
+            currentR += (playR(nextPos) - currentR) * fraction;
+        }
+        playheadFrame = ringPos;
+        
+        // Apply crossfade if active
+        if (inCrossfade) {
+            mixCrossfade(currentL, currentR);
+        }
+        outputL[frame] = currentL;
+        outputR[frame] = currentR;
+        
+        // Advance read position with speed control
+        readPosition += speeds ? speeds[frame] : playbackSpeed;
+    }
+    
+    // DC blocking and smoothing are applied to the block by the caller
+    return true;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::startCrossfade(int position) {
+    // Keep the audio from position on to fade out under the jump target
+    inCrossfade = true;
+    crossfadeIndex = 0;
+    crossfadeGain = 1.0f;
+    gatherTake(position, CROSSFADE_LENGTH, crossfadeBufferL, crossfadeBufferR);
+    DATABENDER_TRACE_INSTANT("crossfade-start", traceTrack, CROSSFADE_LENGTH);
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::mixCrossfade(float& left, float& right) {
+    // Cosine curves that sum to one, as for take switches
+    float fadeOut = 0.5f * (1.0f + std::cos(static_cast<float>(crossfadeIndex) / CROSSFADE_LENGTH * 3.14159f));
+    float fadeIn = 1.0f - fadeOut;
+    
+    left = (crossfadeBufferL[crossfadeIndex] * fadeOut) + (left * fadeIn);
+    right = (crossfadeBufferR[crossfadeIndex] * fadeOut) + (right * fadeIn);
+    
+    crossfadeIndex++;
+    if (crossfadeIndex >= CROSSFADE_LENGTH) {
+        inCrossfade = false;
+        DATABENDER_TRACE_INSTANT("crossfade-end", traceTrack, 0);
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::setFreeze(bool freeze) {
+    // An event freeze still being analyzed lands first
+    settleFreezeJob();
+    
+    if (freeze && !isFrozen) {
+        beginFreeze();
+        analyzeTake();
+        startTake();
+    }
+    if (!freeze && playingSlot.load(std::memory_order_relaxed) != LIVE_TAKE) {
+        // Capture resumes on the live take
+        playingSlot.store(LIVE_TAKE, std::memory_order_relaxed);
+        selectLiveTake();
+        takeFadeIndex = CROSSFADE_LENGTH;
+    }
+    isFrozen = freeze;
+    DATABENDER_TRACE_INSTANT(freeze ? "freeze" : "unfreeze", traceTrack + 1, totalTrimmedLength);
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::beginFreeze() {
+    // Keep the partial block the gate is holding back
+    if (compactCapture) {
+        if (gatePendingCount > 0) {
+            commitGateBlock();
+        }
+        gateOpen = false;
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::analyzeTake() {
+    // Make spilled audio visible through the mapped view
+    if (diskStore) {
+        diskStore->flush();
+    }
+    
+    // A reader freezes whatever its writer has recorded so far
+    if (captureReader) {
+        captureSource->loadExtent(writePosition, bufferInitialized);
+    }
+    
+    // Analyze and trim silence from the buffer - compact capture
+    // already dropped it and only has to walk its segment index, and
+    // readers reuse the writer's map when it covers the same audio
+    if constexpr (Config::ENABLE_TRIMMING) {
+        if (captureReader) {
+            beginLiveTables();
+            int sharedCount = captureSource->getTrimCount();
+            if (sharedCount >= 0 && trimmedSegments.reserve(sharedCount) &&
+                captureSource->readTrimMap(trimmedSegments.data(), sharedCount, sharedCount, totalTrimmedLength,
+                                           writePosition, bufferInitialized)) {
+                trimmedSegments.resize(sharedCount);
+                segmentsInitialized = true;
+                DATABENDER_TRACE_INSTANT("shared-trim-map", traceTrack + 1, sharedCount);
+            } else {
+                analyzeAndTrimSilence();
+            }
+        } else if (compactCapture) {
+            buildCompactSegments();
+        } else {
+            analyzeAndTrimSilence();
+        }
+        
+        if (!captureReader && !diskStore) {
+            captureSource->publishTrimMap(trimmedSegments.data(), static_cast<int>(trimmedSegments.size()),
+                                          totalTrimmedLength, writePosition, bufferInitialized);
+        }
+    } else {
+        beginLiveTables();
+    }
+    
+    buildOnsetIndex();
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::startTake() {
+    // Start reading from the oldest audio; the spectral history is the
+    // newest, just before the take wraps
+    readPosition = 0.0f;
+    trimmedReadPosition = 0.0f;
+    playingSlot.store(LIVE_TAKE, std::memory_order_relaxed);
+    selectLiveTake();
+    spectralPoint = 0;
+    if (spectralFreeze) {
+        analyzeSpectrum();
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::startFreezeJob() {
+    // Audio thread. Recording stops here, so the task sees a still capture;
+    // the take starts once it is done (see pollFreezeJob).
+    beginFreeze();
+    freezePending.store(true, std::memory_order_relaxed);
+    freezeWanted.store(true, std::memory_order_relaxed);
+    freezeJob.store(FREEZE_REQUESTED, std::memory_order_release);
+    DATABENDER_TRACE_INSTANT("freeze-requested", traceTrack + 1, 0);
+    pollFreezeJob();
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::pollFreezeJob() {
+    int state = freezeJob.load(std::memory_order_acquire);
+    if (state == FREEZE_READY) {
+        finishFreezeJob();
+        return;
+    }
+    
+    // The task's flush() must not wait on spills queued behind it, so it is
+    // only queued once they are done. settleFreezeJob() may claim the job
+    // first; a full queue hands it back for the next block.
+    if (state == FREEZE_REQUESTED && (!diskStore || diskStore->isSpilled()) &&
+        freezeJob.compare_exchange_strong(state, FREEZE_RUNNING, std::memory_order_acq_rel)) {
+        if (!WorkerPool::global().submit(WorkerPool::PRIORITY_ANALYSIS, &BasicDataBenderEngine::freezeTask, this,
+                                         backgroundTasks)) {
+            freezeJob.store(FREEZE_REQUESTED, std::memory_order_release);
+        }
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::freezeTask(void* context) {
+    BasicDataBenderEngine& engine = *static_cast<BasicDataBenderEngine*>(context);
+    engine.analyzeTake();
+    engine.freezeJob.store(FREEZE_READY, std::memory_order_release);
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::finishFreezeJob() {
+    // The audio thread and settleFreezeJob() may both get here; one does
+    int ready = FREEZE_READY;
+    if (!freezeJob.compare_exchange_strong(ready, FREEZE_IDLE, std::memory_order_acq_rel)) {
+        return;
+    }
+    
+    // Unfrozen again meanwhile: recording just resumes
+    if (freezeWanted.load(std::memory_order_relaxed)) {
+        startTake();
+        isFrozen = true;
+    }
+    freezePending.store(false, std::memory_order_release);
+    DATABENDER_TRACE_INSTANT(isFrozen ? "freeze" : "unfreeze", traceTrack + 1, totalTrimmedLength);
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::settleFreezeJob() {
+    // Control thread: finish an event freeze here rather than wait for the
+    // audio thread. Whoever claims the job runs its analysis, so it runs
+    // once however the two threads interleave.
+    for (;;) {
+        int state = freezeJob.load(std::memory_order_acquire);
+        if (state == FREEZE_IDLE && !freezePending.load(std::memory_order_acquire)) {
+            return;
+        }
+        if (state == FREEZE_READY) {
+            finishFreezeJob();
+        } else if (state == FREEZE_REQUESTED &&
+                   freezeJob.compare_exchange_strong(state, FREEZE_RUNNING, std::memory_order_acq_rel)) {
+            analyzeTake();
+            freezeJob.store(FREEZE_READY, std::memory_order_release);
+        } else if (state != FREEZE_REQUESTED) {
+            // Running, or the audio thread is starting the take
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::getFreeze() const {
+    return isFrozen;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::clearBuffer() {
+    settleFreezeJob();
+    DATABENDER_TRACE_INSTANT("clear-buffer", traceTrack + 1, 0);
+    
+    // Snapshots keep whatever they share with the ring
+    if (snapshotPages) {
+        snapshotPages->preserveAll();
+    }
+    
+    // Clear buffers (a shared ring belongs to its writer, and long capture
+    // has none)
+    if (!captureReader && !diskStore) {
+        std::memset(bufferL, 0, BUFFER_SIZE * sizeof(Sample));
+        std::memset(bufferR, 0, BUFFER_SIZE * sizeof(Sample));
+    }
+    
+    // The file keeps stale audio, but nothing before writePosition is read
+    if (diskStore) {
+        diskStore->reset();
+    }
+    
+    // Reset positions
+    writePosition = 0;
+    readPosition = 0;
+    bufferInitialized = false;
+    resetGate();
+    resetOnsets();
+    silenceMap.reset(0);
+    
+    // Clear trimmed segments
+    clearTrimmedSegments();
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::clearTrimmedSegments() {
+    // Segments only reference the capture view, and their generation goes
+    // at the next analysis, nothing to free
+    trimmedSegments.clear();
+    totalTrimmedLength = 0;
+    segmentsInitialized = false;
+    if (playingSlot.load(std::memory_order_relaxed) == LIVE_TAKE) {
+        selectLiveTake();
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::beginLiveTables() {
+    // A new analysis pass: the live take's segments and onsets start over
+    // in a fresh generation. Snapshots of the old tables keep them; the
+    // live take lets go once it has moved to the new ones.
+    int previous = liveGeneration;
+    liveGeneration = arena.begin();
+    trimmedSegments.start(arena);
+    liveOnsets.start(arena);
+    clearTrimmedSegments();
+    arena.release(previous);
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::reserveAnalysis() {
+    // Every table goes with the old block, including the snapshots'
+    for (Take& take : snapshots) {
+        take = Take();
+    }
+    trimmedSegments = ArenaList<AudioSegment>();
+    liveOnsets = ArenaList<int>();
+    liveGeneration = AnalysisArena::NO_GENERATION;
+    arena.reserve(analysisBudget);
+    clearTrimmedSegments();
+    std::cout << "ANALYSIS: Reserved " << arena.getCapacity() << " bytes" << std::endl;
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::isSilence(int start, int length) const {
+    // Check if a block of audio is silence
+    int pos = start;
+    for (int i = 0; i < length; ++i) {
+        float levelL = std::abs(toFloat(captureL[pos]));
+        float levelR = std::abs(toFloat(captureR[pos]));
+        
+        if (levelL > SILENCE_THRESHOLD || levelR > SILENCE_THRESHOLD) {
+            return false;
+        }
+        if (++pos == captureSize) {
+            pos = 0;
+        }
+    }
+    return true;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::scanSilence(SilenceMap& map, const Sample* left, const Sample* right, int numFrames) {
+    // First and last audible frame of each piece up to a chunk boundary,
+    // judged as isSilence() does
+    auto audible = [&](int frame) {
+        return std::abs(toFloat(left[frame])) > SILENCE_THRESHOLD || std::abs(toFloat(right[frame])) > SILENCE_THRESHOLD;
+    };
+    while (numFrames > 0) {
+        int start = map.getPosition();
+        int count = std::min(numFrames, map.getRoom());
+        int first = 0;
+        while (first < count && !audible(start + first)) {
+            ++first;
+        }
+        int last = count - 1;
+        while (last > first && !audible(start + last)) {
+            --last;
+        }
+        if (first == count) {
+            map.feed(count, SilenceMap::NONE, SilenceMap::NONE);
+        } else {
+            map.feed(count, first, last);
+        }
+        numFrames -= count;
+    }
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::usesSilenceMap() const {
+    // Long capture and readers have no scan behind their write head, and
+    // compact capture keeps no silence to find
+    return Config::ENABLE_TRIMMING && !captureReader && !diskStore && !compactCapture;
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::isSilentBlock(int start, int length) const {
+    // The frames are only read where the map can't tell
+    while (length > 0) {
+        int part = std::min(length, captureSize - start);
+        SilenceMap::Answer answer = silenceMap.query(start, start + part);
+        if (answer == SilenceMap::AUDIBLE || (answer == SilenceMap::UNKNOWN && !isSilence(start, part))) {
+            return false;
+        }
+        start = 0;
+        length -= part;
+    }
+    return true;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::analyzeAndTrimSilence() {
+    DATABENDER_TRACE_BEGIN("analyze-trim", traceTrack + 1, 0);
+    beginLiveTables();
+    
+    // Determine how much audio we have captured
+    int capturedSamples = writePosition;
+    if (bufferInitialized) {
+        capturedSamples = captureSize; // Full buffer
+    }
+    
+    if (capturedSamples == 0) {
+        DATABENDER_TRACE_END("analyze-trim", traceTrack + 1, 0);
+        return;
+    }
+    
+    // The owner's silence map answers for most blocks once it has caught up
+    bool mapped = usesSilenceMap();
+    if (mapped) {
+        scanSilence(silenceMap, captureL, captureR, (writePosition - silenceMap.getPosition() + captureSize) % captureSize);
+    }
+    
+    // Positions count from the oldest frame, so segments come out in the
+    // order they were recorded however far the ring has wrapped
+    int oldest = bufferInitialized ? writePosition : 0;
+    int currentPos = 0;
+    bool inAudio = false;
+    int audioStart = 0;
+    
+    while (currentPos < capturedSamples) {
+        // Check if current position is silence
+        int blockStart = oldest + currentPos;
+        if (blockStart >= captureSize) {
+            blockStart -= captureSize;
+        }
+        int blockLength = std::min(MIN_SILENCE_LENGTH, capturedSamples - currentPos);
+        bool currentIsSilence = mapped ? isSilentBlock(blockStart, blockLength) : isSilence(blockStart, blockLength);
+        
+        if (!inAudio && !currentIsSilence) {
+            // Transition from silence to audio
+            audioStart = currentPos;
+            inAudio = true;
+        } else if (inAudio && currentIsSilence) {
+            // Transition from audio to silence
+            int audioLength = currentPos - audioStart;
+            
+            if (audioLength >= MIN_AUDIO_LENGTH) {
+                // Create segment for this audio block
+                addRingSegment((oldest + audioStart) % captureSize, audioLength);
+            }
+            
+            inAudio = false;
+        }
+        
+        currentPos += MIN_SILENCE_LENGTH;
+    }
+    
+    // Handle final audio block if we end in audio
+    if (inAudio) {
+        int audioLength = capturedSamples - audioStart;
+        if (audioLength >= MIN_AUDIO_LENGTH) {
+            addRingSegment((oldest + audioStart) % captureSize, audioLength);
+        }
+    }
+    
+    trimmedSegments.shrinkToFit();
+    segmentsInitialized = true;
+    DATABENDER_TRACE_END("analyze-trim", traceTrack + 1, static_cast<long long>(trimmedSegments.size()));
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::buildCompactSegments() {
+    DATABENDER_TRACE_BEGIN("index-segments", traceTrack + 1, 0);
+    beginLiveTables();
+    
+    // The ring holds only audio, oldest first from the write position once
+    // it has wrapped
+    int storedSamples = bufferInitialized ? captureSize : writePosition;
+    int oldest = bufferInitialized ? writePosition : 0;
+    
+    if (storedSamples > 0) {
+        // The oldest segment may have lost its start to the ring
+        int capacity = static_cast<int>(segmentStarts.size());
+        int segmentOffset = 0;
+        for (int i = 0; i < segmentStartCount; ++i) {
+            int start = segmentStarts[(segmentStartHead + i) % capacity];
+            int offset = (start - oldest + captureSize) % captureSize;
+            if (offset > segmentOffset) {
+                addRingSegment((oldest + segmentOffset) % captureSize, offset - segmentOffset);
+                segmentOffset = offset;
+            }
+        }
+        addRingSegment((oldest + segmentOffset) % captureSize, storedSamples - segmentOffset);
+    }
+    
+    trimmedSegments.shrinkToFit();
+    segmentsInitialized = true;
+    DATABENDER_TRACE_END("index-segments", traceTrack + 1, static_cast<long long>(trimmedSegments.size()));
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::addRingSegment(int start, int length) {
+    if (length < MIN_AUDIO_LENGTH) {
+        return;
+    }
+    
+    // A segment crossing the end of the ring is played as two
+    while (length > 0) {
+        int part = std::min(length, captureSize - start);
+        AudioSegment segment;
+        segment.start = start;
+        segment.length = part;
+        if (!trimmedSegments.push_back(segment)) {
+            return; // Out of arena: the take ends with the segments that fit
+        }
+        totalTrimmedLength += part;
+        
+        start = 0;
+        length -= part;
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::resetGate() {
+    gatePendingCount = 0;
+    gatePendingAudible = false;
+    gateOpen = false;
+    segmentStartHead = 0;
+    segmentStartCount = 0;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::reserveOnsets() {
+    // The detector's holdoff bounds the count, so neither scanning nor
+    // indexing grows a vector on the audio thread. The index itself lives
+    // in the arena.
+    if constexpr (!Config::ENABLE_ONSET_INDEX) {
+        return;
+    }
+    int maxOnsets = captureSize / (OnsetDetector::HOP * OnsetDetector::HOLDOFF_HOPS) + 1;
+    onsetStarts.assign(maxOnsets, 0);
+    onsetScratch.reserve(maxOnsets);
+    resetOnsets();
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::resetOnsets() {
+    onsetDetector.reset();
+    onsetStartHead = 0;
+    onsetStartCount = 0;
+    onsetScanPosition = 0;
+    onsetHopFill = 0;
+    onsetHopEnergy = 0.0f;
+    liveOnsets.clear();
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::scanOnsets(int numFrames) {
+    if constexpr (Config::ENABLE_ONSET_INDEX) {
+        // Onsets in the frames about to be scanned have been overwritten
+        int capacity = static_cast<int>(onsetStarts.size());
+        while (onsetStartCount > 0) {
+            int ahead = (onsetStarts[onsetStartHead] - onsetScanPosition + captureSize) % captureSize;
+            if (ahead >= numFrames) {
+                break;
+            }
+            onsetStartHead = (onsetStartHead + 1) % capacity;
+            --onsetStartCount;
+        }
+        
+        while (numFrames > 0) {
+            int chunk = std::min(std::min(numFrames, OnsetDetector::HOP - onsetHopFill), captureSize - onsetScanPosition);
+            const Sample* left = captureL + onsetScanPosition;
+            const Sample* right = captureR + onsetScanPosition;
+            // Independent partial sums, so the loop vectorizes
+            float lanes[8] = {};
+            int i = 0;
+            for (; i + 8 <= chunk; i += 8) {
+                for (int lane = 0; lane < 8; ++lane) {
+                    float sampleL = toFloat(left[i + lane]);
+                    float sampleR = Config::CHANNELS == 2 ? toFloat(right[i + lane]) : 0.0f;
+                    lanes[lane] += sampleL * sampleL + sampleR * sampleR;
+                }
+            }
+            float energy = 0.0f;
+            for (int lane = 0; lane < 8; ++lane) {
+                energy += lanes[lane];
+            }
+            for (; i < chunk; ++i) {
+                float sampleL = toFloat(left[i]);
+                float sampleR = Config::CHANNELS == 2 ? toFloat(right[i]) : 0.0f;
+                energy += sampleL * sampleL + sampleR * sampleR;
+            }
+            onsetHopEnergy += energy;
+            onsetHopFill += chunk;
+            onsetScanPosition += chunk;
+            if (onsetScanPosition == captureSize) {
+                onsetScanPosition = 0;
+            }
+            numFrames -= chunk;
+            
+            if (onsetHopFill < OnsetDetector::HOP) {
+                continue;
+            }
+            if (onsetDetector.addHop(onsetHopEnergy / (OnsetDetector::HOP * Config::CHANNELS))) {
+                // Drop the oldest if the index is full
+                if (onsetStartCount == capacity) {
+                    onsetStartHead = (onsetStartHead + 1) % capacity;
+                    --onsetStartCount;
+                }
+                int start = onsetScanPosition - OnsetDetector::HOP;
+                onsetStarts[(onsetStartHead + onsetStartCount) % capacity] = start < 0 ? start + captureSize : start;
+                ++onsetStartCount;
+            }
+            onsetHopEnergy = 0.0f;
+            onsetHopFill = 0;
+        }
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::buildOnsetIndex() {
+    if constexpr (!Config::ENABLE_ONSET_INDEX) {
+        return;
+    }
+    DATABENDER_TRACE_BEGIN("index-onsets", traceTrack + 1, 0);
+    
+    if (captureReader || diskStore) {
+        // Nothing scanned this capture while it was recorded, do it now,
+        // oldest first
+        resetOnsets();
+        onsetScanPosition = bufferInitialized ? writePosition : 0;
+        scanOnsets(bufferInitialized ? captureSize : writePosition);
+    } else {
+        scanOnsets((writePosition - onsetScanPosition + captureSize) % captureSize);
+    }
+    indexOnsets();
+    
+    DATABENDER_TRACE_END("index-onsets", traceTrack + 1, static_cast<long long>(liveOnsets.size()));
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::indexOnsets() {
+    // Oldest first, so the ring positions are sorted apart from one wrap
+    int capacity = static_cast<int>(onsetStarts.size());
+    onsetScratch.clear();
+    for (int i = 0; i < onsetStartCount; ++i) {
+        onsetScratch.push_back(onsetStarts[(onsetStartHead + i) % capacity]);
+    }
+    std::rotate(onsetScratch.begin(), std::is_sorted_until(onsetScratch.begin(), onsetScratch.end()), onsetScratch.end());
+    
+    liveOnsets.clear();
+    if (!segmentsInitialized || trimmedSegments.empty()) {
+        // Raw playback counts from the oldest frame
+        int oldest = bufferInitialized ? writePosition : 0;
+        for (int i = 0; i < onsetStartCount; ++i) {
+            int start = onsetStarts[(onsetStartHead + i) % capacity] - oldest;
+            liveOnsets.push_back(start < 0 ? start + captureSize : start);
+        }
+        std::rotate(liveOnsets.begin(), std::is_sorted_until(liveOnsets.begin(), liveOnsets.end()), liveOnsets.end());
+    } else {
+        // Trimmed playback plays the segments back to back; audio starting
+        // after silence is an onset too, unless it only continues the
+        // previous segment across the end of the ring
+        int offset = 0;
+        int previousEnd = -1;
+        for (const AudioSegment& segment : trimmedSegments) {
+            bool continues = segment.start == 0 && previousEnd == captureSize;
+            int first = segment.start;
+            if (!continues) {
+                liveOnsets.push_back(offset);
+                first += OnsetDetector::HOP * OnsetDetector::HOLDOFF_HOPS;
+            }
+            auto onset = std::lower_bound(onsetScratch.begin(), onsetScratch.end(), first);
+            for (; onset != onsetScratch.end() && *onset < segment.start + segment.length; ++onset) {
+                liveOnsets.push_back(offset + *onset - segment.start);
+            }
+            offset += segment.length;
+            previousEnd = segment.start + segment.length;
+        }
+    }
+    liveOnsets.shrinkToFit();
+}
+
+template <typename Config>
+int BasicDataBenderEngine<Config>::snapJump(int target, int skipBack) const {
+    // Moving the target by at most half the jump keeps it a jump back
+    return OnsetDetector::snap(playOnsets, playOnsetCount, target, skipBack / 2);
+}
+
+template <typename Config>
+int BasicDataBenderEngine<Config>::findAudioStart() const {
+    // Determine how much audio we have captured
+    int capturedSamples = writePosition;
+    if (bufferInitialized) {
+        capturedSamples = captureSize; // Full buffer
+    }
+    
+    if (capturedSamples == 0) {
+        return 0;
+    }
+    
+    // Threshold for silence detection (adjust as needed)
+    const float silenceThreshold = SILENCE_THRESHOLD;
+    
+    // Look for the first sample that's above the silence threshold, oldest
+    // first: from the write position once the ring has wrapped
+    int pos = bufferInitialized ? writePosition : 0;
+    for (int i = 0; i < capturedSamples; ++i) {
+        float levelL = std::abs(toFloat(captureL[pos]));
+        float levelR = std::abs(toFloat(captureR[pos]));
+        
+        if (levelL > silenceThreshold || levelR > silenceThreshold) {
+            std::cout << "AUDIO START: Found at position " << i << " (L=" << levelL << " R=" << levelR << ")" << std::endl;
+            return i;
+        }
+        if (++pos == captureSize) {
+            pos = 0;
+        }
+    }
+    
+    // If no audio found, return the end of buffer
+    std::cout << "AUDIO START: No audio found, returning end of buffer" << std::endl;
+    return capturedSamples;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::setRandomSeed(unsigned int seed) {
+    // xorshift32 must never be seeded with zero
+    randomState = seed ? seed : 0x9E3779B9u;
+}
+
+template <typename Config>
+unsigned int BasicDataBenderEngine<Config>::nextRandom() {
+    // xorshift32 - no locks or global state, unlike rand()
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+template <typename Config>
+float BasicDataBenderEngine<Config>::randomUnit() {
+    return static_cast<float>(nextRandom() >> 8) * (1.0f / 16777216.0f);
+}
+
+template <typename Config>
+int BasicDataBenderEngine<Config>::randomBelow(int range) {
+    return range > 0 ? static_cast<int>(nextRandom() % static_cast<unsigned int>(range)) : 0;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::setOnsetSnap(bool enabled) {
+    onsetSnap = Config::ENABLE_ONSET_INDEX && enabled;
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::getOnsetSnap() const {
+    return onsetSnap;
+}
+
+template <typename Config>
+int BasicDataBenderEngine<Config>::getOnsetCount() const {
+    return playOnsetCount;
+}
+
+template <typename Config>
+int BasicDataBenderEngine<Config>::copyTrimMap(CaptureSegment* segments, int capacity) const {
+    int count = std::min(playSegmentCount, capacity);
+    for (int i = 0; i < count; ++i) {
+        segments[i] = playSegments[i];
+    }
+    return playSegmentCount;
+}
+
+template <typename Config>
+int BasicDataBenderEngine<Config>::getTrimmedLength() const {
+    return playSegmentCount > 0 ? playTrimmedLength : 0;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::setGranularMode(bool enabled) {
+    if (enabled && !grains) {
+        grains = new Grains();
+    }
+    resetGrains();
+    granular = enabled;
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::getGranularMode() const {
+    return granular;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::setGrainDensity(float grainsPerSecond) {
+    grainDensity = std::max(grainsPerSecond, 0.0f);
+}
+
+template <typename Config>
+float BasicDataBenderEngine<Config>::getGrainDensity() const {
+    return grainDensity;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::setGrainLength(float seconds) {
+    grainLength = std::max(seconds, 0.0f);
+}
+
+template <typename Config>
+float BasicDataBenderEngine<Config>::getGrainLength() const {
+    return grainLength;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::setGrainSpray(float seconds) {
+    grainSpray = std::max(seconds, 0.0f);
+}
+
+template <typename Config>
+float BasicDataBenderEngine<Config>::getGrainSpray() const {
+    return grainSpray;
+}
+
+template <typename Config>
+int BasicDataBenderEngine<Config>::getActiveGrains() const {
+    return grains ? grains->getActiveCount() : 0;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::setPreservePitch(bool enabled) {
+    if (enabled && !stretch) {
+        stretch = new TimeStretch();
+    }
+    resetStretch();
+    preservePitch = enabled;
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::getPreservePitch() const {
+    return preservePitch;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::setSpectralFreeze(bool enabled) {
+    if (enabled && !spectral) {
+        spectral = new SpectralFreeze();
+        spectral->prepare(spectralSize, Config::CHANNELS == 2);
+    }
+    spectralFreeze = enabled;
+    
+    // Switching on while frozen holds the take's freeze point
+    if (enabled && isFrozen) {
+        analyzeSpectrum();
+    }
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::getSpectralFreeze() const {
+    return spectralFreeze;
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::setSpectralFrameSize(int frames) {
+    if (frames < SpectralFreeze::MIN_SIZE || frames > SpectralFreeze::MAX_SIZE || (frames & (frames - 1)) != 0) {
+        std::cout << "SPECTRAL: Frame size must be a power of two from " << SpectralFreeze::MIN_SIZE
+                  << " to " << SpectralFreeze::MAX_SIZE << std::endl;
+        return false;
+    }
+    
+    spectralSize = frames;
+    if (spectral) {
+        spectral->prepare(spectralSize, Config::CHANNELS == 2);
+        if (spectralFreeze && isFrozen) {
+            analyzeSpectrum();
+        }
+    }
+    return true;
+}
+
+template <typename Config>
+int BasicDataBenderEngine<Config>::getSpectralFrameSize() const {
+    return spectralSize;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::reserveSegments() {
+    // The onset index is sized by the capture too
+    reserveOnsets();
+    
+    // Trim maps live in the arena; the silence map and compact capture's
+    // index of segment starts are sized here
+    if constexpr (!Config::ENABLE_TRIMMING) {
+        return;
+    }
+    if (usesSilenceMap()) {
+        silenceMap.reserve(captureSize, MIN_SILENCE_LENGTH);
+    } else {
+        silenceMap.release();
+    }
+    if (!compactCapture) {
+        return;
+    }
+    
+    // Compact capture stores segments back to back - at least a block each,
+    // plus partial blocks kept at freeze
+    int maxSegments = captureSize / MIN_SILENCE_LENGTH + 2;
+    segmentStarts.assign(maxSegments, 0);
+    resetGate();
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::setParameter(int paramId, float value) {
+    if (paramId >= 0 && paramId < 16) {
+        parameters[paramId] = value;
+    }
+}
+
+template <typename Config>
+float BasicDataBenderEngine<Config>::getParameter(int paramId) const {
+    if (paramId >= 0 && paramId < 16) {
+        return parameters[paramId];
+    }
+    return 0.0f;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::setSampleRate(float sampleRate) {
+    this->sampleRate = sampleRate;
+}
+
+template <typename Config>
+float BasicDataBenderEngine<Config>::getSampleRate() const {
+    return sampleRate;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::convertSampleRate(float sampleRate) {
+    finishResample();
+    settleFreezeJob();
+    float oldRate = this->sampleRate;
+    if (!(sampleRate > 0.0f) || sampleRate == oldRate) {
+        return;
+    }
+    
+    // Readers play their writer's ring, which the writer converts
+    if (captureReader) {
+        this->sampleRate = sampleRate;
+        return;
+    }
+    if (diskStore) {
+        std::cout << "RESAMPLE: Long-capture mode restarts the capture" << std::endl;
+        init(sampleRate);
+        return;
+    }
+    
+    this->sampleRate = sampleRate;
+    int oldLength = bufferInitialized ? BUFFER_SIZE : writePosition;
+    if (oldLength == 0) {
+        return;
+    }
+    
+    // Keep the newest audio that fits, leaving RESAMPLE_HEADROOM free both
+    // in the new ring (for what is recorded meanwhile) and behind the write
+    // head in the old one (so nothing being read gets overwritten)
+    double ratio = static_cast<double>(sampleRate) / oldRate;
+    double room = BUFFER_SIZE - RESAMPLE_HEADROOM;
+    double keep = std::min(static_cast<double>(oldLength), std::min(room, room / ratio));
+    int newLength = std::min(static_cast<int>(keep * ratio), BUFFER_SIZE - RESAMPLE_HEADROOM);
+    if (newLength <= 0) {
+        init(sampleRate);
+        return;
+    }
+    
+    // Snapshots keep whatever they share with the ring
+    if (snapshotPages) {
+        snapshotPages->preserveAll();
+    }
+    
+    ResampleJob* job = new ResampleJob();
+    job->fresh = makeCaptureSource();
+    job->publishedName = publishedName;
+    job->oldL = bufferL;
+    job->oldR = bufferR;
+    job->ratio = ratio;
+    job->skip = oldLength - keep;
+    job->oldStart = bufferInitialized ? writePosition : 0;
+    job->oldLength = oldLength;
+    job->startWrite = writePosition;
+    job->newLength = newLength;
+    if (usesSilenceMap()) {
+        job->silence.reserve(BUFFER_SIZE, MIN_SILENCE_LENGTH);
+    }
+    
+    std::cout << "RESAMPLE: Converting " << (oldLength / oldRate) << "s of capture from " 
+             << oldRate << "Hz to " << sampleRate << "Hz" << std::endl;
+    resampleJob = job;
+    resamplePending = true;
+    if (!WorkerPool::global().submitAndWake(WorkerPool::PRIORITY_BULK, &BasicDataBenderEngine::resampleTask, job, backgroundTasks)) {
+        resampleTask(job);
+    }
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::isConvertingSampleRate() const {
+    return resamplePending;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::resampleTask(void* context) {
+    ResampleJob* job = static_cast<ResampleJob*>(context);
+    auto started = std::chrono::steady_clock::now();
+    Resampler resampler;
+    resampler.prepare(job->ratio);
+    
+    // Oldest first; the ring is only read where no write can reach
+    for (int channel = 0; channel < Config::CHANNELS; ++channel) {
+        const Sample* ring = channel == 0 ? job->oldL : job->oldR;
+        Sample* target = channel == 0 ? job->fresh->getL() : job->fresh->getR();
+        long long first = static_cast<long long>(std::ceil(job->skip));
+        auto gather = [&](long long start, int count, float* destination) {
+            for (int i = 0; i < count; ++i) {
+                long long age = start + i;
+                destination[i] = age >= first && age < job->oldLength
+                                     ? toFloat(ring[(job->oldStart + age) % BUFFER_SIZE]) : 0.0f;
+            }
+        };
+        auto store = [&](int start, int count, const float* block) {
+            for (int i = 0; i < count; ++i) {
+                target[start + i] = CaptureSample<Sample>::fromFloat(block[i]);
+            }
+            return job->state.load(std::memory_order_relaxed) != ResampleJob::CANCELLED;
+        };
+        if (!resampler.render(gather, store, job->skip, job->newLength)) {
+            return;
+        }
+    }
+    
+    // Map the converted audio's silence; frames recorded meanwhile are
+    // scanned after the swap, like any the audio thread records
+    if (job->silence.isReserved()) {
+        scanSilence(job->silence, job->fresh->getL(), job->fresh->getR(), job->newLength);
+    }
+    
+    int running = ResampleJob::RUNNING;
+    if (!job->state.compare_exchange_strong(running, ResampleJob::READY, std::memory_order_release)) {
+        return;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+    std::cout << "RESAMPLE: Converted " << job->newLength << " frames in " << elapsed.count() << "ms" << std::endl;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::releaseRetired(void* context) {
+    ResampleJob* job = static_cast<ResampleJob*>(context);
+    
+    // Readers of the old ring keep it; the bus name moves to the new one
+    if (!job->publishedName.empty()) {
+        CaptureBus<Sample>::global().remove(job->publishedName, job->retired);
+        CaptureBus<Sample>::global().add(job->publishedName, job->fresh);
+    }
+    job->retired->setWriterAttached(false);
+    job->retired.reset();
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::applyResample() {
+    ResampleJob& job = *resampleJob;
+    
+    // Audio recorded since the conversion started is at the new rate
+    // already: copy the newest that fits after the converted audio
+    job.recorded = (writePosition - job.startWrite + BUFFER_SIZE) % BUFFER_SIZE;
+    job.kept = std::min(job.recorded, BUFFER_SIZE - job.newLength);
+    Sample* freshL = job.fresh->getL();
+    Sample* freshR = job.fresh->getR();
+    int from = (writePosition - job.kept + BUFFER_SIZE) % BUFFER_SIZE;
+    int first = std::min(job.kept, BUFFER_SIZE - from);
+    std::memcpy(freshL + job.newLength, bufferL + from, first * sizeof(Sample));
+    std::memcpy(freshL + job.newLength + first, bufferL, (job.kept - first) * sizeof(Sample));
+    if constexpr (Config::CHANNELS == 2) {
+        std::memcpy(freshR + job.newLength, bufferR + from, first * sizeof(Sample));
+        std::memcpy(freshR + job.newLength + first, bufferR, (job.kept - first) * sizeof(Sample));
+    }
+    
+    // Rescale everything that holds ring positions
+    if (isFrozen && playingSlot.load(std::memory_order_relaxed) == LIVE_TAKE) {
+        // Raw positions go through the ring; the new ring starts at frame 0,
+        // so the mapped frames are take positions again
+        float fraction = readPosition - std::floor(readPosition);
+        int position = std::min(static_cast<int>(readPosition), playCapturedSamples - 1);
+        readPosition = mapResampledFrame(rawFrame(position)) + fraction * static_cast<float>(job.ratio);
+        spectralPoint = mapResampledFrame(rawFrame(spectralPoint % playCapturedSamples));
+    }
+    
+    // The tables are rebuilt in a fresh generation, since snapshots may
+    // share the current one
+    int previousGeneration = liveGeneration;
+    const AudioSegment* oldSegments = trimmedSegments.data();
+    int oldSegmentCount = trimmedSegments.size();
+    liveGeneration = arena.begin();
+    trimmedSegments.start(arena);
+    liveOnsets.start(arena);
+    if (segmentsInitialized) {
+        int oldTotal = totalTrimmedLength;
+        remapResampledSegments(oldSegments, oldSegmentCount);
+        trimmedReadPosition = oldTotal > 0 ? trimmedReadPosition * totalTrimmedLength / oldTotal : 0.0f;
+    }
+    if constexpr (Config::ENABLE_ONSET_INDEX) {
+        remapResampledStarts(onsetStarts, onsetStartHead, onsetStartCount);
+    }
+    if (compactCapture) {
+        remapResampledStarts(segmentStarts, segmentStartHead, segmentStartCount);
+    }
+    
+    // Swap the rings; a task frees the old one
+    job.retired.swap(captureSource);
+    captureSource = job.fresh;
+    bufferL = captureSource->getL();
+    bufferR = captureSource->getR();
+    captureL = bufferL;
+    captureR = bufferR;
+    writePosition = (job.newLength + job.kept) % BUFFER_SIZE;
+    bufferInitialized = writePosition == 0;
+    onsetScanPosition = writePosition;
+    if (job.silence.isReserved()) {
+        std::swap(silenceMap, job.silence);
+    }
+    if (snapshotPages) {
+        snapshotPages->rebindRing(bufferL, bufferR);
+    }
+    if (isFrozen) {
+        if constexpr (Config::ENABLE_ONSET_INDEX) {
+            indexOnsets();
+        }
+        if constexpr (Config::ENABLE_TRIMMING) {
+            captureSource->publishTrimMap(trimmedSegments.data(), static_cast<int>(trimmedSegments.size()),
+                                          totalTrimmedLength, writePosition, bufferInitialized);
+        }
+    }
+    rebuildLivePages();
+    arena.release(previousGeneration);
+    inStutter = false;
+    inCrossfade = false;
+    
+    resamplePending = false;
+    job.state.store(ResampleJob::SWAPPED, std::memory_order_release);
+    WorkerPool::global().submit(WorkerPool::PRIORITY_BULK, &BasicDataBenderEngine::releaseRetired, resampleJob, backgroundTasks);
+    DATABENDER_TRACE_INSTANT("resample-swap", traceTrack, job.newLength);
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::finishResample() {
+    if (!resampleJob) {
+        return;
+    }
+    
+    // Audio is stopped, so swap here if the audio thread hasn't
+    int state;
+    while ((state = resampleJob->state.load(std::memory_order_acquire)) == ResampleJob::RUNNING) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (state == ResampleJob::READY) {
+        resampleJob->state.store(ResampleJob::SWAPPING, std::memory_order_relaxed);
+        applyResample();
+    }
+    
+    // The old ring goes here if its task couldn't be queued
+    backgroundTasks.wait();
+    if (resampleJob->retired) {
+        releaseRetired(resampleJob);
+    }
+    delete resampleJob;
+    resampleJob = nullptr;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::cancelResample() {
+    if (!resampleJob) {
+        return;
+    }
+    
+    // The old ring stays; the task stops at its next block
+    int state = resampleJob->state.load(std::memory_order_acquire);
+    while ((state == ResampleJob::RUNNING || state == ResampleJob::READY) &&
+           !resampleJob->state.compare_exchange_weak(state, ResampleJob::CANCELLED, std::memory_order_acq_rel)) {
+    }
+    backgroundTasks.wait();
+    if (resampleJob->retired) {
+        releaseRetired(resampleJob);
+    }
+    delete resampleJob;
+    resampleJob = nullptr;
+    resamplePending = false;
+}
+
+template <typename Config>
+int BasicDataBenderEngine<Config>::mapResampledFrame(int frame, bool* kept) const {
+    const ResampleJob& job = *resampleJob;
+    
+    // Recorded during the conversion: moved as is, after the converted audio
+    int sinceStart = (frame - job.startWrite + BUFFER_SIZE) % BUFFER_SIZE;
+    if (sinceStart < job.recorded) {
+        int offset = sinceStart - (job.recorded - job.kept);
+        if (kept) {
+            *kept = offset >= 0;
+        }
+        return job.newLength + std::max(offset, 0);
+    }
+    
+    // Converted: scaled from the oldest kept frame
+    int age = (frame - job.oldStart + BUFFER_SIZE) % BUFFER_SIZE;
+    double position = (age - job.skip) * job.ratio;
+    if (kept) {
+        *kept = position >= 0.0 && age < job.oldLength;
+    }
+    if (age >= job.oldLength) {
+        return job.newLength;
+    }
+    return std::min(std::max(static_cast<int>(position), 0), job.newLength - 1);
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::remapResampledSegments(const AudioSegment* segments, int count) {
+    // Segments are split where the mapping jumps (at the seams between
+    // converted, recorded and dropped audio), so each piece scales evenly.
+    // The pieces go into the new generation's list.
+    const ResampleJob& job = *resampleJob;
+    int seams[4] = {
+        job.startWrite,
+        (job.startWrite + job.recorded - job.kept) % BUFFER_SIZE,
+        writePosition,
+        (job.oldStart + static_cast<int>(std::ceil(job.skip))) % BUFFER_SIZE
+    };
+    
+    totalTrimmedLength = 0;
+    for (int index = 0; index < count; ++index) {
+        int start = segments[index].start;
+        int end = segments[index].start + segments[index].length;
+        while (start < end) {
+            int pieceEnd = end;
+            for (int seam : seams) {
+                if (seam > start && seam < pieceEnd) {
+                    pieceEnd = seam;
+                }
+            }
+            bool firstKept = false;
+            bool lastKept = false;
+            int mappedStart = mapResampledFrame(start, &firstKept);
+            int mappedLast = mapResampledFrame(pieceEnd - 1, &lastKept);
+            if (firstKept && lastKept && mappedLast >= mappedStart) {
+                AudioSegment piece = { mappedStart, mappedLast - mappedStart + 1 };
+                if (!trimmedSegments.push_back(piece)) {
+                    return;
+                }
+                totalTrimmedLength += piece.length;
+            }
+            start = pieceEnd;
+        }
+    }
+    trimmedSegments.shrinkToFit();
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::remapResampledStarts(std::vector<int>& starts, int head, int& count) {
+    // Oldest first stays oldest first, so the ring is compacted in place
+    int capacity = static_cast<int>(starts.size());
+    int kept = 0;
+    for (int i = 0; i < count; ++i) {
+        bool keep = false;
+        int frame = mapResampledFrame(starts[(head + i) % capacity], &keep);
+        if (keep) {
+            starts[(head + kept++) % capacity] = frame;
+        }
+    }
+    count = kept;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::setPlaybackSpeed(float speed) {
+    speedTarget = speed;
+    if (speedRampLength <= 0 || speed == playbackSpeed) {
+        playbackSpeed = speed;
+        speedRampRemaining = 0;
+        return;
+    }
+    
+    // Glide from wherever the speed is now, even mid-ramp
+    speedRampStart = playbackSpeed;
+    speedRampStep = (speed - playbackSpeed) / static_cast<float>(speedRampLength);
+    speedRampPosition = 0;
+    speedRampRemaining = speedRampLength;
+    sampleFastPath = false;
+}
+
+template <typename Config>
+float BasicDataBenderEngine<Config>::getPlaybackSpeed() const {
+    return speedTarget;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::setSpeedRampLength(int samples) {
+    speedRampLength = samples > 0 ? samples : 0;
+}
+
+template <typename Config>
+int BasicDataBenderEngine<Config>::getSpeedRampLength() const {
+    return speedRampLength;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::setRepeats(float repeats) {
+    this->repeats = repeats;
+}
+
+template <typename Config>
+float BasicDataBenderEngine<Config>::getRepeats() const {
+    return repeats;
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::enableLongCapture(const std::string& path, float seconds) {
+    finishResample();
+    settleFreezeJob();
+    disableLongCapture();
+    detachCapture();
+    unpublishCapture();
+    
+    // The disk store records float samples only
+    if constexpr (!std::is_same<Sample, float>::value) {
+        std::cout << "LONG CAPTURE: Needs float sample storage" << std::endl;
+        return false;
+    }
+    
+    DiskCaptureStore* store = new DiskCaptureStore();
+    if (!store->open(path, static_cast<int>(seconds * sampleRate))) {
+        delete store;
+        return false;
+    }
+    
+    diskStore = store;
+    if constexpr (std::is_same<Sample, float>::value) {
+        captureL = store->getMappedL();
+        captureR = store->getMappedR();
+    }
+    captureSize = store->getCapacity();
+    
+    // Nothing reads the RAM ring while the store records, so it goes until
+    // disableLongCapture(); so do snapshots, which share its pages
+    destroySnapshots();
+    captureSource->setWriterAttached(false);
+    captureSource.reset();
+    bufferL = nullptr;
+    bufferR = nullptr;
+    reserveSegments();
+    rebuildLivePages();
+    
+    // Start a fresh capture in the new store
+    writePosition = 0;
+    readPosition = 0;
+    bufferInitialized = false;
+    resetGate();
+    clearTrimmedSegments();
+    return true;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::disableLongCapture() {
+    if (!diskStore) {
+        return;
+    }
+    closeDiskStore();
+    
+    // Back to a RAM ring of our own
+    captureSource = makeCaptureSource();
+    bufferL = captureSource->getL();
+    bufferR = captureSource->getR();
+    captureL = bufferL;
+    captureR = bufferR;
+    captureSize = BUFFER_SIZE;
+    reserveSegments();
+    writePosition = 0;
+    readPosition = 0;
+    bufferInitialized = false;
+    rebuildLivePages();
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::closeDiskStore() {
+    settleFreezeJob();
+    
+    // Segments point into the mapping, drop them before it goes away
+    clearTrimmedSegments();
+    delete diskStore;
+    diskStore = nullptr;
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::isLongCaptureActive() const {
+    return diskStore != nullptr;
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::setCompactCapture(bool enabled) {
+    finishResample();
+    settleFreezeJob();
+    
+    // Compact capture hands freeze a segment index, so it needs trimming
+    if constexpr (!Config::ENABLE_TRIMMING) {
+        if (enabled) {
+            std::cout << "COMPACT CAPTURE: Needs silence trimming enabled" << std::endl;
+            return false;
+        }
+    }
+    
+    if (enabled && !gatePendingL) {
+        gatePendingL = allocateAligned<Sample>(MIN_SILENCE_LENGTH);
+        gatePendingR = Config::CHANNELS == 2 ? allocateAligned<Sample>(MIN_SILENCE_LENGTH) : gatePendingL;
+    }
+    
+    compactCapture = enabled;
+    reserveSegments();
+    
+    // Audio already in the ring was stored ungated, start over
+    clearBuffer();
+    return true;
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::isCompactCaptureActive() const {
+    return compactCapture;
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::setPinnedCapture(bool enabled) {
+    finishResample();
+    settleFreezeJob();
+    if (captureReader) {
+        std::cout << "PINNED CAPTURE: A shared capture belongs to its writer" << std::endl;
+        return false;
+    }
+    if (enabled == pinnedCapture) {
+        return true;
+    }
+    pinnedCapture = enabled;
+    if (diskStore) {
+        std::cout << "PINNED CAPTURE: Applies to the RAM ring once long capture ends" << std::endl;
+        return true;
+    }
+    
+    // A new ring. Snapshots keep what they share with the old one, readers
+    // keep the old ring and the bus name moves to the new one.
+    if (snapshotPages) {
+        snapshotPages->preserveAll();
+    }
+    std::shared_ptr<CaptureSource<Sample>> retired = captureSource;
+    captureSource = makeCaptureSource();
+    if (!publishedName.empty()) {
+        CaptureBus<Sample>::global().remove(publishedName, retired);
+        CaptureBus<Sample>::global().add(publishedName, captureSource);
+    }
+    retired->setWriterAttached(false);
+    retired.reset();
+    
+    bufferL = captureSource->getL();
+    bufferR = captureSource->getR();
+    captureL = bufferL;
+    captureR = bufferR;
+    if (snapshotPages) {
+        snapshotPages->rebindRing(bufferL, bufferR);
+    }
+    rebuildLivePages();
+    clearBuffer();
+    std::cout << "PINNED CAPTURE: " << captureSource->describeMemory() << std::endl;
+    return true;
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::isPinnedCaptureActive() const {
+    return pinnedCapture;
+}
+
+template <typename Config>
+std::string BasicDataBenderEngine<Config>::getCaptureMemory() const {
+    if (!captureSource) {
+        return "no RAM ring (long capture)";
+    }
+    return captureSource->describeMemory();
+}
+
+template <typename Config>
+std::shared_ptr<CaptureSource<typename Config::Sample>> BasicDataBenderEngine<Config>::makeCaptureSource() const {
+    // Sized for the largest trim map readers can reuse
+    int maxSharedSegments = Config::ENABLE_TRIMMING ? BUFFER_SIZE / MIN_SILENCE_LENGTH + 3 : 0;
+    return std::make_shared<CaptureSource<Sample>>(BUFFER_SIZE, Config::CHANNELS, maxSharedSegments, pinnedCapture);
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::setSnapshotSlots(int numSlots) {
+    finishResample();
+    settleFreezeJob();
+    destroySnapshots();
+    if (numSlots <= 0) {
+        return;
+    }
+    if (captureReader) {
+        std::cout << "SNAPSHOTS: Not available while attached to a shared capture" << std::endl;
+        return;
+    }
+    if (diskStore) {
+        std::cout << "SNAPSHOTS: Not available in long-capture mode" << std::endl;
+        return;
+    }
+    
+    // Snapshots share pages of the RAM ring
+    snapshotPages = new Pages(bufferL, bufferR, BUFFER_SIZE, numSlots);
+    snapshots.resize(numSlots);
+    std::cout << "SNAPSHOTS: " << numSlots << " slots, " << snapshotPages->getNumPages() 
+             << " pages of " << Pages::PAGE_FRAMES << " frames" << std::endl;
+}
+
+template <typename Config>
+int BasicDataBenderEngine<Config>::getSnapshotSlots() const {
+    return snapshotPages ? snapshotPages->getNumSlots() : 0;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::takeSnapshot(int slot) {
+    pendingSnapshot.store(slot, std::memory_order_release);
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::recallSnapshot(int slot) {
+    pendingRecall.store(slot, std::memory_order_release);
+}
+
+template <typename Config>
+int BasicDataBenderEngine<Config>::getPlayingSlot() const {
+    return playingSlot.load(std::memory_order_relaxed);
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::destroySnapshots() {
+    if (playingSlot.load(std::memory_order_relaxed) != LIVE_TAKE) {
+        playingSlot.store(LIVE_TAKE, std::memory_order_relaxed);
+        selectLiveTake();
+        readPosition = 0.0f;
+    }
+    for (const Take& take : snapshots) {
+        arena.release(take.generation);
+    }
+    delete snapshotPages;
+    snapshotPages = nullptr;
+    snapshots.clear();
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::applySnapshot(int slot) {
+    // Only frozen takes are stored, and only from the RAM ring
+    int playing = playingSlot.load(std::memory_order_relaxed);
+    if (!snapshotPages || !isFrozen || slot < 0 || slot >= snapshotPages->getNumSlots() || slot == playing) {
+        return;
+    }
+    if (playing == LIVE_TAKE && diskStore) {
+        return;
+    }
+    
+    // O(pages): share the playing take's pages rather than copying audio,
+    // and its tables by holding their generation
+    Take& take = snapshots[slot];
+    int generation = liveGeneration;
+    if (playing == LIVE_TAKE) {
+        snapshotPages->shareRing(slot, playCapturedSamples, writePosition);
+    } else {
+        snapshotPages->shareSlot(slot, playing);
+        generation = snapshots[playing].generation;
+    }
+    arena.retain(generation);
+    arena.release(take.generation);
+    take.generation = generation;
+    take.oldest = playOldest;
+    take.segments = playSegments;
+    take.segmentCount = playSegmentCount;
+    take.onsets = playOnsets;
+    take.onsetCount = playOnsetCount;
+    take.trimmedLength = playTrimmedLength;
+    take.capturedSamples = playCapturedSamples;
+    take.filled = true;
+    DATABENDER_TRACE_INSTANT("snapshot", traceTrack + 1, slot);
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::applyRecall(int slot) {
+    int playing = playingSlot.load(std::memory_order_relaxed);
+    if (!snapshotPages || !isFrozen || slot == playing) {
+        return;
+    }
+    if (slot != LIVE_TAKE && (slot < 0 || slot >= snapshotPages->getNumSlots() || !snapshots[slot].filled)) {
+        return;
+    }
+    
+    // Render the outgoing take ahead so it can fade out under the new one
+    takeFadeIndex = CROSSFADE_LENGTH;
+    renderFrames<float>(nullptr, nullptr, takeFadeL, takeFadeR, CROSSFADE_LENGTH, nullptr);
+    
+    // The swap itself is a handful of pointers
+    if (slot == LIVE_TAKE) {
+        selectLiveTake();
+    } else {
+        const Take& take = snapshots[slot];
+        playPagesL = snapshotPages->getPagesL(slot);
+        playPagesR = snapshotPages->getPagesR(slot);
+        playSegments = take.segments;
+        playSegmentCount = take.segmentCount;
+        playOnsets = take.onsets;
+        playOnsetCount = take.onsetCount;
+        playTrimmedLength = take.trimmedLength;
+        playCapturedSamples = take.capturedSamples;
+        playOldest = take.oldest;
+        resetGrains();
+        resetStretch();
+    }
+    readPosition = 0.0f;
+    trimmedReadPosition = 0.0f;
+    spectralPoint = 0;
+    if (spectralFreeze) {
+        analyzeSpectrum();
+    }
+    inCrossfade = false;
+    takeFadeIndex = 0;
+    sampleFastPath = false;
+    playingSlot.store(slot, std::memory_order_relaxed);
+    DATABENDER_TRACE_INSTANT("recall", traceTrack + 1, slot);
+}
+
+template <typename Config>
+template <typename IO>
+void BasicDataBenderEngine<Config>::mixTakeFade(IO* outputL, IO* outputR, int numFrames) {
+    for (int i = 0; i < numFrames && takeFadeIndex < CROSSFADE_LENGTH; ++i, ++takeFadeIndex) {
+        // Cosine curves, as for repeat jumps
+        float fadeOut = 0.5f * (1.0f + std::cos(static_cast<float>(takeFadeIndex) / CROSSFADE_LENGTH * 3.14159f));
+        float fadeIn = 1.0f - fadeOut;
+        outputL[i] = static_cast<IO>(takeFadeL[takeFadeIndex] * fadeOut) + outputL[i] * static_cast<IO>(fadeIn);
+        outputR[i] = static_cast<IO>(takeFadeR[takeFadeIndex] * fadeOut) + outputR[i] * static_cast<IO>(fadeIn);
+    }
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::selectLiveTake() {
+    playPagesL = livePagesL.data();
+    playPagesR = livePagesR.data();
+    playSegments = trimmedSegments.data();
+    playSegmentCount = segmentsInitialized ? trimmedSegments.size() : 0;
+    playOnsets = liveOnsets.data();
+    playOnsetCount = liveOnsets.size();
+    resetGrains();
+    resetStretch();
+    playTrimmedLength = totalTrimmedLength;
+    playCapturedSamples = bufferInitialized ? captureSize : writePosition;
+    playOldest = bufferInitialized ? writePosition : 0;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::rebuildLivePages() {
+    // Identity tables over the capture view, so every take reads the same way
+    int numPages = (captureSize + Pages::PAGE_MASK) >> Pages::PAGE_SHIFT;
+    livePagesL.resize(numPages);
+    livePagesR.resize(numPages);
+    for (int page = 0; page < numPages; ++page) {
+        livePagesL[page] = captureL + static_cast<size_t>(page) * Pages::PAGE_FRAMES;
+        livePagesR[page] = captureR + static_cast<size_t>(page) * Pages::PAGE_FRAMES;
+    }
+    if (playingSlot.load(std::memory_order_relaxed) == LIVE_TAKE) {
+        selectLiveTake();
+    }
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::publishCapture(const std::string& name) {
+    finishResample();
+    settleFreezeJob();
+    
+    // Only a RAM ring can be shared
+    if (captureReader || diskStore) {
+        std::cout << "CAPTURE BUS: Only engines recording to RAM can publish" << std::endl;
+        return false;
+    }
+    
+    unpublishCapture();
+    if (!CaptureBus<Sample>::global().add(name, captureSource)) {
+        std::cout << "CAPTURE BUS: \"" << name << "\" is already published" << std::endl;
+        return false;
+    }
+    publishedName = name;
+    captureSource->publishExtent(writePosition, bufferInitialized);
+    std::cout << "CAPTURE BUS: Publishing \"" << name << "\"" << std::endl;
+    return true;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::unpublishCapture() {
+    finishResample();
+    settleFreezeJob();
+    
+    // Readers already attached keep the ring
+    if (!publishedName.empty()) {
+        CaptureBus<Sample>::global().remove(publishedName, captureSource);
+        publishedName.clear();
+    }
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::attachCapture(const std::string& name) {
+    finishResample();
+    settleFreezeJob();
+    std::shared_ptr<CaptureSource<Sample>> source = CaptureBus<Sample>::global().find(name);
+    if (!source || source == captureSource) {
+        std::cout << "CAPTURE BUS: No other engine publishes \"" << name << "\"" << std::endl;
+        return false;
+    }
+    
+    disableLongCapture();
+    destroySnapshots();
+    unpublishCapture();
+    if (!captureReader) {
+        captureSource->setWriterAttached(false);
+    }
+    
+    // Our own ring is freed here unless somebody is reading it
+    captureSource = source;
+    captureReader = true;
+    bufferL = nullptr;
+    bufferR = nullptr;
+    captureL = source->getL();
+    captureR = Config::CHANNELS == 2 ? source->getR() : source->getL();
+    captureSize = source->getFrames();
+    reserveSegments();
+    
+    writePosition = 0;
+    readPosition = 0;
+    bufferInitialized = false;
+    isFrozen = false;
+    resetGate();
+    rebuildLivePages();
+    clearTrimmedSegments();
+    std::cout << "CAPTURE BUS: Attached to \"" << name << "\"" << std::endl;
+    return true;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::detachCapture() {
+    if (!captureReader) {
+        return;
+    }
+    settleFreezeJob();
+    
+    // Back to a ring of our own
+    captureSource = makeCaptureSource();
+    captureReader = false;
+    bufferL = captureSource->getL();
+    bufferR = captureSource->getR();
+    captureL = bufferL;
+    captureR = bufferR;
+    captureSize = BUFFER_SIZE;
+    reserveSegments();
+    
+    writePosition = 0;
+    readPosition = 0;
+    bufferInitialized = false;
+    isFrozen = false;
+    resetGate();
+    rebuildLivePages();
+    clearTrimmedSegments();
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::isCaptureAttached() const {
+    return captureReader;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::setAnalysisBudget(size_t bytes) {
+    // Rounded as the arena rounds, so init() can tell when it changed
+    analysisBudget = (bytes + AnalysisArena::ALIGNMENT - 1) & ~(AnalysisArena::ALIGNMENT - 1);
+}
+
+template <typename Config>
+size_t BasicDataBenderEngine<Config>::getAnalysisBudget() const {
+    return analysisBudget;
+}
+
+template <typename Config>
+const AnalysisArena& BasicDataBenderEngine<Config>::getAnalysisArena() const {
+    return arena;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::setTimingEnabled(bool enabled) {
+    timingEnabled = enabled;
+}
+
+template <typename Config>
+bool BasicDataBenderEngine<Config>::isTimingEnabled() const {
+    return timingEnabled;
+}
+
+template <typename Config>
+EngineStats& BasicDataBenderEngine<Config>::getStats() {
+    return stats;
+}
+
+template <typename Config>
+const EngineStats& BasicDataBenderEngine<Config>::getStats() const {
+    return stats;
+}
+
+template <typename Config>
+void BasicDataBenderEngine<Config>::readFromTrimmedBuffer(float& outputL, float& outputR) {
+    if (playSegmentCount == 0) {
+        outputL = 0.0f;
+        outputR = 0.0f;
+        return;
+    }
+    
+    // As in readFromBuffer, the loop ends where the crossfade into the
+    // oldest segment starts
+    int loopLength = playTrimmedLength > 2 * CROSSFADE_LENGTH ? playTrimmedLength - CROSSFADE_LENGTH : playTrimmedLength;
+    
+    // Apply stuttering/repeats effect
+    if (Config::ENABLE_REPEATS && repeats > 0.0f) {
+        // Calculate skipping probability based on repeats value - more noticeable
+        float skipProb = repeats * 0.0003f; // 0-0.03% probability at max (was 0.0001f)
+        
+        // Check if we should skip the playhead back
+        if (randomUnit() < skipProb) {
+            // Calculate how far back to skip - very small amounts
+            int maxSkipBack = static_cast<int>(repeats * playTrimmedLength * 0.02f); // Up to 2% of trimmed buffer (was 0.08f)
+            int skipBack = randomBelow(maxSkipBack) + (playTrimmedLength / 200); // Minimum 0.5% of buffer (was /100)
+            
+            // Jump playhead back
+            trimmedReadPosition = trimmedReadPosition - skipBack;
+            DATABENDER_TRACE_INSTANT("repeat-jump", traceTrack, skipBack);
+            
+            // Ensure we don't go negative
+            if (trimmedReadPosition < 0.0f) {
+                trimmedReadPosition = loopLength + trimmedReadPosition;
+            }
+            
+            // Land on a note start if one is close
+            if (onsetSnap && playOnsetCount > 0) {
+                trimmedReadPosition = static_cast<float>(snapJump(static_cast<int>(trimmedReadPosition), skipBack));
+            }
+        }
+    }
+    
+    // At the end of trimmed audio, loop back to the oldest segment with the
+    // rest of the take fading out under it
+    if (trimmedReadPosition >= loopLength) {
+        if (loopLength < playTrimmedLength) {
+            startCrossfade(static_cast<int>(trimmedReadPosition));
+        }
+        trimmedReadPosition -= loopLength;
+        if (trimmedReadPosition >= loopLength) {
+            trimmedReadPosition = 0.0f;
+        }
+    }
+    
+    // Find which segment contains our current position
+    int currentPos = static_cast<int>(trimmedReadPosition);
+    int segmentStart = 0;
+    
+    for (int index = 0; index < playSegmentCount; ++index) {
+        const AudioSegment& segment = playSegments[index];
+        if (currentPos >= segmentStart && currentPos < segmentStart + segment.length) {
+            // We're in this segment
+            int segmentOffset = currentPos - segmentStart;
+            outputL = playL(segment.start + segmentOffset);
+            outputR = playR(segment.start + segmentOffset);
+            if constexpr (Config::INTERPOLATION_ORDER == 1) {
+                // The next trimmed frame may be the start of the next segment
+                bool lastFrame = segmentOffset + 1 >= segment.length;
+                const AudioSegment& next = lastFrame ? playSegments[(index + 1) % playSegmentCount] : segment;
+                int nextFrame = next.start + (lastFrame ? 0 : segmentOffset + 1);
+                float fraction = trimmedReadPosition - currentPos;
+                outputL += (playL(nextFrame) - outputL) * fraction;
+                outputR += (playR(nextFrame) - outputR) * fraction;
+            }
+            playheadFrame = segment.start + segmentOffset;
+            if (inCrossfade) {
+                mixCrossfade(outputL, outputR);
+            }
+            
+            // Advance read position
+            trimmedReadPosition += playbackSpeed;
+            return;
+        }
+        segmentStart += segment.length;
+    }
+    
+    // If we get here, something went wrong - output silence
+    outputL = 0.0f;
+    outputR = 0.0f;
+    trimmedReadPosition += playbackSpeed;
+}
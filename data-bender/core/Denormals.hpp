@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define DATABENDER_DENORMALS_SSE 1
+#elif defined(__aarch64__)
+#define DATABENDER_DENORMALS_ARM64 1
+#endif
+
+// Flushes denormals to zero for the lifetime of the object and restores the
+// previous mode afterwards. The engine's recursive filters decay towards
+// zero in silence, and not every host (VCV Rack) enables FTZ for us.
+class ScopedFlushDenormals {
+public:
+    ScopedFlushDenormals() {
+#if defined(DATABENDER_DENORMALS_SSE)
+        // FTZ (bit 15) and DAZ (bit 6)
+        savedMode = _mm_getcsr();
+        _mm_setcsr(savedMode | 0x8040);
+#elif defined(DATABENDER_DENORMALS_ARM64)
+        // FZ (bit 24)
+        uint64_t fpcr;
+        asm volatile("mrs %0, fpcr" : "=r"(fpcr));
+        savedMode = fpcr;
+        asm volatile("msr fpcr, %0" : : "r"(fpcr | (uint64_t(1) << 24)));
+#endif
+    }
+
+    ~ScopedFlushDenormals() {
+#if defined(DATABENDER_DENORMALS_SSE)
+        _mm_setcsr(static_cast<unsigned int>(savedMode));
+#elif defined(DATABENDER_DENORMALS_ARM64)
+        asm volatile("msr fpcr, %0" : : "r"(savedMode));
+#endif
+    }
+
+    ScopedFlushDenormals(const ScopedFlushDenormals&) = delete;
+    ScopedFlushDenormals& operator=(const ScopedFlushDenormals&) = delete;
+
+private:
+    uint64_t savedMode = 0;
+};
@@ -0,0 +1,310 @@
+#include "DiskCaptureStore.hpp"
+#include "AlignedMemory.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DATABENDER_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define DATABENDER_HAS_MMAP 0
+#endif
+
+DiskCaptureStore::DiskCaptureStore() {
+    ramL = allocateAlignedFloats(NUM_RAM_CHUNKS * CHUNK_FRAMES);
+    ramR = allocateAlignedFloats(NUM_RAM_CHUNKS * CHUNK_FRAMES);
+    std::memset(ramL, 0, NUM_RAM_CHUNKS * CHUNK_FRAMES * sizeof(float));
+    std::memset(ramR, 0, NUM_RAM_CHUNKS * CHUNK_FRAMES * sizeof(float));
+
+    // Start the pool here rather than on the audio thread's first spill
+    WorkerPool::global();
+}
+
+DiskCaptureStore::~DiskCaptureStore() {
+    close();
+    freeAlignedFloats(ramL);
+    freeAlignedFloats(ramR);
+}
+
+bool DiskCaptureStore::open(const std::string& path, int capacityFrames) {
+    close();
+
+#if DATABENDER_HAS_MMAP
+    if (capacityFrames <= 0) {
+        return false;
+    }
+
+    // Round up to whole chunks so a chunk never straddles the end of the file
+    int numChunks = (capacityFrames + CHUNK_FRAMES - 1) / CHUNK_FRAMES;
+    capacity = numChunks * CHUNK_FRAMES;
+    mappedBytes = static_cast<size_t>(capacity) * 2 * sizeof(float);
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        std::cout << "LONG CAPTURE: Could not open " << path << std::endl;
+        capacity = 0;
+        return false;
+    }
+
+    // Preallocate so spilling never has to grow the file
+#if defined(__APPLE__)
+    int allocResult = ftruncate(fd, static_cast<off_t>(mappedBytes));
+#else
+    int allocResult = posix_fallocate(fd, 0, static_cast<off_t>(mappedBytes));
+#endif
+    if (allocResult != 0) {
+        std::cout << "LONG CAPTURE: Could not preallocate " << mappedBytes << " bytes in " << path << std::endl;
+        ::close(fd);
+        fd = -1;
+        capacity = 0;
+        return false;
+    }
+
+    mapping = mmap(nullptr, mappedBytes, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        std::cout << "LONG CAPTURE: Could not map " << path << std::endl;
+        mapping = nullptr;
+        ::close(fd);
+        fd = -1;
+        capacity = 0;
+        return false;
+    }
+
+    // Playback is mostly sequential around the playhead
+    madvise(mapping, mappedBytes, MADV_SEQUENTIAL);
+
+    mappedL = static_cast<float*>(mapping);
+    mappedR = mappedL + capacity;
+
+    reset();
+
+    std::cout << "LONG CAPTURE: " << path << " (" << capacity << " frames, "
+              << (mappedBytes >> 20) << " MB on disk)" << std::endl;
+    return true;
+#else
+    (void)path;
+    (void)capacityFrames;
+    std::cout << "LONG CAPTURE: Not supported on this platform" << std::endl;
+    return false;
+#endif
+}
+
+void DiskCaptureStore::close() {
+    // Queued spills are dropped; reset() lets them in again
+    spillTasks.cancel();
+
+#if DATABENDER_HAS_MMAP
+    if (mapping) {
+        munmap(mapping, mappedBytes);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+#endif
+
+    mapping = nullptr;
+    mappedL = nullptr;
+    mappedR = nullptr;
+    mappedBytes = 0;
+    fd = -1;
+    capacity = 0;
+}
+
+bool DiskCaptureStore::isOpen() const {
+    return mapping != nullptr;
+}
+
+void DiskCaptureStore::write(float inputL, float inputR) {
+    int64_t frame = framesWritten.load(std::memory_order_relaxed);
+    int ramPos = static_cast<int>(frame % (NUM_RAM_CHUNKS * CHUNK_FRAMES));
+    ramL[ramPos] = inputL;
+    ramR[ramPos] = inputR;
+
+    ++frame;
+    framesWritten.store(frame, std::memory_order_release);
+
+    // Publish the chunk once its last frame is in
+    if (frame % CHUNK_FRAMES == 0) {
+        completedChunks.store(frame / CHUNK_FRAMES, std::memory_order_release);
+        scheduleSpill();
+    }
+}
+
+void DiskCaptureStore::flush() {
+    if (!isOpen()) {
+        return;
+    }
+
+    int64_t frames = framesWritten.load(std::memory_order_acquire);
+    int64_t fullChunks = frames / CHUNK_FRAMES;
+
+    // Let the spill tasks write out every completed chunk
+    scheduleSpill();
+    while (spilledChunks.load(std::memory_order_acquire) < fullChunks) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // The partial chunk has not been published yet - write it directly
+    int partialFrames = static_cast<int>(frames % CHUNK_FRAMES);
+    if (partialFrames > 0) {
+        spillChunk(fullChunks, partialFrames);
+    }
+}
+
+bool DiskCaptureStore::isSpilled() {
+    if (spilledChunks.load(std::memory_order_acquire) >= completedChunks.load(std::memory_order_acquire)) {
+        return true;
+    }
+    scheduleSpill();
+    return false;
+}
+
+void DiskCaptureStore::reset() {
+    // A spill task caches progress, so none may run while counters rewind
+    spillTasks.cancel();
+
+    framesWritten.store(0);
+    completedChunks.store(0);
+    spilledChunks.store(0);
+    droppedChunks.store(0);
+    playheadFrame.store(-1);
+    playheadBehind.store(0);
+    hintedFrame = -1;
+    lastPrefetchFrame = -1;
+    spillRequests.store(0);
+
+    if (isOpen()) {
+        spillTasks.resume();
+    }
+}
+
+void DiskCaptureStore::setPlayhead(int frame, int behindFrames) {
+    playheadFrame.store(frame, std::memory_order_relaxed);
+    playheadBehind.store(behindFrames, std::memory_order_relaxed);
+
+    if (hintedFrame < 0 || std::abs(frame - hintedFrame) >= CHUNK_FRAMES) {
+        hintedFrame = frame;
+        scheduleSpill();
+    }
+}
+
+int DiskCaptureStore::getDroppedChunks() const {
+    return droppedChunks.load(std::memory_order_relaxed);
+}
+
+size_t DiskCaptureStore::getRamBytes() const {
+    return static_cast<size_t>(NUM_RAM_CHUNKS) * CHUNK_FRAMES * 2 * sizeof(float);
+}
+
+void DiskCaptureStore::scheduleSpill() {
+    if (spillRequests.fetch_add(1, std::memory_order_acq_rel) == 0 &&
+        !WorkerPool::global().submit(WorkerPool::PRIORITY_IO, &DiskCaptureStore::spillTask, this, spillTasks)) {
+        // Queue full or closed - the next request tries again
+        spillRequests.store(0, std::memory_order_release);
+    }
+}
+
+void DiskCaptureStore::spillTask(void* context) {
+    DiskCaptureStore& store = *static_cast<DiskCaptureStore*>(context);
+
+    // Requests that arrive meanwhile keep this task going instead of
+    // queueing another
+    int requests = store.spillRequests.load(std::memory_order_acquire);
+    for (;;) {
+        store.spillCompleted();
+        int remaining = store.spillRequests.fetch_sub(requests, std::memory_order_acq_rel) - requests;
+        if (remaining <= 0) {
+            break;
+        }
+        requests = remaining;
+    }
+}
+
+void DiskCaptureStore::spillCompleted() {
+    int64_t completed = completedChunks.load(std::memory_order_acquire);
+    int64_t spilled = spilledChunks.load(std::memory_order_relaxed);
+
+    // If we fell a whole ring behind, the oldest chunks were overwritten
+    if (completed - spilled > NUM_RAM_CHUNKS) {
+        int64_t skipTo = completed - NUM_RAM_CHUNKS;
+        droppedChunks.fetch_add(static_cast<int>(skipTo - spilled), std::memory_order_relaxed);
+        spilled = skipTo;
+    }
+
+    while (spilled < completed) {
+        spillChunk(spilled, CHUNK_FRAMES);
+        ++spilled;
+        spilledChunks.store(spilled, std::memory_order_release);
+    }
+
+    int frame = playheadFrame.load(std::memory_order_relaxed);
+    if (frame >= 0) {
+        prefetch(frame, playheadBehind.load(std::memory_order_relaxed));
+    }
+}
+
+void DiskCaptureStore::spillChunk(int64_t chunkIndex, int numFrames) {
+#if DATABENDER_HAS_MMAP
+    int ramOffset = static_cast<int>(chunkIndex % NUM_RAM_CHUNKS) * CHUNK_FRAMES;
+    int64_t fileFrame = (chunkIndex * CHUNK_FRAMES) % capacity;
+    size_t bytes = static_cast<size_t>(numFrames) * sizeof(float);
+
+    off_t offsetL = static_cast<off_t>(fileFrame * sizeof(float));
+    off_t offsetR = static_cast<off_t>((capacity + fileFrame) * sizeof(float));
+
+    if (pwrite(fd, ramL + ramOffset, bytes, offsetL) != static_cast<ssize_t>(bytes)
+        || pwrite(fd, ramR + ramOffset, bytes, offsetR) != static_cast<ssize_t>(bytes)) {
+        droppedChunks.fetch_add(1, std::memory_order_relaxed);
+    }
+#else
+    (void)chunkIndex;
+    (void)numFrames;
+#endif
+}
+
+void DiskCaptureStore::prefetch(int frame, int behindFrames) {
+    // Only re-advise once the playhead has moved a chunk or jumped
+    if (lastPrefetchFrame >= 0 && std::abs(frame - lastPrefetchFrame) < CHUNK_FRAMES) {
+        return;
+    }
+    lastPrefetchFrame = frame;
+
+    int64_t start = static_cast<int64_t>(frame) - behindFrames;
+    int64_t length = static_cast<int64_t>(behindFrames) + READ_AHEAD_FRAMES;
+    if (length >= capacity) {
+        adviseRange(0, capacity);
+        return;
+    }
+
+    // Split the window where it wraps around the ends of the file
+    if (start < 0) {
+        adviseRange(static_cast<int>(capacity + start), static_cast<int>(-start));
+        adviseRange(0, static_cast<int>(length + start));
+    } else if (start + length > capacity) {
+        adviseRange(static_cast<int>(start), static_cast<int>(capacity - start));
+        adviseRange(0, static_cast<int>(start + length - capacity));
+    } else {
+        adviseRange(static_cast<int>(start), static_cast<int>(length));
+    }
+}
+
+void DiskCaptureStore::adviseRange(int startFrame, int numFrames) {
+#if DATABENDER_HAS_MMAP
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    for (int channel = 0; channel < 2; ++channel) {
+        const float* base = channel == 0 ? mappedL : mappedR;
+        uintptr_t begin = reinterpret_cast<uintptr_t>(base + startFrame) & ~(pageSize - 1);
+        uintptr_t end = reinterpret_cast<uintptr_t>(base + startFrame + numFrames);
+        madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+    }
+#else
+    (void)startFrame;
+    (void)numFrames;
+#endif
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "WorkerPool.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Disk-backed capture store for long sessions (tens of minutes to hours).
+//
+// The audio thread writes into a small RAM ring of fixed-size chunks.
+// Tasks on the shared WorkerPool spill completed chunks to a preallocated
+// file laid out as two planar channel regions, and the file is memory-mapped
+// so frozen playback can read it like an ordinary buffer. RAM use is bounded
+// by the chunk ring no matter how long the capture is; the page cache holds
+// the rest.
+class DiskCaptureStore {
+public:
+    static constexpr int CHUNK_FRAMES = 4096;      // Spill granularity (about 93ms at 44.1kHz)
+    static constexpr int NUM_RAM_CHUNKS = 16;      // RAM ring slack for the spill tasks (about 1.5s)
+    static constexpr int READ_AHEAD_FRAMES = 65536; // Prefetch window ahead of the playhead
+
+    DiskCaptureStore();
+    ~DiskCaptureStore();
+
+    // Create and preallocate the backing file and map it. Capacity is
+    // rounded up to a whole number of chunks.
+    // Not real-time safe - call while audio is stopped.
+    bool open(const std::string& path, int capacityFrames);
+    void close();
+    bool isOpen() const;
+
+    // Append one frame (audio thread, lock-free - queues a spill task when
+    // a chunk completes)
+    void write(float inputL, float inputR);
+
+    // Make everything written so far visible through the mapped view,
+    // including the current partial chunk. Blocks until the spill tasks
+    // have caught up - call from a non-audio thread (e.g. before freezing).
+    void flush();
+
+    // Whether the spill tasks have written out every completed chunk, so
+    // flush() would not wait (lock-free, queues a spill task if not)
+    bool isSpilled();
+
+    // Forget captured audio (positions only, the file keeps its size)
+    void reset();
+
+    // Planar view of the whole file
+    const float* getMappedL() const { return mappedL; }
+    const float* getMappedR() const { return mappedR; }
+    int getCapacity() const { return capacity; }
+
+    // Read-ahead hint (audio thread, lock-free): physical frame of the
+    // playhead and how far behind it stutter jumps may land. Queues a
+    // prefetch once the playhead has moved a chunk.
+    void setPlayhead(int frame, int behindFrames);
+
+    // Monitoring
+    int getDroppedChunks() const;
+    size_t getRamBytes() const;
+
+private:
+    static void spillTask(void* context);
+    void scheduleSpill();
+    void spillCompleted();
+    void spillChunk(int64_t chunkIndex, int numFrames);
+    void prefetch(int frame, int behindFrames);
+    void adviseRange(int startFrame, int numFrames);
+
+    int fd = -1;
+    int capacity = 0;
+    size_t mappedBytes = 0;
+    void* mapping = nullptr;
+    float* mappedL = nullptr;
+    float* mappedR = nullptr;
+
+    // RAM chunk ring, written by the audio thread only
+    float* ramL = nullptr;
+    float* ramR = nullptr;
+    std::atomic<int64_t> framesWritten{0};
+
+    // Audio thread -> spill task
+    std::atomic<int64_t> completedChunks{0};
+    std::atomic<int> playheadFrame{-1};
+    std::atomic<int> playheadBehind{0};
+    int hintedFrame = -1; // Audio thread only
+
+    // Spill task -> everyone
+    std::atomic<int64_t> spilledChunks{0};
+    std::atomic<int> droppedChunks{0};
+    int lastPrefetchFrame = -1;
+
+    // Requests since the spill task last looked. Only the request that
+    // finds it at zero queues a task, so one runs at a time.
+    std::atomic<int> spillRequests{0};
+    TaskGroup spillTasks;
+};
@@ -0,0 +1,183 @@
+#include "EngineStats.hpp"
+#include <iomanip>
+
+EngineStats::EngineStats() {
+    reset();
+    deadlineFraction.store(0.1f);
+}
+
+static int highestBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+#else
+    int bit = 0;
+    while (value >>= 1) {
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+int EngineStats::bucketFor(uint64_t picosPerSample) {
+    if (picosPerSample < SUB_BUCKETS) {
+        return static_cast<int>(picosPerSample);
+    }
+
+    int exponent = highestBit(picosPerSample);
+    int sub = static_cast<int>(picosPerSample >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    int bucket = (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+    return bucket < NUM_BUCKETS ? bucket : NUM_BUCKETS - 1;
+}
+
+uint64_t EngineStats::bucketUpperBound(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return static_cast<uint64_t>(bucket) + 1;
+    }
+
+    int shift = bucket / SUB_BUCKETS - 1;
+    uint64_t sub = static_cast<uint64_t>(bucket % SUB_BUCKETS);
+    return (SUB_BUCKETS + sub + 1) << shift;
+}
+
+void EngineStats::record(Mode mode, int numFrames, uint64_t elapsedNs, float sampleRate) {
+    if (numFrames <= 0) {
+        return;
+    }
+
+    ModeHistogram& histogram = modes[mode];
+    uint64_t picosPerSample = elapsedNs * 1000 / static_cast<uint64_t>(numFrames);
+
+    histogram.counts[bucketFor(picosPerSample)].fetch_add(1, std::memory_order_relaxed);
+    histogram.blocks.fetch_add(1, std::memory_order_relaxed);
+    histogram.samples.fetch_add(static_cast<uint64_t>(numFrames), std::memory_order_relaxed);
+    histogram.totalNs.fetch_add(elapsedNs, std::memory_order_relaxed);
+
+    // Single writer, so a plain compare is enough to keep the maximum
+    if (picosPerSample > histogram.maxPicosPerSample.load(std::memory_order_relaxed)) {
+        histogram.maxPicosPerSample.store(picosPerSample, std::memory_order_relaxed);
+    }
+
+    // Compare against the real-time duration of this block
+    double periodNs = numFrames * 1.0e9 / sampleRate;
+    if (elapsedNs > periodNs * deadlineFraction.load(std::memory_order_relaxed)) {
+        overruns.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void EngineStats::setDeadlineFraction(float fraction) {
+    deadlineFraction.store(fraction);
+}
+
+float EngineStats::getDeadlineFraction() const {
+    return deadlineFraction.load();
+}
+
+double EngineStats::percentile(const uint64_t* counts, uint64_t total, double fraction) {
+    if (total == 0) {
+        return 0.0;
+    }
+
+    uint64_t target = static_cast<uint64_t>(total * fraction);
+    uint64_t seen = 0;
+    for (int i = 0; i < NUM_BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen > target) {
+            return bucketUpperBound(i) / 1000.0;
+        }
+    }
+    return bucketUpperBound(NUM_BUCKETS - 1) / 1000.0;
+}
+
+EngineStats::Snapshot EngineStats::getSnapshot(Mode mode) const {
+    const ModeHistogram& histogram = modes[mode];
+    uint64_t counts[NUM_BUCKETS];
+    uint64_t total = 0;
+    for (int i = 0; i < NUM_BUCKETS; ++i) {
+        counts[i] = histogram.counts[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    Snapshot snapshot;
+    snapshot.blocks = histogram.blocks.load(std::memory_order_relaxed);
+    snapshot.samples = histogram.samples.load(std::memory_order_relaxed);
+    if (snapshot.samples > 0) {
+        snapshot.meanNsPerSample = static_cast<double>(histogram.totalNs.load(std::memory_order_relaxed)) / snapshot.samples;
+    }
+    snapshot.p99NsPerSample = percentile(counts, total, 0.99);
+    snapshot.maxNsPerSample = histogram.maxPicosPerSample.load(std::memory_order_relaxed) / 1000.0;
+    return snapshot;
+}
+
+EngineStats::Snapshot EngineStats::getTotal() const {
+    uint64_t counts[NUM_BUCKETS] = {};
+    uint64_t total = 0;
+    uint64_t totalNs = 0;
+    uint64_t maxPicos = 0;
+
+    Snapshot snapshot;
+    for (int m = 0; m < NUM_MODES; ++m) {
+        const ModeHistogram& histogram = modes[m];
+        for (int i = 0; i < NUM_BUCKETS; ++i) {
+            uint64_t count = histogram.counts[i].load(std::memory_order_relaxed);
+            counts[i] += count;
+            total += count;
+        }
+        snapshot.blocks += histogram.blocks.load(std::memory_order_relaxed);
+        snapshot.samples += histogram.samples.load(std::memory_order_relaxed);
+        totalNs += histogram.totalNs.load(std::memory_order_relaxed);
+        uint64_t modeMax = histogram.maxPicosPerSample.load(std::memory_order_relaxed);
+        maxPicos = modeMax > maxPicos ? modeMax : maxPicos;
+    }
+
+    if (snapshot.samples > 0) {
+        snapshot.meanNsPerSample = static_cast<double>(totalNs) / snapshot.samples;
+    }
+    snapshot.p99NsPerSample = percentile(counts, total, 0.99);
+    snapshot.maxNsPerSample = maxPicos / 1000.0;
+    return snapshot;
+}
+
+uint64_t EngineStats::getOverruns() const {
+    return overruns.load(std::memory_order_relaxed);
+}
+
+void EngineStats::reset() {
+    for (auto& histogram : modes) {
+        for (auto& count : histogram.counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        histogram.blocks.store(0, std::memory_order_relaxed);
+        histogram.samples.store(0, std::memory_order_relaxed);
+        histogram.totalNs.store(0, std::memory_order_relaxed);
+        histogram.maxPicosPerSample.store(0, std::memory_order_relaxed);
+    }
+    overruns.store(0, std::memory_order_relaxed);
+}
+
+const char* EngineStats::getModeName(Mode mode) {
+    switch (mode) {
+        case MODE_PASSTHROUGH: return "passthrough";
+        case MODE_RAW_FROZEN: return "raw-frozen";
+        case MODE_TRIMMED_FROZEN: return "trimmed-frozen";
+        case MODE_CROSSFADE: return "crossfade";
+        case MODE_GRANULAR: return "granular";
+        case MODE_SPECTRAL: return "spectral";
+        case MODE_STRETCH: return "stretch";
+        default: return "unknown";
+    }
+}
+
+void EngineStats::dump(std::ostream& out) const {
+    out << std::fixed << std::setprecision(2);
+    out << "mode              blocks     samples    mean ns/smp  p99 ns/smp  max ns/smp" << std::endl;
+    for (int m = 0; m < NUM_MODES; ++m) {
+        Snapshot snapshot = getSnapshot(static_cast<Mode>(m));
+        out << std::left << std::setw(16) << getModeName(static_cast<Mode>(m)) << std::right
+            << std::setw(8) << snapshot.blocks
+            << std::setw(12) << snapshot.samples
+            << std::setw(15) << snapshot.meanNsPerSample
+            << std::setw(12) << snapshot.p99NsPerSample
+            << std::setw(12) << snapshot.maxNsPerSample << std::endl;
+    }
+    out << "overruns (> " << (getDeadlineFraction() * 100.0f) << "% of period): " << getOverruns() << std::endl;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+// Per-block timing statistics for DataBenderEngine::process.
+//
+// The audio thread records the cost of each block in nanoseconds per sample
+// into a lock-free log-linear histogram (one per processing mode). Any other
+// thread can read snapshots at any time; counters are relaxed atomics so a
+// snapshot may mix values from adjacent blocks, which is fine for monitoring.
+class EngineStats {
+public:
+    enum Mode {
+        MODE_PASSTHROUGH = 0,
+        MODE_RAW_FROZEN,
+        MODE_TRIMMED_FROZEN,
+        MODE_CROSSFADE,
+        MODE_GRANULAR,
+        MODE_SPECTRAL,
+        MODE_STRETCH,
+        NUM_MODES
+    };
+
+    // Histogram layout: values are picoseconds per sample. Values below
+    // SUB_BUCKETS get one bucket each, above that every power of two is
+    // split into SUB_BUCKETS linear steps (12.5% resolution).
+    static constexpr int SUB_BUCKET_BITS = 3;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int NUM_OCTAVES = 40;
+    static constexpr int NUM_BUCKETS = NUM_OCTAVES * SUB_BUCKETS;
+
+    struct Snapshot {
+        uint64_t blocks = 0;
+        uint64_t samples = 0;
+        double meanNsPerSample = 0.0;
+        double p99NsPerSample = 0.0;
+        double maxNsPerSample = 0.0;
+    };
+
+    EngineStats();
+
+    // Audio thread: record one block
+    void record(Mode mode, int numFrames, uint64_t elapsedNs, float sampleRate);
+
+    // A block counts as an overrun when it takes longer than this fraction
+    // of its own duration in real time (default 0.1 = 10% of the period)
+    void setDeadlineFraction(float fraction);
+    float getDeadlineFraction() const;
+
+    Snapshot getSnapshot(Mode mode) const;
+    Snapshot getTotal() const;
+    uint64_t getOverruns() const;
+    void reset();
+
+    // Human-readable summary for offline tools and logs
+    void dump(std::ostream& out) const;
+
+    static const char* getModeName(Mode mode);
+
+private:
+    static int bucketFor(uint64_t picosPerSample);
+    static uint64_t bucketUpperBound(int bucket);
+    static double percentile(const uint64_t* counts, uint64_t total, double fraction);
+
+    struct ModeHistogram {
+        std::atomic<uint64_t> counts[NUM_BUCKETS];
+        std::atomic<uint64_t> blocks;
+        std::atomic<uint64_t> samples;
+        std::atomic<uint64_t> totalNs;
+        std::atomic<uint64_t> maxPicosPerSample;
+    };
+
+    ModeHistogram modes[NUM_MODES];
+    std::atomic<uint64_t> overruns;
+    std::atomic<float> deadlineFraction;
+};
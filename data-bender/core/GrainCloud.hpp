@@ -0,0 +1,261 @@
+#pragma once
+
+#include "SnapshotStore.hpp"
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DATABENDER_GRAINS_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define DATABENDER_GRAINS_NEON 1
+#endif
+
+// Voice pool for granular playback of a frozen take.
+//
+// Up to MAX_GRAINS grains play at once from fixed arrays, so starting one
+// never allocates. Active grains are kept packed at the front of the pool
+// and mixed four at a time, one grain per SIMD lane: each lane gathers its
+// two source frames and its window value, the interpolation and windowing
+// run on the whole register, and the lanes are summed into the output. The
+// cost is one pass per four active grains.
+//
+// A grain reads the take through its page tables from a fixed base frame,
+// with its progress kept as a small float offset so pitch stays exact deep
+// into a long capture. Where and when grains start is up to the engine.
+template <typename Sample>
+class GrainCloud {
+public:
+    static constexpr int MAX_GRAINS = 64;
+    static constexpr int LANES = 4;
+    static constexpr int MIN_LENGTH = 64;
+    static constexpr int WINDOW_SIZE = 4096; // Hann table entries
+    static constexpr int MIX_FRAMES = 256;   // Scratch block for the engine
+
+    GrainCloud() {
+        for (int i = 0; i < WINDOW_SIZE; ++i) {
+            window[i] = 0.5f - 0.5f * std::cos(6.28318531f * static_cast<float>(i) / WINDOW_SIZE);
+        }
+        window[WINDOW_SIZE] = 0.0f; // Lanes past the end of their grain read silence
+        clear();
+    }
+
+    void clear() {
+        for (int voice = 0; voice < MAX_GRAINS; ++voice) {
+            silence(voice);
+        }
+        activeCount = 0;
+    }
+
+    int getActiveCount() const { return activeCount; }
+    bool isFull() const { return activeCount == MAX_GRAINS; }
+
+    // Samples until the first active grain finishes (MIX_FRAMES if none)
+    int getNextEnd() const {
+        int next = MIX_FRAMES;
+        for (int voice = 0; voice < activeCount; ++voice) {
+            next = remaining[voice] < next ? remaining[voice] : next;
+        }
+        return next;
+    }
+
+    float* getMixL() { return mixL; }
+    float* getMixR() { return mixR; }
+
+    // Start a grain at first, reading step frames per sample for length
+    // samples. The caller keeps frames first .. first + (length - 1) * step + 1
+    // inside the take.
+    void start(int first, float step, int length, float gain) {
+        int voice = activeCount++;
+        base[voice] = first;
+        offset[voice] = 0.0f;
+        this->step[voice] = step;
+        limit[voice] = (length - 1) * step;
+        phase[voice] = 0.0f;
+        phaseStep[voice] = static_cast<float>(WINDOW_SIZE) / length;
+        this->gain[voice] = gain;
+        remaining[voice] = length;
+    }
+
+    // Add numFrames of every active grain to outputL/outputR
+    template <typename Convert>
+    void mix(const Sample* const* pagesL, const Sample* const* pagesR,
+             float* outputL, float* outputR, int numFrames) {
+        for (int group = 0; group < activeCount; group += LANES) {
+            mixGroup<Convert>(group, pagesL, pagesR, outputL, outputR, numFrames);
+        }
+
+        // Retire finished grains, moving the last one into the gap
+        for (int voice = 0; voice < activeCount;) {
+            remaining[voice] -= numFrames;
+            if (remaining[voice] > 0) {
+                ++voice;
+                continue;
+            }
+            int last = --activeCount;
+            base[voice] = base[last];
+            offset[voice] = offset[last];
+            step[voice] = step[last];
+            limit[voice] = limit[last];
+            phase[voice] = phase[last];
+            phaseStep[voice] = phaseStep[last];
+            gain[voice] = gain[last];
+            remaining[voice] = remaining[last];
+            silence(last);
+        }
+    }
+
+private:
+    // Unused lanes read frame 0 (every take has it) through a zero window
+    void silence(int voice) {
+        base[voice] = 0;
+        offset[voice] = 0.0f;
+        step[voice] = 0.0f;
+        limit[voice] = 0.0f;
+        phase[voice] = static_cast<float>(WINDOW_SIZE);
+        phaseStep[voice] = 0.0f;
+        gain[voice] = 0.0f;
+        remaining[voice] = 0;
+    }
+
+    template <typename Convert>
+    static float read(const Sample* const* pages, int frame) {
+        return Convert::toFloat(pages[frame >> SnapshotStore<Sample>::PAGE_SHIFT][frame & SnapshotStore<Sample>::PAGE_MASK]);
+    }
+
+    // Gather one sample of four lanes: both interpolation taps per channel
+    // and the window value
+    template <typename Convert>
+    void gather(const int* frames, const int* taps, const Sample* const* pagesL, const Sample* const* pagesR,
+                float* l0, float* l1, float* r0, float* r1, float* amp) const {
+        for (int lane = 0; lane < LANES; ++lane) {
+            l0[lane] = read<Convert>(pagesL, frames[lane]);
+            l1[lane] = read<Convert>(pagesL, frames[lane] + 1);
+            r0[lane] = read<Convert>(pagesR, frames[lane]);
+            r1[lane] = read<Convert>(pagesR, frames[lane] + 1);
+            amp[lane] = window[taps[lane]];
+        }
+    }
+
+    template <typename Convert>
+    void mixGroup(int group, const Sample* const* pagesL, const Sample* const* pagesR,
+                  float* outputL, float* outputR, int numFrames) {
+        alignas(16) int frames[LANES];
+        alignas(16) int taps[LANES];
+        alignas(16) float l0[LANES], l1[LANES], r0[LANES], r1[LANES], amp[LANES];
+#if defined(DATABENDER_GRAINS_SSE2)
+        const __m128i first = _mm_load_si128(reinterpret_cast<const __m128i*>(base + group));
+        const __m128 steps = _mm_load_ps(step + group);
+        const __m128 limits = _mm_load_ps(limit + group);
+        const __m128 phaseSteps = _mm_load_ps(phaseStep + group);
+        const __m128 gains = _mm_load_ps(gain + group);
+        const __m128 windowEnd = _mm_set1_ps(static_cast<float>(WINDOW_SIZE));
+        __m128 offsets = _mm_load_ps(offset + group);
+        __m128 phases = _mm_load_ps(phase + group);
+
+        for (int i = 0; i < numFrames; ++i) {
+            // Finished lanes hold their last frame and read a zero window
+            __m128 position = _mm_min_ps(offsets, limits);
+            __m128i whole = _mm_cvttps_epi32(position);
+            __m128 fraction = _mm_sub_ps(position, _mm_cvtepi32_ps(whole));
+            _mm_store_si128(reinterpret_cast<__m128i*>(frames), _mm_add_epi32(first, whole));
+            _mm_store_si128(reinterpret_cast<__m128i*>(taps), _mm_cvttps_epi32(_mm_min_ps(phases, windowEnd)));
+            gather<Convert>(frames, taps, pagesL, pagesR, l0, l1, r0, r1, amp);
+
+            __m128 weight = _mm_mul_ps(_mm_load_ps(amp), gains);
+            __m128 left = _mm_load_ps(l0);
+            __m128 right = _mm_load_ps(r0);
+            left = _mm_add_ps(left, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(l1), left), fraction));
+            right = _mm_add_ps(right, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(r1), right), fraction));
+            outputL[i] += sumLanes(_mm_mul_ps(left, weight));
+            outputR[i] += sumLanes(_mm_mul_ps(right, weight));
+
+            offsets = _mm_add_ps(offsets, steps);
+            phases = _mm_add_ps(phases, phaseSteps);
+        }
+
+        _mm_store_ps(offset + group, offsets);
+        _mm_store_ps(phase + group, phases);
+#elif defined(DATABENDER_GRAINS_NEON)
+        const int32x4_t first = vld1q_s32(base + group);
+        const float32x4_t steps = vld1q_f32(step + group);
+        const float32x4_t limits = vld1q_f32(limit + group);
+        const float32x4_t phaseSteps = vld1q_f32(phaseStep + group);
+        const float32x4_t gains = vld1q_f32(gain + group);
+        const float32x4_t windowEnd = vdupq_n_f32(static_cast<float>(WINDOW_SIZE));
+        float32x4_t offsets = vld1q_f32(offset + group);
+        float32x4_t phases = vld1q_f32(phase + group);
+
+        for (int i = 0; i < numFrames; ++i) {
+            float32x4_t position = vminq_f32(offsets, limits);
+            int32x4_t whole = vcvtq_s32_f32(position);
+            float32x4_t fraction = vsubq_f32(position, vcvtq_f32_s32(whole));
+            vst1q_s32(frames, vaddq_s32(first, whole));
+            vst1q_s32(taps, vcvtq_s32_f32(vminq_f32(phases, windowEnd)));
+            gather<Convert>(frames, taps, pagesL, pagesR, l0, l1, r0, r1, amp);
+
+            float32x4_t weight = vmulq_f32(vld1q_f32(amp), gains);
+            float32x4_t left = vld1q_f32(l0);
+            float32x4_t right = vld1q_f32(r0);
+            left = vaddq_f32(left, vmulq_f32(vsubq_f32(vld1q_f32(l1), left), fraction));
+            right = vaddq_f32(right, vmulq_f32(vsubq_f32(vld1q_f32(r1), right), fraction));
+            outputL[i] += vaddvq_f32(vmulq_f32(left, weight));
+            outputR[i] += vaddvq_f32(vmulq_f32(right, weight));
+
+            offsets = vaddq_f32(offsets, steps);
+            phases = vaddq_f32(phases, phaseSteps);
+        }
+
+        vst1q_f32(offset + group, offsets);
+        vst1q_f32(phase + group, phases);
+#else
+        for (int i = 0; i < numFrames; ++i) {
+            float fraction[LANES];
+            for (int lane = 0; lane < LANES; ++lane) {
+                int voice = group + lane;
+                float position = offset[voice] < limit[voice] ? offset[voice] : limit[voice];
+                int whole = static_cast<int>(position);
+                fraction[lane] = position - static_cast<float>(whole);
+                frames[lane] = base[voice] + whole;
+                taps[lane] = static_cast<int>(phase[voice] < WINDOW_SIZE ? phase[voice] : static_cast<float>(WINDOW_SIZE));
+            }
+            gather<Convert>(frames, taps, pagesL, pagesR, l0, l1, r0, r1, amp);
+
+            float left[LANES], right[LANES];
+            for (int lane = 0; lane < LANES; ++lane) {
+                int voice = group + lane;
+                float weight = amp[lane] * gain[voice];
+                left[lane] = (l0[lane] + (l1[lane] - l0[lane]) * fraction[lane]) * weight;
+                right[lane] = (r0[lane] + (r1[lane] - r0[lane]) * fraction[lane]) * weight;
+                offset[voice] += step[voice];
+                phase[voice] += phaseStep[voice];
+            }
+            outputL[i] += (left[0] + left[2]) + (left[1] + left[3]);
+            outputR[i] += (right[0] + right[2]) + (right[1] + right[3]);
+        }
+#endif
+    }
+
+#if defined(DATABENDER_GRAINS_SSE2)
+    // (l0 + l2) + (l1 + l3), the same order as the scalar path
+    static float sumLanes(__m128 value) {
+        __m128 pairs = _mm_add_ps(value, _mm_movehl_ps(value, value));
+        return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 1, 1, 1))));
+    }
+#endif
+
+    // Structure of arrays, one entry per voice, 16-byte aligned for the lanes
+    alignas(16) int base[MAX_GRAINS];
+    alignas(16) float offset[MAX_GRAINS];
+    alignas(16) float step[MAX_GRAINS];
+    alignas(16) float limit[MAX_GRAINS];
+    alignas(16) float phase[MAX_GRAINS];
+    alignas(16) float phaseStep[MAX_GRAINS];
+    alignas(16) float gain[MAX_GRAINS];
+    int remaining[MAX_GRAINS];
+    int activeCount = 0;
+
+    float window[WINDOW_SIZE + 1];
+    alignas(16) float mixL[MIX_FRAMES];
+    alignas(16) float mixR[MIX_FRAMES];
+};
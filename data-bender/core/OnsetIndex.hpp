@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+
+// Energy onset detector and sorted onset lookup, used to land repeat jumps
+// on note starts instead of at random frames.
+//
+// The engine sums the energy of the capture a hop at a time behind the write
+// head and feeds each hop's mean square here. A hop is an onset when it
+// rises RATIO above a decaying peak-hold envelope of the hops before it, so
+// a sustained or decaying note does not retrigger but the next attack does.
+class OnsetDetector {
+public:
+    static constexpr int HOP = 256;           // About 6ms at 44.1kHz
+    static constexpr int HOLDOFF_HOPS = 4;    // Minimum spacing between onsets
+    static constexpr float RATIO = 4.0f;      // 6 dB over the envelope
+    static constexpr float FLOOR = 1.0e-8f;   // Mean square of -80 dBFS
+    static constexpr float DECAY = 0.9f;      // Envelope fall per hop
+
+    void reset() {
+        envelope = 0.0f;
+        holdoff = 0;
+    }
+
+    // Returns true when this hop starts an onset
+    bool addHop(float meanSquare) {
+        bool onset = holdoff == 0 && meanSquare > FLOOR && meanSquare > RATIO * envelope;
+        envelope = std::max(meanSquare, envelope * DECAY);
+        holdoff = onset ? HOLDOFF_HOPS - 1 : std::max(holdoff - 1, 0);
+        return onset;
+    }
+
+    // Nearest onset to target (ties go to the earlier one), or target when
+    // none is within window frames. onsets is sorted ascending.
+    static int snap(const int* onsets, int count, int target, int window) {
+        const int* next = std::lower_bound(onsets, onsets + count, target);
+        int best = target;
+        int bestDistance = window + 1;
+        if (next != onsets && target - next[-1] < bestDistance) {
+            best = next[-1];
+            bestDistance = target - next[-1];
+        }
+        if (next != onsets + count && *next - target < bestDistance) {
+            best = *next;
+        }
+        return best;
+    }
+
+private:
+    float envelope = 0.0f;
+    int holdoff = 0;
+};
@@ -0,0 +1,167 @@
+#include "PinnedMemory.hpp"
+#include "AlignedMemory.hpp"
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DATABENDER_HAS_MMAP 1
+#include <sys/mman.h>
+#else
+#define DATABENDER_HAS_MMAP 0
+#endif
+
+PinnedMemory::~PinnedMemory() {
+    release();
+}
+
+void* PinnedMemory::allocate(size_t bytes, bool lock) {
+    release();
+    if (bytes == 0) {
+        return nullptr;
+    }
+    size_t rounded = (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+
+#if DATABENDER_HAS_MMAP
+#ifdef MAP_HUGETLB
+    void* explicitPages = mmap(nullptr, rounded, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (explicitPages != MAP_FAILED) {
+        mapping = explicitPages;
+        pageKind = EXPLICIT_HUGE_PAGES;
+    }
+#endif
+
+    if (!mapping) {
+        // Over-map by a huge page and trim, so the range starts on a 2MB
+        // boundary the kernel can back with huge pages
+        size_t span = rounded + HUGE_PAGE_SIZE;
+        void* pages = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pages == MAP_FAILED) {
+            return nullptr;
+        }
+        uintptr_t first = reinterpret_cast<uintptr_t>(pages);
+        uintptr_t aligned = (first + HUGE_PAGE_SIZE - 1) & ~static_cast<uintptr_t>(HUGE_PAGE_SIZE - 1);
+        size_t before = aligned - first;
+        size_t after = span - before - rounded;
+        if (before > 0) {
+            munmap(pages, before);
+        }
+        if (after > 0) {
+            munmap(reinterpret_cast<void*>(aligned + rounded), after);
+        }
+        mapping = reinterpret_cast<void*>(aligned);
+        pageKind = STANDARD_PAGES;
+#ifdef MADV_HUGEPAGE
+        if (madvise(mapping, rounded, MADV_HUGEPAGE) == 0) {
+            pageKind = TRANSPARENT_HUGE_PAGES;
+        }
+#endif
+    }
+    mappedBytes = rounded;
+
+    if (lock) {
+        if (mlock(mapping, mappedBytes) == 0) {
+            locked = true;
+        } else {
+            lockError = errno;
+        }
+    }
+#else
+    (void)lock;
+    mapping = allocateAligned<char>(rounded);
+    std::memset(mapping, 0, rounded);
+    mappedBytes = rounded;
+    pageKind = STANDARD_PAGES;
+    heap = true;
+#endif
+    return mapping;
+}
+
+void PinnedMemory::release() {
+    if (!mapping) {
+        return;
+    }
+#if DATABENDER_HAS_MMAP
+    if (locked) {
+        munlock(mapping, mappedBytes);
+    }
+    munmap(mapping, mappedBytes);
+#else
+    freeAligned(static_cast<char*>(mapping));
+#endif
+    mapping = nullptr;
+    mappedBytes = 0;
+    pageKind = STANDARD_PAGES;
+    locked = false;
+    heap = false;
+    lockError = 0;
+}
+
+std::string PinnedMemory::describe() const {
+    if (!mapping) {
+        return "not allocated";
+    }
+    if (heap) {
+        return "standard pages, not locked (no page mapping on this platform)";
+    }
+
+    std::string text;
+    if (pageKind == EXPLICIT_HUGE_PAGES) {
+        text = "explicit huge pages";
+    } else if (pageKind == TRANSPARENT_HUGE_PAGES) {
+        // Advice only - report what the kernel actually did
+        char coverage[64];
+        std::snprintf(coverage, sizeof(coverage), " (%zu of %zu MB)",
+                      hugePageBytes(mapping, mappedBytes) >> 20, mappedBytes >> 20);
+        text = std::string("transparent huge pages") + coverage;
+    } else {
+        text = "standard pages";
+    }
+
+    if (locked) {
+        text += ", locked";
+    } else if (lockError == ENOMEM || lockError == EAGAIN) {
+        text += ", not locked (RLIMIT_MEMLOCK too low)";
+    } else if (lockError == EPERM) {
+        text += ", not locked (not permitted)";
+    } else if (lockError != 0) {
+        text += std::string(", not locked (") + std::strerror(lockError) + ")";
+    } else {
+        text += ", not locked";
+    }
+    return text;
+}
+
+size_t hugePageBytes(const void* data, size_t bytes) {
+#if defined(__linux__)
+    FILE* smaps = std::fopen("/proc/self/smaps", "r");
+    if (!smaps) {
+        return 0;
+    }
+
+    // Sum the huge page fields of every mapping overlapping the range
+    uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+    uintptr_t end = begin + bytes;
+    bool overlaps = false;
+    size_t total = 0;
+    char line[256];
+    while (std::fgets(line, sizeof(line), smaps)) {
+        unsigned long long start = 0, stop = 0, kilobytes = 0;
+        if (std::sscanf(line, "%llx-%llx ", &start, &stop) == 2) {
+            overlaps = start < end && stop > begin;
+        } else if (overlaps && (std::sscanf(line, "AnonHugePages: %llu kB", &kilobytes) == 1 ||
+                                std::sscanf(line, "Private_Hugetlb: %llu kB", &kilobytes) == 1 ||
+                                std::sscanf(line, "Shared_Hugetlb: %llu kB", &kilobytes) == 1)) {
+            total += static_cast<size_t>(kilobytes) * 1024;
+        }
+    }
+    std::fclose(smaps);
+    return total < bytes ? total : bytes;
+#else
+    (void)data;
+    (void)bytes;
+    return 0;
+#endif
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Page-mapped memory for big buffers the audio thread reads at random,
+// the capture ring above all.
+//
+// Mapped directly rather than taken from the heap, so it can sit on 2MB
+// pages (a stutter jump across a 60 second ring then rarely misses the
+// TLB) and be locked (never paged out, so never faulted in on the audio
+// thread). Each step the system refuses - no huge page pool, transparent
+// huge pages off, RLIMIT_MEMLOCK too low - falls back to the next one, and
+// describe() says what was actually granted.
+class PinnedMemory {
+public:
+    enum PageKind {
+        STANDARD_PAGES,
+        TRANSPARENT_HUGE_PAGES, // Advised with madvise; the kernel backs what it can
+        EXPLICIT_HUGE_PAGES     // From the hugetlbfs pool (vm.nr_hugepages)
+    };
+
+    static constexpr size_t HUGE_PAGE_SIZE = 2 << 20;
+
+    PinnedMemory() = default;
+    ~PinnedMemory();
+
+    PinnedMemory(const PinnedMemory&) = delete;
+    PinnedMemory& operator=(const PinnedMemory&) = delete;
+
+    // Map at least bytes (zeroed, rounded up to whole huge pages): explicit
+    // huge pages if the pool has them, else transparent ones, else standard
+    // pages, then lock them if asked, which also faults them all in. Returns
+    // nullptr only if nothing could be mapped. Not real-time safe.
+    void* allocate(size_t bytes, bool lock);
+    void release();
+
+    void* data() const { return mapping; }
+    size_t size() const { return mappedBytes; }
+    PageKind getPageKind() const { return pageKind; }
+    bool isLocked() const { return locked; }
+
+    // For logs, e.g. "transparent huge pages (12 of 12 MB), locked"
+    std::string describe() const;
+
+private:
+    void* mapping = nullptr;
+    size_t mappedBytes = 0;
+    PageKind pageKind = STANDARD_PAGES;
+    bool locked = false;
+    bool heap = false;  // No mmap on this platform
+    int lockError = 0;  // errno from mlock
+};
+
+// Bytes of [data, data + bytes) the kernel currently backs with huge pages
+// (Linux; 0 elsewhere). Reads /proc, not real-time safe.
+size_t hugePageBytes(const void* data, size_t bytes);
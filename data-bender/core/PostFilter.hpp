@@ -0,0 +1,174 @@
+#pragma once
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define DATABENDER_POSTFILTER_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define DATABENDER_POSTFILTER_NEON 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DATABENDER_POSTFILTER_SSE2 1
+#endif
+
+// Output post-processing for frozen playback: DC blocking followed by a
+// one-pole smoother, applied to a whole block at a time.
+//
+// Both stages are recursive in time, so instead of vectorizing across
+// samples the two channels run side by side in SIMD lanes. The filter state
+// is carried between blocks, which keeps the per-sample read path free of
+// serial dependencies. Results match the scalar per-sample formulation
+// exactly (same operations in the same order, no fused multiply-add).
+//
+// State is kept in double so the double-precision path loses nothing; the
+// float path rounds it to float on entry, which is exact for state it wrote.
+class PostFilter {
+public:
+    static constexpr float DC_BLOCK_COEFF = 0.995f;
+    static constexpr float SMOOTHING_FACTOR = 0.98f; // Stronger smoothing (was 0.95f)
+
+    void reset() {
+        dcBlockL = dcBlockR = 0.0;
+        lastOutputL = lastOutputR = 0.0;
+    }
+
+    // Filter a block of planar stereo samples in place
+    void process(float* left, float* right, int numFrames) {
+#if defined(DATABENDER_POSTFILTER_SSE)
+        const __m128 dcGain = _mm_set1_ps(1.0f - DC_BLOCK_COEFF);
+        const __m128 inputGain = _mm_set1_ps(1.0f - SMOOTHING_FACTOR);
+        const __m128 feedback = _mm_set1_ps(SMOOTHING_FACTOR);
+        __m128 dc = _mm_setr_ps(static_cast<float>(dcBlockL), static_cast<float>(dcBlockR), 0.0f, 0.0f);
+        __m128 last = _mm_setr_ps(static_cast<float>(lastOutputL), static_cast<float>(lastOutputR), 0.0f, 0.0f);
+
+        for (int i = 0; i < numFrames; ++i) {
+            __m128 x = _mm_unpacklo_ps(_mm_load_ss(left + i), _mm_load_ss(right + i));
+            __m128 y = _mm_sub_ps(x, dc);
+            dc = _mm_add_ps(dc, _mm_mul_ps(y, dcGain));
+            y = _mm_sub_ps(y, dc);
+            last = _mm_add_ps(_mm_mul_ps(y, inputGain), _mm_mul_ps(last, feedback));
+            _mm_store_ss(left + i, last);
+            _mm_store_ss(right + i, _mm_shuffle_ps(last, last, _MM_SHUFFLE(1, 1, 1, 1)));
+        }
+
+        float state[4];
+        _mm_storeu_ps(state, dc);
+        dcBlockL = state[0];
+        dcBlockR = state[1];
+        _mm_storeu_ps(state, last);
+        lastOutputL = state[0];
+        lastOutputR = state[1];
+#elif defined(DATABENDER_POSTFILTER_NEON)
+        const float32x2_t dcGain = vdup_n_f32(1.0f - DC_BLOCK_COEFF);
+        const float32x2_t inputGain = vdup_n_f32(1.0f - SMOOTHING_FACTOR);
+        const float32x2_t feedback = vdup_n_f32(SMOOTHING_FACTOR);
+        float32x2_t dc = { static_cast<float>(dcBlockL), static_cast<float>(dcBlockR) };
+        float32x2_t last = { static_cast<float>(lastOutputL), static_cast<float>(lastOutputR) };
+
+        for (int i = 0; i < numFrames; ++i) {
+            float32x2_t x = { left[i], right[i] };
+            float32x2_t y = vsub_f32(x, dc);
+            dc = vadd_f32(dc, vmul_f32(y, dcGain));
+            y = vsub_f32(y, dc);
+            last = vadd_f32(vmul_f32(y, inputGain), vmul_f32(last, feedback));
+            left[i] = vget_lane_f32(last, 0);
+            right[i] = vget_lane_f32(last, 1);
+        }
+
+        dcBlockL = vget_lane_f32(dc, 0);
+        dcBlockR = vget_lane_f32(dc, 1);
+        lastOutputL = vget_lane_f32(last, 0);
+        lastOutputR = vget_lane_f32(last, 1);
+#else
+        processScalar<float>(left, right, numFrames);
+#endif
+    }
+
+    // Double-precision variant - two double lanes are exactly one SSE2/NEON register
+    void process(double* left, double* right, int numFrames) {
+#if defined(DATABENDER_POSTFILTER_SSE2)
+        const __m128d dcGain = _mm_set1_pd(1.0 - DC_BLOCK_COEFF);
+        const __m128d inputGain = _mm_set1_pd(1.0 - SMOOTHING_FACTOR);
+        const __m128d feedback = _mm_set1_pd(SMOOTHING_FACTOR);
+        __m128d dc = _mm_setr_pd(dcBlockL, dcBlockR);
+        __m128d last = _mm_setr_pd(lastOutputL, lastOutputR);
+
+        for (int i = 0; i < numFrames; ++i) {
+            __m128d x = _mm_loadh_pd(_mm_load_sd(left + i), right + i);
+            __m128d y = _mm_sub_pd(x, dc);
+            dc = _mm_add_pd(dc, _mm_mul_pd(y, dcGain));
+            y = _mm_sub_pd(y, dc);
+            last = _mm_add_pd(_mm_mul_pd(y, inputGain), _mm_mul_pd(last, feedback));
+            _mm_storel_pd(left + i, last);
+            _mm_storeh_pd(right + i, last);
+        }
+
+        _mm_storel_pd(&dcBlockL, dc);
+        _mm_storeh_pd(&dcBlockR, dc);
+        _mm_storel_pd(&lastOutputL, last);
+        _mm_storeh_pd(&lastOutputR, last);
+#elif defined(DATABENDER_POSTFILTER_NEON) && defined(__aarch64__)
+        const float64x2_t dcGain = vdupq_n_f64(1.0 - DC_BLOCK_COEFF);
+        const float64x2_t inputGain = vdupq_n_f64(1.0 - SMOOTHING_FACTOR);
+        const float64x2_t feedback = vdupq_n_f64(SMOOTHING_FACTOR);
+        float64x2_t dc = { dcBlockL, dcBlockR };
+        float64x2_t last = { lastOutputL, lastOutputR };
+
+        for (int i = 0; i < numFrames; ++i) {
+            float64x2_t x = { left[i], right[i] };
+            float64x2_t y = vsubq_f64(x, dc);
+            dc = vaddq_f64(dc, vmulq_f64(y, dcGain));
+            y = vsubq_f64(y, dc);
+            last = vaddq_f64(vmulq_f64(y, inputGain), vmulq_f64(last, feedback));
+            left[i] = vgetq_lane_f64(last, 0);
+            right[i] = vgetq_lane_f64(last, 1);
+        }
+
+        dcBlockL = vgetq_lane_f64(dc, 0);
+        dcBlockR = vgetq_lane_f64(dc, 1);
+        lastOutputL = vgetq_lane_f64(last, 0);
+        lastOutputR = vgetq_lane_f64(last, 1);
+#else
+        processScalar<double>(left, right, numFrames);
+#endif
+    }
+
+private:
+    template <typename T>
+    void processScalar(T* left, T* right, int numFrames) {
+        const T dcGain = T(1) - T(DC_BLOCK_COEFF);
+        const T inputGain = T(1) - T(SMOOTHING_FACTOR);
+        const T feedback = T(SMOOTHING_FACTOR);
+        T dcL = static_cast<T>(dcBlockL);
+        T dcR = static_cast<T>(dcBlockR);
+        T lastL = static_cast<T>(lastOutputL);
+        T lastR = static_cast<T>(lastOutputR);
+
+        for (int i = 0; i < numFrames; ++i) {
+            T outputL = left[i] - dcL;
+            dcL = dcL + (outputL * dcGain);
+            outputL = outputL - dcL;
+
+            T outputR = right[i] - dcR;
+            dcR = dcR + (outputR * dcGain);
+            outputR = outputR - dcR;
+
+            lastL = (outputL * inputGain) + (lastL * feedback);
+            lastR = (outputR * inputGain) + (lastR * feedback);
+            left[i] = lastL;
+            right[i] = lastR;
+        }
+
+        dcBlockL = dcL;
+        dcBlockR = dcR;
+        lastOutputL = lastL;
+        lastOutputR = lastR;
+    }
+
+    double dcBlockL = 0.0;
+    double dcBlockR = 0.0;
+    double lastOutputL = 0.0;
+    double lastOutputR = 0.0;
+};
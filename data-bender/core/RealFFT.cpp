@@ -0,0 +1,232 @@
+#include "RealFFT.hpp"
+#include "AlignedMemory.hpp"
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define DATABENDER_FFT_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define DATABENDER_FFT_NEON 1
+#endif
+
+RealFFT::~RealFFT() {
+    release();
+}
+
+void RealFFT::release() {
+    if (twiddleRe) {
+        freeAligned(twiddleRe);
+        freeAligned(twiddleIm);
+        freeAligned(postCos);
+        freeAligned(postSin);
+        freeAligned(scratchRe);
+        freeAligned(scratchIm);
+    }
+    delete[] swaps;
+    twiddleRe = twiddleIm = postCos = postSin = scratchRe = scratchIm = nullptr;
+    swaps = nullptr;
+    numSwaps = 0;
+    size = half = 0;
+}
+
+bool RealFFT::prepare(int newSize) {
+    if (newSize < 16 || (newSize & (newSize - 1)) != 0) {
+        return false;
+    }
+    if (newSize == size) {
+        return true;
+    }
+    release();
+
+    size = newSize;
+    half = newSize / 2;
+    twiddleRe = allocateAligned<float>(half);
+    twiddleIm = allocateAligned<float>(half);
+    postCos = allocateAligned<float>(half);
+    postSin = allocateAligned<float>(half);
+    scratchRe = allocateAligned<float>(half);
+    scratchIm = allocateAligned<float>(half);
+
+    // Per-stage twiddles, contiguous so a stage loads them four at a time.
+    // Computed in double so large sizes keep their accuracy.
+    const double pi = 3.14159265358979323846;
+    twiddleRe[0] = 1.0f;
+    twiddleIm[0] = 0.0f;
+    for (int h = 1; h < half; h *= 2) {
+        for (int j = 0; j < h; ++j) {
+            twiddleRe[h + j] = static_cast<float>(std::cos(-pi * j / h));
+            twiddleIm[h + j] = static_cast<float>(std::sin(-pi * j / h));
+        }
+    }
+    for (int k = 0; k < half; ++k) {
+        postCos[k] = static_cast<float>(std::cos(2.0 * pi * k / size));
+        postSin[k] = static_cast<float>(std::sin(2.0 * pi * k / size));
+    }
+
+    int bits = 0;
+    while ((1 << bits) < half) {
+        ++bits;
+    }
+    swaps = new int[half];
+    for (int i = 0; i < half; ++i) {
+        int reversed = 0;
+        for (int bit = 0; bit < bits; ++bit) {
+            reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+        }
+        if (i < reversed) {
+            swaps[numSwaps++] = i;
+            swaps[numSwaps++] = reversed;
+        }
+    }
+    return true;
+}
+
+void RealFFT::transform() {
+    float* re = scratchRe;
+    float* im = scratchIm;
+
+    for (int i = 0; i < numSwaps; i += 2) {
+        int a = swaps[i];
+        int b = swaps[i + 1];
+        float t = re[a];
+        re[a] = re[b];
+        re[b] = t;
+        t = im[a];
+        im[a] = im[b];
+        im[b] = t;
+    }
+
+    // First two stages: trivial twiddles (1 and -i), too narrow for SIMD
+    for (int k = 0; k < half; k += 4) {
+        float r0 = re[k] + re[k + 1], i0 = im[k] + im[k + 1];
+        float r1 = re[k] - re[k + 1], i1 = im[k] - im[k + 1];
+        float r2 = re[k + 2] + re[k + 3], i2 = im[k + 2] + im[k + 3];
+        float r3 = re[k + 2] - re[k + 3], i3 = im[k + 2] - im[k + 3];
+        re[k] = r0 + r2;
+        im[k] = i0 + i2;
+        re[k + 2] = r0 - r2;
+        im[k + 2] = i0 - i2;
+        // (r3 + i i3) * -i = i3 - i r3
+        re[k + 1] = r1 + i3;
+        im[k + 1] = i1 - r3;
+        re[k + 3] = r1 - i3;
+        im[k + 3] = i1 + r3;
+    }
+
+    for (int h = 4; h < half; h *= 2) {
+        const float* wRe = twiddleRe + h;
+        const float* wIm = twiddleIm + h;
+        for (int k = 0; k < half; k += 2 * h) {
+            float* aRe = re + k;
+            float* aIm = im + k;
+            float* bRe = re + k + h;
+            float* bIm = im + k + h;
+            for (int j = 0; j < h; j += 4) {
+#if defined(DATABENDER_FFT_SSE)
+                __m128 wr = _mm_load_ps(wRe + j);
+                __m128 wi = _mm_load_ps(wIm + j);
+                __m128 br = _mm_load_ps(bRe + j);
+                __m128 bi = _mm_load_ps(bIm + j);
+                __m128 tr = _mm_sub_ps(_mm_mul_ps(br, wr), _mm_mul_ps(bi, wi));
+                __m128 ti = _mm_add_ps(_mm_mul_ps(br, wi), _mm_mul_ps(bi, wr));
+                __m128 ar = _mm_load_ps(aRe + j);
+                __m128 ai = _mm_load_ps(aIm + j);
+                _mm_store_ps(aRe + j, _mm_add_ps(ar, tr));
+                _mm_store_ps(aIm + j, _mm_add_ps(ai, ti));
+                _mm_store_ps(bRe + j, _mm_sub_ps(ar, tr));
+                _mm_store_ps(bIm + j, _mm_sub_ps(ai, ti));
+#elif defined(DATABENDER_FFT_NEON)
+                float32x4_t wr = vld1q_f32(wRe + j);
+                float32x4_t wi = vld1q_f32(wIm + j);
+                float32x4_t br = vld1q_f32(bRe + j);
+                float32x4_t bi = vld1q_f32(bIm + j);
+                float32x4_t tr = vsubq_f32(vmulq_f32(br, wr), vmulq_f32(bi, wi));
+                float32x4_t ti = vaddq_f32(vmulq_f32(br, wi), vmulq_f32(bi, wr));
+                float32x4_t ar = vld1q_f32(aRe + j);
+                float32x4_t ai = vld1q_f32(aIm + j);
+                vst1q_f32(aRe + j, vaddq_f32(ar, tr));
+                vst1q_f32(aIm + j, vaddq_f32(ai, ti));
+                vst1q_f32(bRe + j, vsubq_f32(ar, tr));
+                vst1q_f32(bIm + j, vsubq_f32(ai, ti));
+#else
+                for (int lane = j; lane < j + 4; ++lane) {
+                    float tr = bRe[lane] * wRe[lane] - bIm[lane] * wIm[lane];
+                    float ti = bRe[lane] * wIm[lane] + bIm[lane] * wRe[lane];
+                    float ar = aRe[lane];
+                    float ai = aIm[lane];
+                    aRe[lane] = ar + tr;
+                    aIm[lane] = ai + ti;
+                    bRe[lane] = ar - tr;
+                    bIm[lane] = ai - ti;
+                }
+#endif
+            }
+        }
+    }
+}
+
+void RealFFT::forward(const float* input, float* real, float* imag) {
+    // Even samples as the real part, odd as the imaginary part
+    for (int n = 0; n < half; ++n) {
+        scratchRe[n] = input[2 * n];
+        scratchIm[n] = input[2 * n + 1];
+    }
+    transform();
+
+    // Split the half-size spectrum Z into the even and odd sample spectra
+    // and combine them: X[k] = E[k] + e^(-2 pi i k / N) O[k]. Bins k and
+    // half - k share their inputs, so each pass makes both.
+    real[0] = scratchRe[0] + scratchIm[0];
+    imag[0] = 0.0f;
+    real[half] = scratchRe[0] - scratchIm[0];
+    imag[half] = 0.0f;
+    for (int k = 1; k <= half / 2; ++k) {
+        int mirror = half - k;
+        float zr = scratchRe[k];
+        float zi = scratchIm[k];
+        float cr = scratchRe[mirror];
+        float ci = -scratchIm[mirror];
+        float evenRe = 0.5f * (zr + cr);
+        float evenIm = 0.5f * (zi + ci);
+        float oddRe = 0.5f * (zi - ci);
+        float oddIm = -0.5f * (zr - cr);
+        float turnedRe = postCos[k] * oddRe + postSin[k] * oddIm;
+        float turnedIm = postCos[k] * oddIm - postSin[k] * oddRe;
+        real[k] = evenRe + turnedRe;
+        imag[k] = evenIm + turnedIm;
+        real[mirror] = evenRe - turnedRe;
+        imag[mirror] = turnedIm - evenIm;
+    }
+}
+
+void RealFFT::inverse(const float* real, const float* imag, float* output) {
+    // Rebuild Z[k] = E[k] + i O[k] from the bins, conjugated so the forward
+    // transform runs it backwards. Z[half - k] comes from the same two bins.
+    for (int k = 0; k <= half / 2; ++k) {
+        int mirror = half - k;
+        float xr = real[k];
+        float xi = imag[k];
+        float yr = real[mirror];
+        float yi = -imag[mirror];
+        float evenRe = 0.5f * (xr + yr);
+        float evenIm = 0.5f * (xi + yi);
+        float diffRe = 0.5f * (xr - yr);
+        float diffIm = 0.5f * (xi - yi);
+        float oddRe = diffRe * postCos[k] - diffIm * postSin[k];
+        float oddIm = diffRe * postSin[k] + diffIm * postCos[k];
+        if (k > 0) {
+            scratchRe[mirror] = evenRe + oddIm;
+            scratchIm[mirror] = evenIm - oddRe;
+        }
+        scratchRe[k] = evenRe - oddIm;
+        scratchIm[k] = -(evenIm + oddRe);
+    }
+    transform();
+
+    float scale = 1.0f / half;
+    for (int n = 0; n < half; ++n) {
+        output[2 * n] = scratchRe[n] * scale;
+        output[2 * n + 1] = -scratchIm[n] * scale;
+    }
+}
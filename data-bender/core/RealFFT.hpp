@@ -0,0 +1,46 @@
+#pragma once
+
+// Real-input FFT with everything planned up front.
+//
+// prepare() allocates the twiddles, the bit-reversal swaps and the scratch
+// for one transform size, so forward() and inverse() never allocate and are
+// safe on the audio thread. A real transform of N samples runs as a complex
+// transform of N/2 points on split real/imaginary arrays followed by a
+// split-radix style post-pass. Butterflies from the third stage on are four
+// wide (SSE/NEON, scalar fallback).
+//
+// Not thread safe: one transform at a time per instance.
+class RealFFT {
+public:
+    RealFFT() = default;
+    ~RealFFT();
+
+    RealFFT(const RealFFT&) = delete;
+    RealFFT& operator=(const RealFFT&) = delete;
+
+    // size must be a power of two, at least 16. Not real-time safe.
+    bool prepare(int size);
+    int getSize() const { return size; }
+
+    // size real samples to size/2 + 1 bins, unscaled
+    void forward(const float* input, float* real, float* imag);
+
+    // size/2 + 1 bins back to size samples, including the 1/size scale
+    void inverse(const float* real, const float* imag, float* output);
+
+private:
+    void release();
+    void transform(); // In place on scratchRe/scratchIm, forward direction
+
+    int size = 0;
+    int half = 0; // Complex points
+
+    float* twiddleRe = nullptr; // Stage with h butterflies per group uses [h, 2h)
+    float* twiddleIm = nullptr;
+    float* postCos = nullptr;   // cos/sin(2 pi k / size), k < half
+    float* postSin = nullptr;
+    int* swaps = nullptr;       // Bit-reversal pairs
+    int numSwaps = 0;
+    float* scratchRe = nullptr;
+    float* scratchIm = nullptr;
+};
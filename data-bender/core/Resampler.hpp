@@ -0,0 +1,176 @@
+#pragma once
+
+#include "AlignedMemory.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define DATABENDER_RESAMPLER_SSE 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define DATABENDER_RESAMPLER_NEON 1
+#endif
+
+// Polyphase windowed-sinc resampler, used to carry a capture across a
+// sample rate change.
+//
+// The filter bank holds PHASES + 1 rows of Kaiser-windowed sinc
+// coefficients, one per sub-sample offset, each normalized to unity gain.
+// An output frame takes the two rows around its offset, dots both with the
+// input four lanes wide and interpolates the results. The cutoff follows the
+// lower of the two rates, so downsampling doesn't alias; the filter spans
+// TAPS periods of that rate, so it keeps its steepness when it widens.
+//
+// render() works through BLOCK output frames at a time: the input span a
+// block needs is gathered into a scratch buffer and each finished block is
+// handed on, so only a block of either side is ever held here.
+class Resampler {
+public:
+    static constexpr int TAPS = 64;      // Per phase at unity ratio
+    static constexpr int PHASES = 256;
+    static constexpr int BLOCK = 4096;   // Output frames per block
+    static constexpr double CUTOFF = 0.91; // Of the lower Nyquist frequency
+    static constexpr double KAISER_BETA = 9.0;
+
+    Resampler() = default;
+
+    ~Resampler() {
+        release();
+    }
+
+    Resampler(const Resampler&) = delete;
+    Resampler& operator=(const Resampler&) = delete;
+
+    // ratio is the output rate over the input rate. Not real-time safe.
+    bool prepare(double ratio) {
+        if (!(ratio > 0.0)) {
+            return false;
+        }
+        release();
+        step = 1.0 / ratio;
+        taps = (static_cast<int>(std::ceil(TAPS * std::max(1.0, step))) + 7) & ~7;
+        scratchLength = static_cast<int>(std::ceil((BLOCK - 1) * step)) + taps + 2;
+        coefficients = allocateAligned<float>(static_cast<size_t>(PHASES + 1) * taps);
+        input = allocateAligned<float>(scratchLength);
+        output = allocateAligned<float>(BLOCK);
+
+        // Tap k of row p sits k - (taps / 2 - 1) - p / PHASES input frames
+        // from the output position
+        const double pi = 3.14159265358979323846;
+        double cutoff = CUTOFF * std::min(1.0, ratio);
+        double half = taps / 2;
+        std::vector<double> values(taps);
+        for (int p = 0; p <= PHASES; ++p) {
+            float* row = coefficients + p * taps;
+            double sum = 0.0;
+            for (int k = 0; k < taps; ++k) {
+                double x = k - (half - 1.0) - static_cast<double>(p) / PHASES;
+                double sinc = x == 0.0 ? 1.0 : std::sin(pi * cutoff * x) / (pi * cutoff * x);
+                double edge = x / half;
+                double window = edge * edge < 1.0 ? besselI0(KAISER_BETA * std::sqrt(1.0 - edge * edge)) / besselI0(KAISER_BETA) : 0.0;
+                values[k] = sinc * window;
+                sum += values[k];
+            }
+            for (int k = 0; k < taps; ++k) {
+                row[k] = static_cast<float>(values[k] / sum);
+            }
+        }
+        return true;
+    }
+
+    // Output frame n is the input at position offset + n / ratio. gather(
+    // first, count, destination) copies input frames [first, first + count)
+    // as float and fills zeros where there is no input; store(first, count,
+    // block) takes each finished block of output and returns false to stop.
+    // Returns false if stopped.
+    template <typename Gather, typename Store>
+    bool render(Gather& gather, Store& store, double offset, int count) {
+        for (int first = 0; first < count; first += BLOCK) {
+            int frames = std::min(BLOCK, count - first);
+            double start = offset + first * step;
+            long long base = static_cast<long long>(std::floor(start)) - (taps / 2 - 1);
+            double last = offset + (first + frames - 1) * step;
+            int span = static_cast<int>(static_cast<long long>(std::floor(last)) + taps / 2 - base + 1);
+            gather(base, std::min(span, scratchLength), input);
+
+            for (int n = 0; n < frames; ++n) {
+                double position = offset + (first + n) * step;
+                double whole = std::floor(position);
+                double phase = (position - whole) * PHASES;
+                int row = std::min(static_cast<int>(phase), PHASES - 1);
+                float fraction = static_cast<float>(phase - row);
+                const float* samples = input + (static_cast<long long>(whole) - (taps / 2 - 1) - base);
+                float a = dot(coefficients + row * taps, samples);
+                float b = dot(coefficients + (row + 1) * taps, samples);
+                output[n] = a + (b - a) * fraction;
+            }
+            if (!store(first, frames, static_cast<const float*>(output))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    void release() {
+        if (coefficients) {
+            freeAligned(coefficients);
+            freeAligned(input);
+            freeAligned(output);
+        }
+        coefficients = input = output = nullptr;
+    }
+
+    static double besselI0(double x) {
+        // Power series, converges quickly for the betas used here
+        double sum = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 50; ++k) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+            if (term < sum * 1.0e-12) {
+                break;
+            }
+        }
+        return sum;
+    }
+
+    float dot(const float* row, const float* samples) const {
+#if defined(DATABENDER_RESAMPLER_SSE)
+        __m128 sum0 = _mm_setzero_ps();
+        __m128 sum1 = _mm_setzero_ps();
+        for (int i = 0; i < taps; i += 8) {
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_load_ps(row + i), _mm_loadu_ps(samples + i)));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_load_ps(row + i + 4), _mm_loadu_ps(samples + i + 4)));
+        }
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, _mm_add_ps(sum0, sum1));
+        return (lanes[0] + lanes[2]) + (lanes[1] + lanes[3]);
+#elif defined(DATABENDER_RESAMPLER_NEON)
+        float32x4_t sum0 = vdupq_n_f32(0.0f);
+        float32x4_t sum1 = vdupq_n_f32(0.0f);
+        for (int i = 0; i < taps; i += 8) {
+            sum0 = vmlaq_f32(sum0, vld1q_f32(row + i), vld1q_f32(samples + i));
+            sum1 = vmlaq_f32(sum1, vld1q_f32(row + i + 4), vld1q_f32(samples + i + 4));
+        }
+        return vaddvq_f32(vaddq_f32(sum0, sum1));
+#else
+        float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (int i = 0; i < taps; i += 4) {
+            for (int lane = 0; lane < 4; ++lane) {
+                sum[lane] += row[i + lane] * samples[i + lane];
+            }
+        }
+        return (sum[0] + sum[2]) + (sum[1] + sum[3]);
+#endif
+    }
+
+    double step = 1.0; // Input frames per output frame
+    int taps = TAPS;   // Per phase, a multiple of eight
+    int scratchLength = 0;
+    float* coefficients = nullptr; // PHASES + 1 rows of taps
+    float* input = nullptr;        // Input span of one block
+    float* output = nullptr;
+};
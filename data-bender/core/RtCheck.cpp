@@ -0,0 +1,277 @@
+#include "RtCheck.hpp"
+
+#ifdef DATABENDER_RT_CHECK
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__linux__) && defined(__GLIBC__)
+#define DATABENDER_RT_HOOKS 1
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#else
+#define DATABENDER_RT_HOOKS 0
+#endif
+
+namespace {
+
+thread_local int scopeDepth = 0;
+thread_local bool reporting = false;
+std::atomic<unsigned long> violations{0};
+
+// Full stack traces for the first few violations, a count for the rest
+constexpr unsigned long MAX_REPORTED = 20;
+
+#if DATABENDER_RT_HOOKS
+
+// Writes straight to the kernel so reporting never goes through our hooks
+void rawWrite(const char* text) {
+    syscall(SYS_write, 2, text, std::strlen(text));
+}
+
+void reportViolation(const char* what) {
+    if (scopeDepth == 0 || reporting) {
+        return;
+    }
+    reporting = true;
+
+    unsigned long count = violations.fetch_add(1) + 1;
+    if (count <= MAX_REPORTED) {
+        rawWrite("RT CHECK: ");
+        rawWrite(what);
+        rawWrite(" called inside a real-time scope\n");
+
+        void* frames[32];
+        int numFrames = backtrace(frames, 32);
+        // Skip reportViolation and the hook itself
+        backtrace_symbols_fd(frames + 2, numFrames > 2 ? numFrames - 2 : 0, 2);
+        rawWrite("\n");
+    }
+
+    reporting = false;
+}
+
+// Resolve the next definition of a libc function we interpose
+template <typename Fn>
+Fn resolve(Fn& cached, const char* name) {
+    if (!cached) {
+        cached = reinterpret_cast<Fn>(dlsym(RTLD_NEXT, name));
+    }
+    return cached;
+}
+
+#else
+
+void reportViolation(const char*) {}
+
+#endif
+
+}
+
+namespace RtCheck {
+
+Scope::Scope() {
+    ++scopeDepth;
+}
+
+Scope::~Scope() {
+    --scopeDepth;
+}
+
+unsigned long getViolationCount() {
+    return violations.load();
+}
+
+void resetViolationCount() {
+    violations.store(0);
+}
+
+bool hooksInstalled() {
+    return DATABENDER_RT_HOOKS != 0;
+}
+
+}
+
+#if DATABENDER_RT_HOOKS
+
+// glibc's own allocator entry points, so the hooks need no dlsym bootstrap
+extern "C" {
+void* __libc_malloc(size_t size);
+void __libc_free(void* ptr);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+}
+
+namespace {
+
+int (*realMutexLock)(pthread_mutex_t*) = nullptr;
+int (*realCondWait)(pthread_cond_t*, pthread_mutex_t*) = nullptr;
+int (*realCondTimedWait)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*) = nullptr;
+int (*realRwlockRdlock)(pthread_rwlock_t*) = nullptr;
+int (*realRwlockWrlock)(pthread_rwlock_t*) = nullptr;
+int (*realSemWait)(sem_t*) = nullptr;
+ssize_t (*realWrite)(int, const void*, size_t) = nullptr;
+ssize_t (*realRead)(int, void*, size_t) = nullptr;
+int (*realNanosleep)(const struct timespec*, struct timespec*) = nullptr;
+int (*realClockNanosleep)(clockid_t, int, const struct timespec*, struct timespec*) = nullptr;
+int (*realUsleep)(useconds_t) = nullptr;
+int (*realRand)() = nullptr;
+size_t (*realFwrite)(const void*, size_t, size_t, FILE*) = nullptr;
+int (*realFflush)(FILE*) = nullptr;
+
+// Resolve everything before other threads exist, and warm up backtrace()
+// (its first call loads libgcc, which allocates)
+__attribute__((constructor(101))) void installHooks() {
+    resolve(realMutexLock, "pthread_mutex_lock");
+    resolve(realCondWait, "pthread_cond_wait");
+    resolve(realCondTimedWait, "pthread_cond_timedwait");
+    resolve(realRwlockRdlock, "pthread_rwlock_rdlock");
+    resolve(realRwlockWrlock, "pthread_rwlock_wrlock");
+    resolve(realSemWait, "sem_wait");
+    resolve(realWrite, "write");
+    resolve(realRead, "read");
+    resolve(realNanosleep, "nanosleep");
+    resolve(realClockNanosleep, "clock_nanosleep");
+    resolve(realUsleep, "usleep");
+    resolve(realRand, "rand");
+    resolve(realFwrite, "fwrite");
+    resolve(realFflush, "fflush");
+
+    void* frames[4];
+    backtrace(frames, 4);
+}
+
+}
+
+extern "C" {
+
+// Allocation
+void* malloc(size_t size) {
+    reportViolation("malloc");
+    return __libc_malloc(size);
+}
+
+void free(void* ptr) {
+    if (ptr) {
+        reportViolation("free");
+    }
+    __libc_free(ptr);
+}
+
+void* calloc(size_t count, size_t size) {
+    reportViolation("calloc");
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    reportViolation("realloc");
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    reportViolation("memalign");
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    reportViolation("aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** result, size_t alignment, size_t size) {
+    reportViolation("posix_memalign");
+    void* ptr = __libc_memalign(alignment, size);
+    if (!ptr) {
+        return 12; // ENOMEM
+    }
+    *result = ptr;
+    return 0;
+}
+
+// Locks
+int pthread_mutex_lock(pthread_mutex_t* mutex) {
+    reportViolation("pthread_mutex_lock");
+    return resolve(realMutexLock, "pthread_mutex_lock")(mutex);
+}
+
+int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex) {
+    reportViolation("pthread_cond_wait");
+    return resolve(realCondWait, "pthread_cond_wait")(cond, mutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* abstime) {
+    reportViolation("pthread_cond_timedwait");
+    return resolve(realCondTimedWait, "pthread_cond_timedwait")(cond, mutex, abstime);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* lock) {
+    reportViolation("pthread_rwlock_rdlock");
+    return resolve(realRwlockRdlock, "pthread_rwlock_rdlock")(lock);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t* lock) {
+    reportViolation("pthread_rwlock_wrlock");
+    return resolve(realRwlockWrlock, "pthread_rwlock_wrlock")(lock);
+}
+
+int sem_wait(sem_t* sem) {
+    reportViolation("sem_wait");
+    return resolve(realSemWait, "sem_wait")(sem);
+}
+
+// Blocking syscalls and libc calls that take internal locks
+ssize_t write(int fd, const void* data, size_t size) {
+    reportViolation("write");
+    return resolve(realWrite, "write")(fd, data, size);
+}
+
+ssize_t read(int fd, void* data, size_t size) {
+    reportViolation("read");
+    return resolve(realRead, "read")(fd, data, size);
+}
+
+int nanosleep(const struct timespec* request, struct timespec* remaining) {
+    reportViolation("nanosleep");
+    return resolve(realNanosleep, "nanosleep")(request, remaining);
+}
+
+int clock_nanosleep(clockid_t clock, int flags, const struct timespec* request, struct timespec* remaining) {
+    reportViolation("clock_nanosleep");
+    return resolve(realClockNanosleep, "clock_nanosleep")(clock, flags, request, remaining);
+}
+
+int usleep(useconds_t usec) {
+    reportViolation("usleep");
+    return resolve(realUsleep, "usleep")(usec);
+}
+
+int rand() {
+    reportViolation("rand");
+    return resolve(realRand, "rand")();
+}
+
+// stdio writes reach the kernel through libc-internal calls, so catch
+// them at the stdio entry points (std::cout ends up here)
+size_t fwrite(const void* data, size_t size, size_t count, FILE* file) {
+    reportViolation("fwrite");
+    return resolve(realFwrite, "fwrite")(data, size, count, file);
+}
+
+int fflush(FILE* file) {
+    reportViolation("fflush");
+    return resolve(realFflush, "fflush")(file);
+}
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+// Real-time safety checker for the audio path.
+//
+// In a DATABENDER_RT_CHECK build, RtCheck.cpp interposes malloc/free and
+// friends, pthread locking and blocking libc calls (write, read, stdio,
+// sleeps, rand). Any of them made while a DATABENDER_RT_SCOPE() is active
+// on the calling thread is reported to stderr with a stack trace and
+// counted. Without DATABENDER_RT_CHECK the scope macro expands to nothing.
+//
+// Linux/glibc only; on other platforms the scope is tracked but no hooks
+// are installed.
+
+#ifdef DATABENDER_RT_CHECK
+
+namespace RtCheck {
+
+// Marks the calling thread as being inside real-time code (nestable)
+class Scope {
+public:
+    Scope();
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+};
+
+// Total violations seen since start (or the last reset)
+unsigned long getViolationCount();
+void resetViolationCount();
+
+// True when the interposed hooks are active on this platform
+bool hooksInstalled();
+
+}
+
+#define DATABENDER_RT_SCOPE() RtCheck::Scope databenderRtScope
+
+#else
+
+#define DATABENDER_RT_SCOPE() ((void)0)
+
+#endif
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+// Where a capture ring holds audio, kept up to date while recording so the
+// silence trimming at freeze reads a couple of table entries per block
+// instead of every frame of the capture.
+//
+// The ring is split into fixed chunks, each with the first and last frame
+// above the silence threshold (NONE when it has none). The engine feeds the
+// frames it records, behind the write head like the onset scan. The chunk
+// the head is in holds this lap's frames before the head and the previous
+// lap's after it, so the previous lap's last audible frame is kept apart.
+class SilenceMap {
+public:
+    static constexpr int NONE = -1;
+
+    enum Answer { SILENT, AUDIBLE, UNKNOWN };
+
+    // Not real-time safe
+    void reserve(int ringFrames, int chunkFrames) {
+        this->ringFrames = ringFrames;
+        this->chunkFrames = chunkFrames;
+        chunks.assign((ringFrames + chunkFrames - 1) / chunkFrames, Range());
+        reset(0);
+    }
+
+    // Frees the table, for captures that keep no map
+    void release() {
+        std::vector<Range>().swap(chunks);
+        ringFrames = 0;
+        position = 0;
+        headLast = NONE;
+    }
+
+    bool isReserved() const { return !chunks.empty(); }
+
+    // Nothing audible anywhere; the next frame fed is ring frame position
+    void reset(int position) {
+        std::fill(chunks.begin(), chunks.end(), Range());
+        this->position = position;
+        headLast = NONE;
+    }
+
+    // Ring frame the next fed frame goes to, and how many can be fed before
+    // the chunk (or the ring) ends
+    int getPosition() const { return position; }
+    int getRoom() const { return std::min(chunkFrames - position % chunkFrames, ringFrames - position); }
+
+    // The next count frames (at most getRoom()), with the offsets of their
+    // first and last audible frame, NONE if all are silent
+    void feed(int count, int first, int last) {
+        Range& range = chunks[position / chunkFrames];
+        if (position % chunkFrames == 0) {
+            // Entering the chunk: what it held a lap ago is behind the head
+            headLast = range.last;
+            range = Range();
+        }
+        if (first != NONE) {
+            if (range.first == NONE) {
+                range.first = position + first;
+            }
+            range.last = position + last;
+        }
+        position += count;
+        if (position == ringFrames) {
+            position = 0;
+        }
+    }
+
+    // Whether ring frames [start, end) hold audio. UNKNOWN when audio lies
+    // on both sides of the range within a chunk; those frames must be read.
+    Answer query(int start, int end) const {
+        bool unknown = false;
+        for (int chunk = start / chunkFrames; chunk * chunkFrames < end; ++chunk) {
+            int chunkStart = chunk * chunkFrames;
+            int chunkEnd = std::min(chunkStart + chunkFrames, ringFrames);
+            int from = std::max(start, chunkStart);
+            int to = std::min(end, chunkEnd);
+            Answer answer;
+            if (chunk == position / chunkFrames && position > chunkStart) {
+                // Split at the head: this lap's frames, then the last lap's,
+                // of which only the last audible one is known
+                Answer before = from < position ? check(chunks[chunk], from, std::min(to, position)) : SILENT;
+                Answer after = SILENT;
+                if (to > position) {
+                    int lapFrom = std::max(from, position);
+                    after = headLast < lapFrom ? SILENT : headLast < to ? AUDIBLE : UNKNOWN;
+                }
+                answer = before == AUDIBLE || after == AUDIBLE ? AUDIBLE : before == UNKNOWN || after == UNKNOWN ? UNKNOWN : SILENT;
+            } else {
+                answer = check(chunks[chunk], from, to);
+            }
+            if (answer == AUDIBLE) {
+                return AUDIBLE;
+            }
+            unknown = unknown || answer == UNKNOWN;
+        }
+        return unknown ? UNKNOWN : SILENT;
+    }
+
+private:
+    struct Range {
+        int first = NONE;
+        int last = NONE;
+    };
+
+    static Answer check(const Range& range, int from, int to) {
+        if (range.first == NONE || range.first >= to || range.last < from) {
+            return SILENT;
+        }
+        if (range.first >= from || range.last < to) {
+            return AUDIBLE;
+        }
+        return UNKNOWN;
+    }
+
+    std::vector<Range> chunks;
+    int ringFrames = 0;
+    int chunkFrames = 1;
+    int position = 0;
+    int headLast = NONE; // Last audible frame of the head chunk a lap ago
+};
@@ -0,0 +1,210 @@
+#pragma once
+
+#include "AlignedMemory.hpp"
+#include <cstring>
+#include <vector>
+
+// Copy-on-write snapshot slots over the capture ring.
+//
+// The ring is split into fixed-size pages. A slot is a table of page
+// pointers: taking a snapshot copies pointers and bumps reference counts,
+// nothing else. When the writer is about to overwrite a ring page that a
+// slot still references, the old contents are copied once into a page from
+// a preallocated pool and every slot pointing at that ring page is moved to
+// the copy. Pool pages are reference counted too, so slots that share a
+// take share its copies, and a copy returns to the pool when the last slot
+// lets go of it.
+//
+// The pool is sized for the worst case (every slot holding a full ring of
+// copies) but allocated without touching it, so only pages that have
+// actually been copied take physical memory.
+//
+// Not thread safe: all calls come from the thread that writes the ring.
+template <typename Sample>
+class SnapshotStore {
+public:
+    static constexpr int PAGE_SHIFT = 12;
+    static constexpr int PAGE_FRAMES = 1 << PAGE_SHIFT;
+    static constexpr int PAGE_MASK = PAGE_FRAMES - 1;
+
+    // ringR may alias ringL (mono)
+    SnapshotStore(Sample* ringL, Sample* ringR, int ringFrames, int numSlots)
+        : ringL(ringL), ringR(ringR), ringFrames(ringFrames), numSlots(numSlots) {
+        numPages = (ringFrames + PAGE_MASK) >> PAGE_SHIFT;
+        ringRefs.assign(numPages, 0);
+        slotPagesL.assign(static_cast<size_t>(numSlots) * numPages, nullptr);
+        slotPagesR.assign(static_cast<size_t>(numSlots) * numPages, nullptr);
+
+        int poolPages = numSlots * numPages;
+        poolL = allocateAligned<Sample>(static_cast<size_t>(poolPages) * PAGE_FRAMES);
+        poolR = ringR != ringL ? allocateAligned<Sample>(static_cast<size_t>(poolPages) * PAGE_FRAMES) : poolL;
+        poolRefs.assign(poolPages, 0);
+
+        // Lowest pages on top, so copies reuse the same memory
+        freePages.resize(poolPages);
+        for (int i = 0; i < poolPages; ++i) {
+            freePages[i] = poolPages - 1 - i;
+        }
+        freeCount = poolPages;
+    }
+
+    ~SnapshotStore() {
+        if (poolR != poolL) {
+            freeAligned(poolR);
+        }
+        freeAligned(poolL);
+    }
+
+    SnapshotStore(const SnapshotStore&) = delete;
+    SnapshotStore& operator=(const SnapshotStore&) = delete;
+
+    int getNumSlots() const { return numSlots; }
+    int getNumPages() const { return numPages; }
+    int getPagesInUse() const { return static_cast<int>(poolRefs.size()) - freeCount; }
+
+    // Page tables of a slot - nullptr where the take had no audio
+    const Sample* const* getPagesL(int slot) const { return slotPagesL.data() + static_cast<size_t>(slot) * numPages; }
+    const Sample* const* getPagesR(int slot) const { return slotPagesR.data() + static_cast<size_t>(slot) * numPages; }
+
+    // Reference the ring pages holding capturedFrames of audio.
+    // writePosition is the next frame the ring will write; its page is
+    // copied straight away since the writer is already inside it.
+    void shareRing(int slot, int capturedFrames, int writePosition) {
+        release(slot);
+        const Sample** pagesL = slotL(slot);
+        const Sample** pagesR = slotR(slot);
+        int usedPages = (capturedFrames + PAGE_MASK) >> PAGE_SHIFT;
+        for (int page = 0; page < usedPages; ++page) {
+            pagesL[page] = ringL + page * PAGE_FRAMES;
+            pagesR[page] = ringR + page * PAGE_FRAMES;
+            ++ringRefs[page];
+        }
+        if ((writePosition & PAGE_MASK) != 0) {
+            preservePage(writePosition >> PAGE_SHIFT);
+        }
+    }
+
+    // Reference the same pages as another slot
+    void shareSlot(int slot, int source) {
+        if (slot == source) {
+            return;
+        }
+        release(slot);
+        const Sample** pagesL = slotL(slot);
+        const Sample** pagesR = slotR(slot);
+        const Sample* const* sourceL = getPagesL(source);
+        const Sample* const* sourceR = getPagesR(source);
+        for (int page = 0; page < numPages; ++page) {
+            pagesL[page] = sourceL[page];
+            pagesR[page] = sourceR[page];
+            if (pagesL[page]) {
+                addRef(pagesL[page]);
+            }
+        }
+    }
+
+    // Drop everything a slot references
+    void release(int slot) {
+        const Sample** pagesL = slotL(slot);
+        const Sample** pagesR = slotR(slot);
+        for (int page = 0; page < numPages; ++page) {
+            if (!pagesL[page]) {
+                continue;
+            }
+            if (isRingPage(pagesL[page])) {
+                --ringRefs[(pagesL[page] - ringL) >> PAGE_SHIFT];
+            } else {
+                int poolPage = static_cast<int>((pagesL[page] - poolL) >> PAGE_SHIFT);
+                if (--poolRefs[poolPage] == 0) {
+                    freePages[freeCount++] = poolPage;
+                }
+            }
+            pagesL[page] = nullptr;
+            pagesR[page] = nullptr;
+        }
+    }
+
+    // Call before the ring overwrites [start, start + count), wrapping at the
+    // end of the ring. Cheap when no slot references those pages.
+    void prepareWrite(int start, int count) {
+        int first = start >> PAGE_SHIFT;
+        int last = (start + count - 1) >> PAGE_SHIFT;
+        for (int page = first; page <= last; ++page) {
+            preservePage(page < numPages ? page : page - numPages);
+        }
+    }
+
+    // Copy a ring page out to the pool if any slot still references it
+    void preservePage(int page) {
+        if (ringRefs[page] == 0 || freeCount == 0) {
+            return;
+        }
+
+        int poolPage = freePages[--freeCount];
+        Sample* copyL = poolL + static_cast<size_t>(poolPage) * PAGE_FRAMES;
+        Sample* copyR = poolR + static_cast<size_t>(poolPage) * PAGE_FRAMES;
+        int frames = page == numPages - 1 ? ringFrames - page * PAGE_FRAMES : PAGE_FRAMES;
+        std::memcpy(copyL, ringL + page * PAGE_FRAMES, frames * sizeof(Sample));
+        if (ringR != ringL) {
+            std::memcpy(copyR, ringR + page * PAGE_FRAMES, frames * sizeof(Sample));
+        }
+
+        // Every slot that saw this ring page now sees the copy
+        const Sample* ringPage = ringL + page * PAGE_FRAMES;
+        for (int slot = 0; slot < numSlots; ++slot) {
+            const Sample** pagesL = slotL(slot);
+            if (pagesL[page] == ringPage) {
+                pagesL[page] = copyL;
+                slotR(slot)[page] = copyR;
+            }
+        }
+        poolRefs[poolPage] = ringRefs[page];
+        ringRefs[page] = 0;
+    }
+
+    // Copy out every shared page, before the whole ring is cleared
+    void preserveAll() {
+        for (int page = 0; page < numPages; ++page) {
+            preservePage(page);
+        }
+    }
+
+    // Move to another ring of the same size, once preserveAll() has left no
+    // slot referencing this one
+    void rebindRing(Sample* newL, Sample* newR) {
+        ringL = newL;
+        ringR = newR;
+    }
+
+private:
+    const Sample** slotL(int slot) { return slotPagesL.data() + static_cast<size_t>(slot) * numPages; }
+    const Sample** slotR(int slot) { return slotPagesR.data() + static_cast<size_t>(slot) * numPages; }
+
+    bool isRingPage(const Sample* page) const {
+        return page >= ringL && page < ringL + ringFrames;
+    }
+
+    void addRef(const Sample* page) {
+        if (isRingPage(page)) {
+            ++ringRefs[(page - ringL) >> PAGE_SHIFT];
+        } else {
+            ++poolRefs[(page - poolL) >> PAGE_SHIFT];
+        }
+    }
+
+    Sample* ringL;
+    Sample* ringR;
+    int ringFrames;
+    int numSlots;
+    int numPages = 0;
+
+    std::vector<int> ringRefs;            // Slots referencing each ring page
+    std::vector<const Sample*> slotPagesL; // numSlots x numPages
+    std::vector<const Sample*> slotPagesR;
+
+    Sample* poolL = nullptr;
+    Sample* poolR = nullptr;
+    std::vector<int> poolRefs;
+    std::vector<int> freePages;
+    int freeCount = 0;
+};
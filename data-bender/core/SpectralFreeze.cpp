@@ -0,0 +1,181 @@
+#include "SpectralFreeze.hpp"
+#include "AlignedMemory.hpp"
+#include <cmath>
+#include <cstring>
+
+SpectralFreeze::SpectralFreeze() {
+    for (int i = 0; i < PHASES; ++i) {
+        phaseCos[i] = std::cos(6.28318531f * static_cast<float>(i) / PHASES);
+        phaseSin[i] = std::sin(6.28318531f * static_cast<float>(i) / PHASES);
+    }
+}
+
+SpectralFreeze::~SpectralFreeze() {
+    release();
+}
+
+void SpectralFreeze::release() {
+    if (!window) {
+        return;
+    }
+    if (historyR != historyL) {
+        freeAligned(historyR);
+    }
+    if (magnitudesR) {
+        freeAligned(magnitudesR);
+    }
+    freeAligned(window);
+    freeAligned(historyL);
+    freeAligned(magnitudesL);
+    freeAligned(binRe);
+    freeAligned(binIm);
+    freeAligned(frame);
+    freeAligned(accumulatorL);
+    freeAligned(accumulatorR);
+    freeAligned(readyL);
+    freeAligned(readyR);
+    freeAligned(phaseIndex);
+    window = historyL = historyR = magnitudesL = magnitudesR = nullptr;
+    binRe = binIm = frame = accumulatorL = accumulatorR = readyL = readyR = nullptr;
+    phaseIndex = nullptr;
+    size = bins = hop = 0;
+}
+
+bool SpectralFreeze::prepare(int frameSize, bool stereo) {
+    if (frameSize < MIN_SIZE || frameSize > MAX_SIZE || (frameSize & (frameSize - 1)) != 0) {
+        return false;
+    }
+    if (frameSize == size && stereo == this->stereo) {
+        return true;
+    }
+    release();
+    fft.prepare(frameSize);
+
+    size = frameSize;
+    bins = frameSize / 2 + 1;
+    hop = frameSize / OVERLAP;
+    this->stereo = stereo;
+
+    window = allocateAligned<float>(size);
+    historyL = allocateAligned<float>(getHistoryLength());
+    historyR = stereo ? allocateAligned<float>(getHistoryLength()) : historyL;
+    magnitudesL = allocateAligned<float>(FRAMES * bins);
+    magnitudesR = stereo ? allocateAligned<float>(FRAMES * bins) : nullptr;
+    binRe = allocateAligned<float>(bins);
+    binIm = allocateAligned<float>(bins);
+    frame = allocateAligned<float>(size);
+    accumulatorL = allocateAligned<float>(size);
+    accumulatorR = allocateAligned<float>(size);
+    readyL = allocateAligned<float>(hop);
+    readyR = allocateAligned<float>(hop);
+    phaseIndex = allocateAligned<unsigned short>(bins);
+
+    std::memset(historyL, 0, getHistoryLength() * sizeof(float));
+    std::memset(historyR, 0, getHistoryLength() * sizeof(float));
+    std::memset(magnitudesL, 0, FRAMES * bins * sizeof(float));
+    if (magnitudesR) {
+        std::memset(magnitudesR, 0, FRAMES * bins * sizeof(float));
+    }
+
+    // Periodic Hann for analysis and synthesis. With random phases the
+    // overlapping frames add in power, so the magnitudes carry the whole
+    // correction: 1 / (mean(w^2) * sqrt(OVERLAP)) keeps the level.
+    float sumSquares = 0.0f;
+    for (int i = 0; i < size; ++i) {
+        window[i] = 0.5f - 0.5f * std::cos(6.28318531f * static_cast<float>(i) / size);
+        sumSquares += window[i] * window[i];
+    }
+    magnitudeScale = 1.0f / (sumSquares / size * std::sqrt(static_cast<float>(OVERLAP)));
+
+    analyze(1);
+    return true;
+}
+
+void SpectralFreeze::analyze(unsigned int seed) {
+    for (int index = 0; index < FRAMES; ++index) {
+        analyzeChannel(historyL + index * hop, magnitudesL + index * bins);
+        if (stereo) {
+            analyzeChannel(historyR + index * hop, magnitudesR + index * bins);
+        }
+    }
+
+    // Start from the frame nearest the freeze point. The overlap-add fills
+    // over the first frame, which fades the texture in.
+    std::memset(accumulatorL, 0, size * sizeof(float));
+    std::memset(accumulatorR, 0, size * sizeof(float));
+    position = static_cast<float>(FRAMES - 1);
+    direction = -1.0f;
+    readyIndex = hop;
+    randomState = seed ? seed : 1;
+}
+
+void SpectralFreeze::analyzeChannel(const float* history, float* magnitudes) {
+    for (int i = 0; i < size; ++i) {
+        frame[i] = history[i] * window[i];
+    }
+    fft.forward(frame, binRe, binIm);
+    for (int k = 0; k < bins; ++k) {
+        magnitudes[k] = std::sqrt(binRe[k] * binRe[k] + binIm[k] * binIm[k]) * magnitudeScale;
+    }
+}
+
+void SpectralFreeze::synthesize(float speed) {
+    int first = std::min(static_cast<int>(position), FRAMES - 2);
+    float fraction = position - static_cast<float>(first);
+
+    // One set of phases for both channels keeps the stereo image
+    for (int k = 0; k < bins; ++k) {
+        phaseIndex[k] = static_cast<unsigned short>(nextRandom() & (PHASES - 1));
+    }
+    synthesizeChannel(magnitudesL + first * bins, fraction, accumulatorL);
+    if (stereo) {
+        synthesizeChannel(magnitudesR + first * bins, fraction, accumulatorR);
+    }
+
+    // The oldest hop is complete: play it out and shift the rest down
+    std::memcpy(readyL, accumulatorL, hop * sizeof(float));
+    std::memmove(accumulatorL, accumulatorL + hop, (size - hop) * sizeof(float));
+    std::memset(accumulatorL + size - hop, 0, hop * sizeof(float));
+    if (stereo) {
+        std::memcpy(readyR, accumulatorR, hop * sizeof(float));
+        std::memmove(accumulatorR, accumulatorR + hop, (size - hop) * sizeof(float));
+        std::memset(accumulatorR + size - hop, 0, hop * sizeof(float));
+    }
+    readyIndex = 0;
+
+    // Drift through the frames a hop per hop at speed 1, turning at the ends
+    float step = std::min(std::abs(speed), static_cast<float>(FRAMES - 1));
+    position += direction * step;
+    if (position > FRAMES - 1) {
+        position = 2.0f * (FRAMES - 1) - position;
+        direction = -1.0f;
+    }
+    if (position < 0.0f) {
+        position = -position;
+        direction = 1.0f;
+    }
+}
+
+void SpectralFreeze::synthesizeChannel(const float* magnitudes, float fraction, float* accumulator) {
+    const float* next = magnitudes + bins;
+    for (int k = 0; k < bins; ++k) {
+        float magnitude = magnitudes[k] + (next[k] - magnitudes[k]) * fraction;
+        binRe[k] = magnitude * phaseCos[phaseIndex[k]];
+        binIm[k] = magnitude * phaseSin[phaseIndex[k]];
+    }
+    binIm[0] = 0.0f;
+    binIm[bins - 1] = 0.0f;
+
+    fft.inverse(binRe, binIm, frame);
+    for (int i = 0; i < size; ++i) {
+        accumulator[i] += frame[i] * window[i];
+    }
+}
+
+unsigned int SpectralFreeze::nextRandom() {
+    // xorshift32, as in the engine
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "RealFFT.hpp"
+#include <algorithm>
+
+// Spectral freeze: holds a frozen moment as magnitude spectra and plays it
+// back as an endless texture.
+//
+// The engine fills the history with the audio leading up to the freeze
+// point and calls analyze(), which keeps the magnitudes of FRAMES Hann
+// windowed frames one hop apart. Playback resynthesizes a frame every hop
+// with random phases and overlap-adds it, drifting through the kept frames
+// (back and forth) at the playback speed, so the sound keeps moving without
+// repeating. Magnitudes are scaled so the output power matches the input.
+//
+// prepare() allocates everything; analyze() and render() never allocate.
+class SpectralFreeze {
+public:
+    static constexpr int FRAMES = 8;     // Magnitude frames kept
+    static constexpr int OVERLAP = 4;    // Hops per frame
+    static constexpr int MIN_SIZE = 256;
+    static constexpr int MAX_SIZE = 8192;
+    static constexpr int PHASES = 4096;  // Random phase table entries
+
+    SpectralFreeze();
+    ~SpectralFreeze();
+
+    SpectralFreeze(const SpectralFreeze&) = delete;
+    SpectralFreeze& operator=(const SpectralFreeze&) = delete;
+
+    // frameSize is a power of two in [MIN_SIZE, MAX_SIZE]. Not real-time safe.
+    bool prepare(int frameSize, bool stereo);
+    int getFrameSize() const { return size; }
+
+    // Audio before the freeze point, oldest first
+    int getHistoryLength() const { return size + (FRAMES - 1) * hop; }
+    float* getHistoryL() { return historyL; }
+    float* getHistoryR() { return historyR; }
+
+    // Analyze the history and restart playback, seeding the phases
+    void analyze(unsigned int seed);
+
+    template <typename IO>
+    void render(IO* left, IO* right, int numFrames, float speed) {
+        for (int i = 0; i < numFrames;) {
+            if (readyIndex == hop) {
+                synthesize(speed);
+            }
+            int count = std::min(numFrames - i, hop - readyIndex);
+            const float* sourceR = stereo ? readyR : readyL;
+            for (int j = 0; j < count; ++j) {
+                left[i + j] = static_cast<IO>(readyL[readyIndex + j]);
+                right[i + j] = static_cast<IO>(sourceR[readyIndex + j]);
+            }
+            readyIndex += count;
+            i += count;
+        }
+    }
+
+private:
+    void release();
+    void analyzeChannel(const float* history, float* magnitudes);
+    void synthesize(float speed);
+    void synthesizeChannel(const float* magnitudes, float fraction, float* accumulator);
+    unsigned int nextRandom();
+
+    RealFFT fft;
+    int size = 0;
+    int bins = 0; // size / 2 + 1
+    int hop = 0;
+    bool stereo = true;
+    float magnitudeScale = 1.0f;
+
+    float* window = nullptr;
+    float* historyL = nullptr;
+    float* historyR = nullptr;        // Aliases historyL in mono
+    float* magnitudesL = nullptr;     // FRAMES rows of bins
+    float* magnitudesR = nullptr;
+    float* binRe = nullptr;
+    float* binIm = nullptr;
+    float* frame = nullptr;
+    float* accumulatorL = nullptr;    // Overlap-add, size frames
+    float* accumulatorR = nullptr;
+    float* readyL = nullptr;          // Finished hop being played out
+    float* readyR = nullptr;
+    unsigned short* phaseIndex = nullptr; // This hop's phase per bin, shared by both channels
+
+    float position = 0.0f; // Frame being played, 0 .. FRAMES - 1
+    float direction = 1.0f;
+    int readyIndex = 0;
+    unsigned int randomState = 1;
+
+    float phaseCos[PHASES];
+    float phaseSin[PHASES];
+};
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define DATABENDER_STRETCH_SSE 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define DATABENDER_STRETCH_NEON 1
+#endif
+
+// WSOLA time stretch: changes tempo without changing pitch.
+//
+// Every HOP output samples a FRAME long Hann-windowed piece of the take is
+// overlap-added. The engine moves the analysis position at the playback
+// speed and asks for the frame there; the frame actually used starts within
+// TOLERANCE of it, where the take best matches the natural continuation of
+// the previous frame, so the overlap stays in phase. The match is a
+// normalized cross-correlation over CORRELATION frames of the channel sum,
+// scanned every COARSE_STEP lags and then refined around the best one, with
+// the dot products four lanes wide.
+//
+// Every hop costs the same whatever the position does, so a repeat jump is
+// just another target and a block's cost is bounded by its hop count. All
+// buffers are fixed arrays; nothing allocates after construction.
+class TimeStretch {
+public:
+    static constexpr int FRAME = 1024;       // About 23ms at 44.1kHz
+    static constexpr int HOP = FRAME / 2;
+    static constexpr int TOLERANCE = 256;    // Search range either side of the target
+    static constexpr int CORRELATION = 256;  // Frames compared per lag
+    static constexpr int COARSE_STEP = 4;
+    static constexpr int SEARCH = 2 * TOLERANCE + CORRELATION;
+
+    TimeStretch() {
+        for (int i = 0; i < FRAME; ++i) {
+            window[i] = 0.5f - 0.5f * std::cos(6.28318531f * static_cast<float>(i) / FRAME);
+        }
+        reset();
+    }
+
+    // Start again from the next target, without searching
+    void reset() {
+        std::memset(accumulatorL, 0, sizeof(accumulatorL));
+        std::memset(accumulatorR, 0, sizeof(accumulatorR));
+        readyIndex = HOP;
+        primed = false;
+    }
+
+    bool needsHop() const { return readyIndex == HOP; }
+
+    // Add the frame for target and finish a hop. gather(position, count,
+    // left, right) copies count frames of the take from position, wrapping
+    // at the take's ends. Returns where the frame started. After a reset the
+    // frame a hop before the target is laid down first, so output starts at
+    // full level.
+    template <typename Gather>
+    int synthesize(Gather& gather, int target) {
+        if (!primed) {
+            previousStart = target - HOP;
+            addFrame(gather, previousStart);
+            shiftHop();
+            primed = true;
+        }
+
+        int start = target - TOLERANCE + search(gather, target);
+        addFrame(gather, start);
+        shiftHop();
+        previousStart = start;
+        readyIndex = 0;
+        return start;
+    }
+
+    // Copy up to numFrames of the finished hop, returns the count
+    template <typename IO>
+    int read(IO* left, IO* right, int numFrames) {
+        int count = std::min(numFrames, HOP - readyIndex);
+        for (int i = 0; i < count; ++i) {
+            left[i] = static_cast<IO>(readyL[readyIndex + i]);
+            right[i] = static_cast<IO>(readyR[readyIndex + i]);
+        }
+        readyIndex += count;
+        return count;
+    }
+
+private:
+    template <typename Gather>
+    void addFrame(Gather& gather, int start) {
+        gather(start, FRAME, frameL, frameR);
+        for (int i = 0; i < FRAME; ++i) {
+            accumulatorL[i] += frameL[i] * window[i];
+            accumulatorR[i] += frameR[i] * window[i];
+        }
+    }
+
+    // The first hop of the accumulator is complete (the Hann windows sum to
+    // one at half overlap)
+    void shiftHop() {
+        std::memcpy(readyL, accumulatorL, HOP * sizeof(float));
+        std::memcpy(readyR, accumulatorR, HOP * sizeof(float));
+        std::memmove(accumulatorL, accumulatorL + HOP, (FRAME - HOP) * sizeof(float));
+        std::memmove(accumulatorR, accumulatorR + HOP, (FRAME - HOP) * sizeof(float));
+        std::memset(accumulatorL + FRAME - HOP, 0, HOP * sizeof(float));
+        std::memset(accumulatorR + FRAME - HOP, 0, HOP * sizeof(float));
+    }
+
+    // Lag into [target - TOLERANCE, target + TOLERANCE] that best continues
+    // the previous frame
+    template <typename Gather>
+    int search(Gather& gather, int target) {
+        gather(previousStart + HOP, CORRELATION, frameL, frameR);
+        for (int i = 0; i < CORRELATION; ++i) {
+            reference[i] = frameL[i] + frameR[i];
+        }
+        gather(target - TOLERANCE, SEARCH, candidateL, candidateR);
+        energy[0] = 0.0f;
+        for (int i = 0; i < SEARCH; ++i) {
+            candidates[i] = candidateL[i] + candidateR[i];
+            energy[i + 1] = energy[i] + candidates[i] * candidates[i];
+        }
+
+        int best = TOLERANCE;
+        float bestScore = score(best);
+        for (int lag = 0; lag <= 2 * TOLERANCE; lag += COARSE_STEP) {
+            float value = score(lag);
+            if (value > bestScore) {
+                bestScore = value;
+                best = lag;
+            }
+        }
+        int coarse = best;
+        int first = std::max(coarse - COARSE_STEP + 1, 0);
+        int last = std::min(coarse + COARSE_STEP - 1, 2 * TOLERANCE);
+        for (int lag = first; lag <= last; ++lag) {
+            float value = score(lag);
+            if (value > bestScore) {
+                bestScore = value;
+                best = lag;
+            }
+        }
+        return best;
+    }
+
+    // Correlation over the candidate's energy, squared to skip the root
+    float score(int lag) const {
+        float product = dot(reference, candidates + lag);
+        float power = energy[lag + CORRELATION] - energy[lag] + 1.0e-9f;
+        return product * std::abs(product) / power;
+    }
+
+    static float dot(const float* a, const float* b) {
+#if defined(DATABENDER_STRETCH_SSE)
+        __m128 sum0 = _mm_setzero_ps();
+        __m128 sum1 = _mm_setzero_ps();
+        for (int i = 0; i < CORRELATION; i += 8) {
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_load_ps(a + i), _mm_loadu_ps(b + i)));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_load_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        }
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, _mm_add_ps(sum0, sum1));
+        return (lanes[0] + lanes[2]) + (lanes[1] + lanes[3]);
+#elif defined(DATABENDER_STRETCH_NEON)
+        float32x4_t sum0 = vdupq_n_f32(0.0f);
+        float32x4_t sum1 = vdupq_n_f32(0.0f);
+        for (int i = 0; i < CORRELATION; i += 8) {
+            sum0 = vmlaq_f32(sum0, vld1q_f32(a + i), vld1q_f32(b + i));
+            sum1 = vmlaq_f32(sum1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        }
+        return vaddvq_f32(vaddq_f32(sum0, sum1));
+#else
+        float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (int i = 0; i < CORRELATION; i += 4) {
+            for (int lane = 0; lane < 4; ++lane) {
+                sum[lane] += a[i + lane] * b[i + lane];
+            }
+        }
+        return (sum[0] + sum[2]) + (sum[1] + sum[3]);
+#endif
+    }
+
+    int previousStart = 0;
+    int readyIndex = HOP;
+    bool primed = false;
+
+    float window[FRAME];
+    alignas(16) float frameL[FRAME];
+    alignas(16) float frameR[FRAME];
+    alignas(16) float accumulatorL[FRAME];
+    alignas(16) float accumulatorR[FRAME];
+    alignas(16) float readyL[HOP];
+    alignas(16) float readyR[HOP];
+    alignas(16) float reference[CORRELATION];
+    alignas(16) float candidates[SEARCH];
+    float candidateL[SEARCH];
+    float candidateR[SEARCH];
+    float energy[SEARCH + 1]; // Running sum of squares of candidates
+};
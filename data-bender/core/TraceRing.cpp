@@ -0,0 +1,150 @@
+#include "TraceRing.hpp"
+
+#ifdef DATABENDER_TRACE
+
+#include <chrono>
+#include <iostream>
+
+static uint64_t nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+TraceRing& TraceRing::global() {
+    static TraceRing ring;
+    return ring;
+}
+
+TraceRing::TraceRing() {
+    slots = new Slot[CAPACITY];
+}
+
+TraceRing::~TraceRing() {
+    stopFlusher();
+    delete[] slots;
+}
+
+uint32_t TraceRing::newTrack() {
+    // Engines call this from their constructor; create the ring here so the
+    // first traced process() call doesn't allocate it on the audio thread
+    global();
+    
+    static std::atomic<uint32_t> nextTrack{1};
+    return nextTrack.fetch_add(2, std::memory_order_relaxed);
+}
+
+void TraceRing::push(char phase, const char* name, uint32_t track, int64_t arg) {
+    uint64_t index = head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[index & (CAPACITY - 1)];
+
+    // Claim the slot before touching its fields, so a reader that sees any
+    // of the new values also sees the old sequence gone. A writer a whole
+    // ring behind that is still filling it keeps it; this event is dropped.
+    uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    if ((sequence & WRITING) != 0 ||
+        !slot.sequence.compare_exchange_strong(sequence, index | WRITING, std::memory_order_relaxed)) {
+        droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.timestampNs.store(nowNs(), std::memory_order_relaxed);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.track.store(track, std::memory_order_relaxed);
+    slot.arg.store(arg, std::memory_order_relaxed);
+    slot.phase.store(phase, std::memory_order_relaxed);
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+bool TraceRing::startFlusher(const std::string& path) {
+    stopFlusher();
+
+    output = std::fopen(path.c_str(), "w");
+    if (!output) {
+        std::cout << "TRACE: Could not open " << path << std::endl;
+        return false;
+    }
+
+    // Only events pushed from now on end up in the file
+    tail = head.load();
+    firstEvent = true;
+    std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", output);
+
+    running = true;
+    flusherThread = std::thread(&TraceRing::flusherMain, this);
+    return true;
+}
+
+void TraceRing::stopFlusher() {
+    if (running) {
+        running = false;
+        flusherThread.join();
+    }
+
+    if (output) {
+        drain(true);
+        std::fputs("\n]}\n", output);
+        std::fclose(output);
+        output = nullptr;
+    }
+}
+
+uint64_t TraceRing::getDroppedEvents() const {
+    return droppedEvents.load(std::memory_order_relaxed);
+}
+
+void TraceRing::flusherMain() {
+    while (running) {
+        drain(false);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+// Once writers have stopped (finishing), slots that never got their event
+// were dropped by push() and are skipped instead of waited for
+void TraceRing::drain(bool finishing) {
+    uint64_t end = head.load(std::memory_order_acquire);
+
+    // Writers lapped us - the oldest events are gone
+    if (end - tail > static_cast<uint64_t>(CAPACITY)) {
+        droppedEvents.fetch_add(end - CAPACITY - tail, std::memory_order_relaxed);
+        tail = end - CAPACITY;
+    }
+
+    while (tail < end) {
+        const Slot& slot = slots[tail & (CAPACITY - 1)];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+        // Claimed but not finished yet - pick it up next time
+        bool pending = (sequence & WRITING) != 0 ? (sequence & ~WRITING) <= tail : sequence < tail + 1;
+        if (pending && !finishing) {
+            break;
+        }
+
+        if (sequence == tail + 1) {
+            uint64_t timestampNs = slot.timestampNs.load(std::memory_order_relaxed);
+            const char* name = slot.name.load(std::memory_order_relaxed);
+            uint32_t track = slot.track.load(std::memory_order_relaxed);
+            int64_t arg = slot.arg.load(std::memory_order_relaxed);
+            char phase = slot.phase.load(std::memory_order_relaxed);
+
+            // Only emit if nobody overwrote the slot while we were reading it
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == tail + 1) {
+                std::fprintf(output, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u%s,\"args\":{\"value\":%lld}}",
+                             firstEvent ? "" : ",\n", name, phase, timestampNs / 1000.0, track,
+                             phase == 'i' ? ",\"s\":\"t\"" : "", static_cast<long long>(arg));
+                firstEvent = false;
+            } else {
+                droppedEvents.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else {
+            droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        }
+        ++tail;
+    }
+
+    std::fflush(output);
+}
+
+#endif
@@ -0,0 +1,90 @@
+#pragma once
+
+// Structured event tracing for the engine, exported as Chrome trace JSON
+// (load into Perfetto or chrome://tracing).
+//
+// Compiled out entirely unless DATABENDER_TRACE is defined: the macros
+// below expand to nothing and TraceRing does not exist.
+//
+//   DATABENDER_TRACE_BEGIN("process", track, numFrames);
+//   ...
+//   DATABENDER_TRACE_END("process", track, 0);
+//   DATABENDER_TRACE_INSTANT("repeat-jump", track, skipBack);
+//
+// Names must be string literals (only the pointer is stored). The track
+// becomes the trace "tid", so each engine instance gets its own rows.
+
+#ifdef DATABENDER_TRACE
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+class TraceRing {
+public:
+    static constexpr int CAPACITY = 1 << 16; // Events, must be a power of two
+
+    // Process-wide ring shared by all engines
+    static TraceRing& global();
+
+    // Wait-free, callable from any audio thread. When the flusher falls a
+    // whole ring behind, the oldest events are dropped (and counted), as is
+    // an event whose slot another writer a whole ring earlier still holds.
+    void push(char phase, const char* name, uint32_t track, int64_t arg);
+
+    // Give each engine instance its own pair of tracks: the returned one for
+    // the audio thread and the next one for control calls (freeze, clear)
+    static uint32_t newTrack();
+
+    // Start a background thread that drains the ring into a Chrome trace
+    // JSON file. Not real-time safe.
+    bool startFlusher(const std::string& path);
+    void stopFlusher();
+
+    uint64_t getDroppedEvents() const;
+
+private:
+    TraceRing();
+    ~TraceRing();
+
+    void flusherMain();
+    void drain(bool finishing);
+
+    // Set in a slot's sequence, with the event index, while a writer fills it
+    static constexpr uint64_t WRITING = uint64_t(1) << 63;
+
+    // Fields are relaxed atomics and published by the sequence number, so
+    // the flusher can detect a slot being overwritten while it reads it
+    struct Slot {
+        std::atomic<uint64_t> sequence{0}; // Event index + 1 once written, or index | WRITING
+        std::atomic<uint64_t> timestampNs{0};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint32_t> track{0};
+        std::atomic<int64_t> arg{0};
+        std::atomic<char> phase{0};
+    };
+
+    Slot* slots;
+    std::atomic<uint64_t> head{0};
+    uint64_t tail = 0;
+    std::atomic<uint64_t> droppedEvents{0};
+
+    FILE* output = nullptr;
+    bool firstEvent = true;
+    std::thread flusherThread;
+    std::atomic<bool> running{false};
+};
+
+#define DATABENDER_TRACE_BEGIN(name, track, arg) TraceRing::global().push('B', name, track, arg)
+#define DATABENDER_TRACE_END(name, track, arg) TraceRing::global().push('E', name, track, arg)
+#define DATABENDER_TRACE_INSTANT(name, track, arg) TraceRing::global().push('i', name, track, arg)
+
+#else
+
+#define DATABENDER_TRACE_BEGIN(name, track, arg) ((void)0)
+#define DATABENDER_TRACE_END(name, track, arg) ((void)0)
+#define DATABENDER_TRACE_INSTANT(name, track, arg) ((void)0)
+
+#endif
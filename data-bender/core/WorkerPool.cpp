@@ -0,0 +1,200 @@
+#include "WorkerPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+// Index of the pool worker running on this thread, -1 elsewhere
+static thread_local int currentWorker = -1;
+
+// Sleepers that are not polling only wake up on their own this often
+static const std::chrono::milliseconds IDLE_TIMEOUT(100);
+
+WorkerPool::TaskQueue::TaskQueue() {
+    slots = new Slot[QUEUE_CAPACITY];
+    for (int i = 0; i < QUEUE_CAPACITY; ++i) {
+        slots[i].sequence.store(static_cast<size_t>(i), std::memory_order_relaxed);
+    }
+}
+
+WorkerPool::TaskQueue::~TaskQueue() {
+    delete[] slots;
+}
+
+bool WorkerPool::TaskQueue::push(const Task& task) {
+    size_t position = tail.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = slots[position & (QUEUE_CAPACITY - 1)];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+        if (difference == 0) {
+            if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                slot.task = task;
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (difference < 0) {
+            return false; // Full
+        } else {
+            position = tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool WorkerPool::TaskQueue::pop(Task& task) {
+    size_t position = head.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = slots[position & (QUEUE_CAPACITY - 1)];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+        if (difference == 0) {
+            if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                task = slot.task;
+                slot.sequence.store(position + QUEUE_CAPACITY, std::memory_order_release);
+                return true;
+            }
+        } else if (difference < 0) {
+            return false; // Empty
+        } else {
+            position = head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+WorkerPool& WorkerPool::global() {
+    static WorkerPool pool;
+    return pool;
+}
+
+WorkerPool::WorkerPool() {
+    int cores = static_cast<int>(std::thread::hardware_concurrency());
+    numWorkers = std::max(1, std::min(cores - 1, MAX_WORKERS));
+    workers = new Worker[numWorkers];
+    for (int i = 0; i < numWorkers; ++i) {
+        workers[i].thread = std::thread(&WorkerPool::workerMain, this, i);
+    }
+    std::cout << "WORKER POOL: " << numWorkers << " background workers" << std::endl;
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        running = false;
+    }
+    wakeup.notify_all();
+    for (int i = 0; i < numWorkers; ++i) {
+        workers[i].thread.join();
+    }
+    delete[] workers;
+}
+
+bool WorkerPool::submit(Priority priority, TaskFunction function, void* context, TaskGroup& group) {
+    // Count the task before checking for cancellation, so cancel() either
+    // sees it or it sees cancel()
+    group.pending.fetch_add(1, std::memory_order_seq_cst);
+    if (group.cancelled.load(std::memory_order_seq_cst)) {
+        group.pending.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+
+    Task task;
+    task.function = function;
+    task.context = context;
+    task.group = &group;
+
+    // Tasks spawned by a task stay with its worker unless someone steals them
+    bool pushed = currentWorker >= 0 && workers[currentWorker].local[priority].push(task);
+    if (!pushed && !shared[priority].push(task)) {
+        group.pending.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+
+    queued.fetch_add(1, std::memory_order_release);
+    submissions.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+bool WorkerPool::submitAndWake(Priority priority, TaskFunction function, void* context, TaskGroup& group) {
+    if (!submit(priority, function, context, group)) {
+        return false;
+    }
+    wakeOne();
+    return true;
+}
+
+void WorkerPool::wakeOne() {
+    // Taking the lock orders this after a sleeper's last look at the queues
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wakeup.notify_one();
+}
+
+bool WorkerPool::take(int index, Task& task) {
+    for (int priority = 0; priority < NUM_PRIORITIES; ++priority) {
+        if (workers[index].local[priority].pop(task) || shared[priority].pop(task)) {
+            return true;
+        }
+        for (int i = 1; i < numWorkers; ++i) {
+            if (workers[(index + i) % numWorkers].local[priority].pop(task)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void WorkerPool::workerMain(int index) {
+    currentWorker = index;
+
+    while (running.load(std::memory_order_acquire)) {
+        unsigned seen = submissions.load(std::memory_order_acquire);
+
+        Task task;
+        if (take(index, task)) {
+            // Hand the rest of the queue to a sleeper
+            if (queued.fetch_sub(1, std::memory_order_acq_rel) > 1) {
+                wakeOne();
+            }
+            if (!task.group->isCancelled()) {
+                task.function(task.context);
+            }
+            task.group->pending.fetch_sub(1, std::memory_order_release);
+            continue;
+        }
+
+        // One sleeper polls for tasks submitted without a wakeup; it
+        // passes the job on when it finds one
+        bool poller = !polling.exchange(true, std::memory_order_acq_rel);
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeup.wait_for(lock, poller ? std::chrono::milliseconds(POLL_INTERVAL_MS) : IDLE_TIMEOUT, [&] {
+            return !running.load(std::memory_order_acquire) || submissions.load(std::memory_order_acquire) != seen;
+        });
+        if (poller) {
+            polling.store(false, std::memory_order_release);
+            if (queued.load(std::memory_order_acquire) > 0) {
+                lock.unlock();
+                wakeOne();
+            }
+        }
+    }
+}
+
+TaskGroup::~TaskGroup() {
+    cancel();
+}
+
+void TaskGroup::wait() {
+    while (pending.load(std::memory_order_seq_cst) > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+}
+
+void TaskGroup::cancel() {
+    cancelled.store(true, std::memory_order_seq_cst);
+    wait();
+}
+
+void TaskGroup::resume() {
+    cancelled.store(false, std::memory_order_release);
+}
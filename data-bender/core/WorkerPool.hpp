@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+// Process-wide pool of background workers shared by every engine, so a
+// hundred instances don't bring a hundred sets of threads with them.
+//
+// Tasks are a function pointer and a context, queued by priority class:
+// every queued IO task runs before any ANALYSIS task, and those before BULK.
+// Each class has a bounded lock-free queue for submissions from outside the
+// pool, and every worker has its own queues for tasks submitted from inside
+// it, which idle workers steal from.
+//
+// Each task belongs to a TaskGroup - usually one per engine or store - that
+// counts what is queued or running, so its owner can wait for its work or
+// cancel it before going away.
+//
+// Sleeping workers are woken by submitAndWake(). submit() itself only
+// touches atomics, so it is safe on the audio thread; one worker polls every
+// POLL_INTERVAL_MS while the pool is idle to pick such tasks up.
+class TaskGroup;
+
+class WorkerPool {
+public:
+    enum Priority {
+        PRIORITY_IO,       // Deadlines set by the audio thread (disk spill)
+        PRIORITY_ANALYSIS, // Someone is waiting for the result
+        PRIORITY_BULK,     // Long conversions and exports
+        NUM_PRIORITIES
+    };
+
+    using TaskFunction = void (*)(void* context);
+
+    static constexpr int QUEUE_CAPACITY = 1024; // Tasks per queue, a power of two
+    static constexpr int MAX_WORKERS = 4;
+    static constexpr int POLL_INTERVAL_MS = 2;
+
+    // Created on first use with one worker per spare core (at least one, at
+    // most MAX_WORKERS). The first call is not real-time safe.
+    static WorkerPool& global();
+
+    // Queue a task (wait-free unless another thread is mid-push on the same
+    // queue, never blocks or allocates). Returns false if the queue is full
+    // or the group is cancelled; the task then never runs.
+    bool submit(Priority priority, TaskFunction function, void* context, TaskGroup& group);
+
+    // Same, and wake a sleeping worker for it. Not real-time safe.
+    bool submitAndWake(Priority priority, TaskFunction function, void* context, TaskGroup& group);
+
+    int getNumWorkers() const { return numWorkers; }
+
+private:
+    struct Task {
+        TaskFunction function = nullptr;
+        void* context = nullptr;
+        TaskGroup* group = nullptr;
+    };
+
+    // Bounded multi-producer multi-consumer ring: each slot's sequence number
+    // says whose turn it is, so pushes and pops only race on one counter
+    class TaskQueue {
+    public:
+        TaskQueue();
+        ~TaskQueue();
+
+        bool push(const Task& task);
+        bool pop(Task& task);
+
+    private:
+        struct Slot {
+            std::atomic<size_t> sequence;
+            Task task;
+        };
+
+        Slot* slots;
+        alignas(64) std::atomic<size_t> tail{0};
+        alignas(64) std::atomic<size_t> head{0};
+    };
+
+    struct Worker {
+        TaskQueue local[NUM_PRIORITIES];
+        std::thread thread;
+    };
+
+    WorkerPool();
+    ~WorkerPool();
+
+    void workerMain(int index);
+    bool take(int index, Task& task);
+    void wakeOne();
+
+    int numWorkers = 0;
+    Worker* workers = nullptr;
+    TaskQueue shared[NUM_PRIORITIES];
+    std::atomic<int> queued{0};
+    std::atomic<unsigned> submissions{0}; // Bumped by every submit, for sleepers
+    std::atomic<bool> polling{false};     // A sleeper is on POLL_INTERVAL_MS
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeup;
+    std::atomic<bool> running{true};
+};
+
+// Tasks of one owner. Destroying the group cancels whatever is still queued
+// and waits for what is running, so tasks may point into their owner.
+// wait() and cancel() must not be called from a task of the same group.
+class TaskGroup {
+public:
+    TaskGroup() = default;
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // Block until nothing of this group is queued or running. Not real-time safe.
+    void wait();
+
+    // Refuse new tasks, drop queued ones without running them and wait for
+    // running ones to return. Not real-time safe.
+    void cancel();
+
+    // Accept tasks again after cancel()
+    void resume();
+
+    bool isCancelled() const { return cancelled.load(std::memory_order_acquire); }
+    bool isIdle() const { return pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class WorkerPool;
+
+    std::atomic<int> pending{0}; // Queued plus running
+    std::atomic<bool> cancelled{false};
+};
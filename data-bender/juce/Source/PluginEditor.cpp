@@ -79,6 +79,14 @@ DataBenderJuceAudioProcessorEditor::DataBenderJuceAudioProcessorEditor(DataBende
     speedLabel.setFont(juce::Font(12.0f, juce::Font::bold));
     addAndMakeVisible(speedLabel);
     
+    // Speed knob changes tempo only when pitch is kept
+    preservePitchButton.setButtonText("Keep Pitch");
+    preservePitchButton.setToggleState(processor.getPreservePitch(), juce::dontSendNotification);
+    preservePitchButton.addListener(this);
+    preservePitchButton.setColour(juce::ToggleButton::textColourId, juce::Colours::yellow);
+    preservePitchButton.setColour(juce::ToggleButton::tickColourId, juce::Colours::gold);
+    addAndMakeVisible(preservePitchButton);
+    
     // Setup repeats slider
     repeatsSlider.setSliderStyle(juce::Slider::RotaryHorizontalVerticalDrag);
     repeatsSlider.setRange(0.0, 1.0, 0.01);
@@ -168,6 +176,7 @@ void DataBenderJuceAudioProcessorEditor::resized() {
     auto speedKnobY = bounds.getBottom() + 110; // Position below freeze button
     speedSlider.setBounds(centerX - speedKnobSize / 2, speedKnobY, speedKnobSize, speedKnobSize);
     speedLabel.setBounds(centerX - speedKnobSize / 2, speedKnobY - 25, speedKnobSize, 25);
+    preservePitchButton.setBounds(centerX + speedKnobSize / 2 + 10, speedKnobY + speedKnobSize / 2 - 12, 100, 24);
     
     // Layout repeats slider (centered below playback speed slider)
     auto repeatsKnobSize = 80;
@@ -234,6 +243,8 @@ void DataBenderJuceAudioProcessorEditor::buttonClicked(juce::Button* button) {
         } else {
             freezeButton.setButtonText("FREEZE");
         }
+    } else if (button == &preservePitchButton) {
+        processor.setPreservePitch(preservePitchButton.getToggleState());
     }
 }
 
@@ -40,6 +40,7 @@ private:
     // Playback speed control
     juce::Slider speedSlider;
     juce::Label speedLabel;
+    juce::ToggleButton preservePitchButton;
     
     // Repeats/stuttering control
     juce::Slider repeatsSlider;
@@ -65,7 +65,17 @@ void DataBenderJuceAudioProcessor::changeProgramName(int index, const juce::Stri
 
 void DataBenderJuceAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    dspEngine.init((float)sampleRate);
+    // Only the first prepare starts a fresh capture; a new rate converts
+    // the one we have in the background
+    if (!enginePrepared) {
+        dspEngine.init((float)sampleRate);
+        enginePrepared = true;
+    } else {
+        dspEngine.convertSampleRate((float)sampleRate);
+    }
+    
+    // Glide speed slider changes over 10ms instead of stepping
+    dspEngine.setSpeedRampLength((int)(sampleRate * 0.01));
     
     // Initialize level monitoring
     inputLevelL.reset(sampleRate, 0.1);
@@ -80,8 +90,8 @@ void DataBenderJuceAudioProcessor::prepareToPlay(double sampleRate, int samplesP
 
 void DataBenderJuceAudioProcessor::releaseResources()
 {
-    // DSP engine doesn't have a reset method, so we'll just reinitialize
-    dspEngine.init(dspEngine.getSampleRate());
+    // The capture is kept: hosts release and prepare again around rate and
+    // block size changes, and the buffer should survive those
 }
 
 bool DataBenderJuceAudioProcessor::isBusesLayoutSupported(const BusesLayout& busesLayout) const
@@ -99,7 +109,20 @@ bool DataBenderJuceAudioProcessor::isBusesLayoutSupported(const BusesLayout& bus
 void DataBenderJuceAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ignoreUnused(midiMessages);
+    processSamples(buffer);
+}
+
+void DataBenderJuceAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    // Native double path - the engine takes double I/O directly, so the host
+    // buffer isn't converted to float and back
+    juce::ignoreUnused(midiMessages);
+    processSamples(buffer);
+}
 
+template <typename SampleType>
+void DataBenderJuceAudioProcessor::processSamples(juce::AudioBuffer<SampleType>& buffer)
+{
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -114,8 +137,8 @@ void DataBenderJuceAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer
         
         // Read from the buffer directly
         for (int sample = 0; sample < buffer.getNumSamples(); ++sample) {
-            float sampleL = buffer.getSample(0, sample);
-            float sampleR = buffer.getNumChannels() > 1 ? buffer.getSample(1, sample) : sampleL;
+            float sampleL = (float)buffer.getSample(0, sample);
+            float sampleR = buffer.getNumChannels() > 1 ? (float)buffer.getSample(1, sample) : sampleL;
             
             maxL = juce::jmax(maxL, std::abs(sampleL));
             maxR = juce::jmax(maxR, std::abs(sampleR));
@@ -140,16 +163,16 @@ void DataBenderJuceAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer
 
     // Apply input gain to the buffer
     if (inputGain != 1.0f) {
-        buffer.applyGain(inputGain);
+        buffer.applyGain((SampleType)inputGain);
     }
 
     // Process with DSP engine - extract pointers and call with correct interface
     if (buffer.getNumChannels() > 0) {
-        const float* inputs[2] = {
+        const SampleType* inputs[2] = {
             buffer.getReadPointer(0),
             buffer.getNumChannels() > 1 ? buffer.getReadPointer(1) : buffer.getReadPointer(0)
         };
-        float* outputs[2] = {
+        SampleType* outputs[2] = {
             buffer.getWritePointer(0),
             buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : buffer.getWritePointer(0)
         };
@@ -164,8 +187,8 @@ void DataBenderJuceAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer
         
         // Read from the buffer directly
         for (int sample = 0; sample < buffer.getNumSamples(); ++sample) {
-            float sampleL = buffer.getSample(0, sample);
-            float sampleR = buffer.getNumChannels() > 1 ? buffer.getSample(1, sample) : sampleL;
+            float sampleL = (float)buffer.getSample(0, sample);
+            float sampleR = buffer.getNumChannels() > 1 ? (float)buffer.getSample(1, sample) : sampleL;
             
             maxL = juce::jmax(maxL, std::abs(sampleL));
             maxR = juce::jmax(maxR, std::abs(sampleR));
@@ -186,7 +209,7 @@ void DataBenderJuceAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer
 
     // Apply output gain
     if (outputGain != 1.0f) {
-        buffer.applyGain(outputGain);
+        buffer.applyGain((SampleType)outputGain);
     }
 }
 
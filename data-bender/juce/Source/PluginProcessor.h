@@ -17,7 +17,8 @@ public:
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
 
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-    using AudioProcessor::processBlock;
+    void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -60,12 +61,49 @@ public:
     void setPlaybackSpeed(float speed) { dspEngine.setPlaybackSpeed(speed); }
     float getPlaybackSpeed() const { return dspEngine.getPlaybackSpeed(); }
 
+    // Speed changes tempo only (allocates the stretch on first use)
+    void setPreservePitch(bool enabled) {
+        suspendProcessing(true);
+        dspEngine.setPreservePitch(enabled);
+        suspendProcessing(false);
+    }
+    bool getPreservePitch() const { return dspEngine.getPreservePitch(); }
+
     // Repeats/stuttering
     void setRepeats(float repeats) { dspEngine.setRepeats(repeats); }
     float getRepeats() const { return dspEngine.getRepeats(); }
 
+    // Long-capture mode (disk-backed)
+    bool enableLongCapture(const juce::File& file, float seconds) {
+        suspendProcessing(true);
+        bool ok = dspEngine.enableLongCapture(file.getFullPathName().toStdString(), seconds);
+        suspendProcessing(false);
+        return ok;
+    }
+    bool isLongCaptureActive() const { return dspEngine.isLongCaptureActive(); }
+
+    // Pinned capture memory (huge pages and mlock, for dedicated machines)
+    bool setPinnedCapture(bool enabled) {
+        suspendProcessing(true);
+        bool ok = dspEngine.setPinnedCapture(enabled);
+        suspendProcessing(false);
+        return ok;
+    }
+    bool isPinnedCaptureActive() const { return dspEngine.isPinnedCaptureActive(); }
+    juce::String getCaptureMemory() const { return dspEngine.getCaptureMemory(); }
+
+    // Per-block timing statistics
+    void setTimingEnabled(bool enabled) { dspEngine.setTimingEnabled(enabled); }
+    bool isTimingEnabled() const { return dspEngine.isTimingEnabled(); }
+    const EngineStats& getEngineStats() const { return dspEngine.getStats(); }
+    void resetEngineStats() { dspEngine.getStats().reset(); }
+
 private:
+    template <typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType>& buffer);
+    
     DataBenderEngine dspEngine;
+    bool enginePrepared = false; // Later prepares keep the capture
     
     // Level monitoring - input and output
     juce::LinearSmoothedValue<float> inputLevelL;
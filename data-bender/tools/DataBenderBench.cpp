@@ -0,0 +1,518 @@
+// Benchmark for compile-time engine configurations: runs the standard
+// DataBenderEngine against specialised BasicDataBenderEngine<Config>
+// variants on the same input.
+//
+//   DataBenderBench [options]
+//     --seconds S      Audio captured and played back per run (default 10)
+//     --block B        Block size (default 256)
+//     --runs N         Runs per variant, best is reported (default 5)
+//     --repeats R      Repeats setting during frozen playback (default 0.5)
+//     --rate HZ        Sample rate (default 44100)
+//
+// For each variant it reports capture memory, passthrough cost, the time
+// setFreeze takes (silence analysis) and frozen playback cost. The
+// "compact" row is the default engine with silence-gated capture, which
+// drops silence while capturing instead of at freeze. "snap" snaps repeat
+// jumps to onsets, "stretch" plays with pitch preserved, and "no-onsets" compiles the onset index out, so its
+// passthrough difference to "default" is the cost of onset detection.
+//
+// A second table prices granular playback at increasing grain counts, per
+// sample and per active grain. A third prices spectral freeze at each frame
+// size: one forward plus inverse real FFT, analyzing the kept frames of
+// both channels, and frozen playback.
+//
+// The last table drives the engine the way VCV Rack does, one virtual call
+// per sample: through the block API with one frame per call (the old
+// adapter), through processSample, and through processSample's micro-block
+// mode, which adds its block size in latency.
+//
+// Finally it prices random reads across a 60 second ring on the heap and
+// in pinned memory (huge pages and mlock where the system allows): single
+// frames at random positions, each depending on the last so TLB misses
+// show, and 64-frame reads after a random jump, as stutter makes them.
+
+#include "DataBenderEngineImpl.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// Standard engine with linear interpolation, to price the extra read
+struct LinearConfig : DefaultDataBenderConfig {
+    static constexpr int INTERPOLATION_ORDER = 1;
+};
+
+// Standard engine without the onset index
+struct NoOnsetConfig : DefaultDataBenderConfig {
+    static constexpr bool ENABLE_ONSET_INDEX = false;
+};
+
+// Pure looper: no repeats, no silence trimming, no post filter
+struct LooperConfig : DefaultDataBenderConfig {
+    static constexpr bool ENABLE_REPEATS = false;
+    static constexpr bool ENABLE_TRIMMING = false;
+    static constexpr bool ENABLE_POST_FILTER = false;
+};
+
+// Pure looper with mono 16-bit capture (a quarter of the memory)
+struct CompactLooperConfig : LooperConfig {
+    static constexpr int CHANNELS = 1;
+    using Sample = int16_t;
+};
+
+template class BasicDataBenderEngine<LinearConfig>;
+template class BasicDataBenderEngine<NoOnsetConfig>;
+template class BasicDataBenderEngine<LooperConfig>;
+template class BasicDataBenderEngine<CompactLooperConfig>;
+
+struct Options {
+    float seconds = 10.0f;
+    int blockSize = 256;
+    int runs = 5;
+    float repeats = 0.5f;
+    float sampleRate = 44100.0f;
+};
+
+// Runtime settings applied to a variant
+enum VariantFlags {
+    VARIANT_COMPACT = 1,
+    VARIANT_SNAP = 2,
+    VARIANT_STRETCH = 4
+};
+
+struct Result {
+    double passNsPerSample = 0.0;
+    double freezeMs = 0.0;
+    double frozenNsPerSample = 0.0;
+};
+
+// Tone bursts separated by silence, so trimming finds segments
+static void makeInput(std::vector<float>& left, std::vector<float>& right, int numFrames, float sampleRate) {
+    left.resize(numFrames);
+    right.resize(numFrames);
+    int burst = static_cast<int>(sampleRate * 0.5f);
+    int gap = static_cast<int>(sampleRate * 0.25f);
+    for (int i = 0; i < numFrames; ++i) {
+        bool audible = (i % (burst + gap)) < burst;
+        float phase = static_cast<float>(i) / sampleRate;
+        left[i] = audible ? 0.5f * std::sin(2.0f * 3.14159265f * 220.0f * phase) : 0.0f;
+        right[i] = audible ? 0.5f * std::sin(2.0f * 3.14159265f * 330.0f * phase) : 0.0f;
+    }
+}
+
+static double nsPerSample(Clock::duration elapsed, int numFrames) {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / numFrames;
+}
+
+template <typename Engine>
+static Result runOnce(const Options& options, const std::vector<float>& left, const std::vector<float>& right,
+                      int flags) {
+    Engine* engine = new Engine();
+    engine->init(options.sampleRate);
+    engine->setRandomSeed(1);
+    if (flags & VARIANT_COMPACT) {
+        engine->setCompactCapture(true);
+    }
+    engine->setOnsetSnap((flags & VARIANT_SNAP) != 0);
+    engine->setPreservePitch((flags & VARIANT_STRETCH) != 0);
+
+    int numFrames = static_cast<int>(left.size());
+    std::vector<float> outL(options.blockSize), outR(options.blockSize);
+    float* outputs[2] = { outL.data(), outR.data() };
+    Result result;
+
+    // Capture
+    Clock::time_point start = Clock::now();
+    for (int frame = 0; frame < numFrames; frame += options.blockSize) {
+        int count = std::min(options.blockSize, numFrames - frame);
+        const float* inputs[2] = { left.data() + frame, right.data() + frame };
+        engine->process(inputs, outputs, count);
+    }
+    result.passNsPerSample = nsPerSample(Clock::now() - start, numFrames);
+
+    // Freeze (silence analysis runs here)
+    start = Clock::now();
+    engine->setFreeze(true);
+    result.freezeMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    // Frozen playback
+    engine->setRepeats(options.repeats);
+    const float* silent[2] = { nullptr, nullptr };
+    start = Clock::now();
+    for (int frame = 0; frame < numFrames; frame += options.blockSize) {
+        int count = std::min(options.blockSize, numFrames - frame);
+        engine->process(silent, outputs, count);
+    }
+    result.frozenNsPerSample = nsPerSample(Clock::now() - start, numFrames);
+
+    delete engine;
+    return result;
+}
+
+template <typename Engine>
+static Result runVariant(const char* name, const Options& options, const std::vector<float>& left,
+                         const std::vector<float>& right, const Result* baseline, int flags = 0) {
+    Result best;
+    for (int run = 0; run < options.runs; ++run) {
+        Result result = runOnce<Engine>(options, left, right, flags);
+        if (run == 0 || result.passNsPerSample < best.passNsPerSample) {
+            best.passNsPerSample = result.passNsPerSample;
+        }
+        if (run == 0 || result.freezeMs < best.freezeMs) {
+            best.freezeMs = result.freezeMs;
+        }
+        if (run == 0 || result.frozenNsPerSample < best.frozenNsPerSample) {
+            best.frozenNsPerSample = result.frozenNsPerSample;
+        }
+    }
+
+    double captureMb = Engine::captureBytes() / (1024.0 * 1024.0);
+    double speedup = baseline ? baseline->frozenNsPerSample / best.frozenNsPerSample : 1.0;
+    std::printf("%-16s %9.1f %10.2f %10.2f %11.2f %8.2fx\n",
+                name, captureMb, best.passNsPerSample, best.freezeMs, best.frozenNsPerSample, speedup);
+    return best;
+}
+
+// Granular playback of the same capture with about targetGrains overlapping
+static void runGrains(int targetGrains, const Options& options, const std::vector<float>& left,
+                      const std::vector<float>& right) {
+    const float grainSeconds = 0.1f;
+    double bestNs = 0.0;
+    double activeMean = 0.0;
+    for (int run = 0; run < options.runs; ++run) {
+        DataBenderEngine* engine = new DataBenderEngine();
+        engine->init(options.sampleRate);
+        engine->setRandomSeed(1);
+        engine->setGranularMode(true);
+        engine->setGrainLength(grainSeconds);
+        engine->setGrainDensity(targetGrains / grainSeconds);
+
+        int numFrames = static_cast<int>(left.size());
+        std::vector<float> outL(options.blockSize), outR(options.blockSize);
+        float* outputs[2] = { outL.data(), outR.data() };
+        for (int frame = 0; frame < numFrames; frame += options.blockSize) {
+            int count = std::min(options.blockSize, numFrames - frame);
+            const float* inputs[2] = { left.data() + frame, right.data() + frame };
+            engine->process(inputs, outputs, count);
+        }
+        engine->setFreeze(true);
+
+        // Let the cloud fill up before timing it
+        const float* silent[2] = { nullptr, nullptr };
+        int warmup = static_cast<int>(grainSeconds * options.sampleRate * 2.0f);
+        for (int frame = 0; frame < warmup; frame += options.blockSize) {
+            engine->process(silent, outputs, options.blockSize);
+        }
+
+        long activeSum = 0;
+        int blocks = 0;
+        Clock::duration elapsed = Clock::duration::zero();
+        for (int frame = 0; frame < numFrames; frame += options.blockSize, ++blocks) {
+            int count = std::min(options.blockSize, numFrames - frame);
+            Clock::time_point start = Clock::now();
+            engine->process(silent, outputs, count);
+            elapsed += Clock::now() - start;
+            activeSum += engine->getActiveGrains();
+        }
+        double ns = nsPerSample(elapsed, numFrames);
+        if (run == 0 || ns < bestNs) {
+            bestNs = ns;
+        }
+        activeMean = static_cast<double>(activeSum) / blocks;
+        delete engine;
+    }
+
+    double perGrain = activeMean > 0.0 ? bestNs / activeMean : 0.0;
+    std::printf("%-16d %9.1f %12.2f %14.2f\n", targetGrains, activeMean, bestNs, perGrain);
+}
+
+// Spectral freeze at one frame size
+static void runSpectral(int frameSize, const Options& options, const std::vector<float>& left,
+                        const std::vector<float>& right) {
+    double bestFftUs = 0.0;
+    double bestAnalyzeUs = 0.0;
+    double bestNs = 0.0;
+    for (int run = 0; run < options.runs; ++run) {
+        // The transforms on their own
+        RealFFT fft;
+        fft.prepare(frameSize);
+        std::vector<float> frame(left.begin(), left.begin() + frameSize);
+        std::vector<float> real(frameSize / 2 + 1), imag(frameSize / 2 + 1);
+        const int transforms = 200;
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < transforms; ++i) {
+            fft.forward(frame.data(), real.data(), imag.data());
+            fft.inverse(real.data(), imag.data(), frame.data());
+        }
+        double fftUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / transforms;
+
+        SpectralFreeze freeze;
+        freeze.prepare(frameSize, true);
+        std::copy(left.begin(), left.begin() + freeze.getHistoryLength(), freeze.getHistoryL());
+        std::copy(right.begin(), right.begin() + freeze.getHistoryLength(), freeze.getHistoryR());
+        const int analyses = 20;
+        start = Clock::now();
+        for (int i = 0; i < analyses; ++i) {
+            freeze.analyze(1);
+        }
+        double analyzeUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / analyses;
+
+        DataBenderEngine* engine = new DataBenderEngine();
+        engine->init(options.sampleRate);
+        engine->setRandomSeed(1);
+        engine->setSpectralFrameSize(frameSize);
+        engine->setSpectralFreeze(true);
+
+        int numFrames = static_cast<int>(left.size());
+        std::vector<float> outL(options.blockSize), outR(options.blockSize);
+        float* outputs[2] = { outL.data(), outR.data() };
+        for (int frame = 0; frame < numFrames; frame += options.blockSize) {
+            int count = std::min(options.blockSize, numFrames - frame);
+            const float* inputs[2] = { left.data() + frame, right.data() + frame };
+            engine->process(inputs, outputs, count);
+        }
+        engine->setFreeze(true);
+
+        const float* silent[2] = { nullptr, nullptr };
+        Clock::duration elapsed = Clock::duration::zero();
+        for (int frame = 0; frame < numFrames; frame += options.blockSize) {
+            int count = std::min(options.blockSize, numFrames - frame);
+            Clock::time_point blockStart = Clock::now();
+            engine->process(silent, outputs, count);
+            elapsed += Clock::now() - blockStart;
+        }
+        double ns = nsPerSample(elapsed, numFrames);
+        delete engine;
+
+        if (run == 0 || fftUs < bestFftUs) {
+            bestFftUs = fftUs;
+        }
+        if (run == 0 || analyzeUs < bestAnalyzeUs) {
+            bestAnalyzeUs = analyzeUs;
+        }
+        if (run == 0 || ns < bestNs) {
+            bestNs = ns;
+        }
+    }
+
+    std::printf("%-16d %12.2f %11.1f %12.2f\n", frameSize, bestFftUs, bestAnalyzeUs, bestNs);
+}
+
+// A Rack module: the host makes one virtual call per sample
+struct RackAdapter {
+    virtual ~RackAdapter() = default;
+    virtual void process(float inputL, float inputR, float& outputL, float& outputR) = 0;
+    DataBenderEngine engine;
+};
+
+struct BlockApiAdapter : RackAdapter {
+    void process(float inputL, float inputR, float& outputL, float& outputR) override {
+        const float* inputs[2] = { &inputL, &inputR };
+        float* outputs[2] = { &outputL, &outputR };
+        engine.process(inputs, outputs, 1);
+    }
+};
+
+struct SampleAdapter : RackAdapter {
+    void process(float inputL, float inputR, float& outputL, float& outputR) override {
+        engine.processSample(inputL, inputR, outputL, outputR);
+    }
+};
+
+static Result runRack(const char* name, bool blockApi, int microBlock, const Options& options,
+                      const std::vector<float>& left, const std::vector<float>& right, const Result* baseline) {
+    Result best;
+    for (int run = 0; run < options.runs; ++run) {
+        RackAdapter* adapter = blockApi ? static_cast<RackAdapter*>(new BlockApiAdapter())
+                                        : static_cast<RackAdapter*>(new SampleAdapter());
+        adapter->engine.init(options.sampleRate);
+        adapter->engine.setRandomSeed(1);
+        adapter->engine.setMicroBlockSize(microBlock);
+
+        int numFrames = static_cast<int>(left.size());
+        float outL = 0.0f, outR = 0.0f;
+        float sink = 0.0f;
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < numFrames; ++i) {
+            adapter->process(left[i], right[i], outL, outR);
+            sink += outL;
+        }
+        double passNs = nsPerSample(Clock::now() - start, numFrames);
+
+        adapter->engine.setFreeze(true);
+        adapter->engine.setRepeats(options.repeats);
+        start = Clock::now();
+        for (int i = 0; i < numFrames; ++i) {
+            adapter->process(0.0f, 0.0f, outL, outR);
+            sink += outL;
+        }
+        double frozenNs = nsPerSample(Clock::now() - start, numFrames);
+        delete adapter;
+
+        // Keep the outputs alive without printing them
+        if (sink == 12345.0f) {
+            std::printf(" ");
+        }
+        if (run == 0 || passNs < best.passNsPerSample) {
+            best.passNsPerSample = passNs;
+        }
+        if (run == 0 || frozenNs < best.frozenNsPerSample) {
+            best.frozenNsPerSample = frozenNs;
+        }
+    }
+
+    double passSpeedup = baseline ? baseline->passNsPerSample / best.passNsPerSample : 1.0;
+    double frozenSpeedup = baseline ? baseline->frozenNsPerSample / best.frozenNsPerSample : 1.0;
+    std::printf("%-16s %7d %10.2f %12.2f %8.2fx %8.2fx\n",
+                name, microBlock, best.passNsPerSample, best.frozenNsPerSample, passSpeedup, frozenSpeedup);
+    return best;
+}
+
+// Random reads from a stereo ring of the default engine's size
+static void runCaptureMemory(const char* name, bool pinned, const Options& options) {
+    const int frames = DefaultDataBenderConfig::BUFFER_SECONDS * DefaultDataBenderConfig::BUFFER_SAMPLE_RATE;
+    const int numReads = 2000000;
+    const int numJumps = 200000;
+    const int jumpFrames = 64;
+    double bestSetupMs = 0.0, bestReadNs = 0.0, bestJumpNs = 0.0;
+    size_t hugeBytes = 0;
+    std::string memory;
+    float sink = 0.0f;
+    for (int run = 0; run < options.runs; ++run) {
+        Clock::time_point start = Clock::now();
+        CaptureSource<float>* source = new CaptureSource<float>(frames, 2, 0, pinned);
+        double setupMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        const float* ringL = source->getL();
+        const float* ringR = source->getR();
+        hugeBytes = hugePageBytes(ringL, frames * sizeof(float)) + hugePageBytes(ringR, frames * sizeof(float));
+        memory = source->describeMemory();
+
+        // The ring is silent, but the compiler can't know the next position
+        // doesn't depend on what was read
+        uint32_t state = 0x9E3779B9u;
+        start = Clock::now();
+        for (int i = 0; i < numReads; ++i) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            int position = static_cast<int>((state + static_cast<uint32_t>(sink)) % frames);
+            sink += ringL[position] + ringR[position];
+        }
+        double readNs = nsPerSample(Clock::now() - start, numReads);
+
+        start = Clock::now();
+        for (int i = 0; i < numJumps; ++i) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            int position = static_cast<int>(state % (frames - jumpFrames));
+            float sum = 0.0f;
+            for (int frame = position; frame < position + jumpFrames; ++frame) {
+                sum += ringL[frame] + ringR[frame];
+            }
+            sink += sum;
+        }
+        double jumpNs = nsPerSample(Clock::now() - start, numJumps);
+        delete source;
+
+        if (run == 0 || setupMs < bestSetupMs) {
+            bestSetupMs = setupMs;
+        }
+        if (run == 0 || readNs < bestReadNs) {
+            bestReadNs = readNs;
+        }
+        if (run == 0 || jumpNs < bestJumpNs) {
+            bestJumpNs = jumpNs;
+        }
+    }
+
+    // Keep the reads alive without printing them
+    if (sink == 12345.0f) {
+        std::printf(" ");
+    }
+    std::printf("%-16s %9.1f %8.1f %8.2f %10.2f  %s\n",
+                name, bestSetupMs, hugeBytes / (1024.0 * 1024.0), bestReadNs, bestJumpNs, memory.c_str());
+}
+
+static void printUsage() {
+    std::printf("Usage: DataBenderBench [--seconds S] [--block B] [--runs N] [--repeats R] [--rate HZ]\n");
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--seconds" && i + 1 < argc) {
+            options.seconds = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--block" && i + 1 < argc) {
+            options.blockSize = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--runs" && i + 1 < argc) {
+            options.runs = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--repeats" && i + 1 < argc) {
+            options.repeats = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--rate" && i + 1 < argc) {
+            options.sampleRate = static_cast<float>(std::atof(argv[++i]));
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (options.seconds <= 0.0f || options.sampleRate <= 0.0f) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<float> left, right;
+    makeInput(left, right, static_cast<int>(options.seconds * options.sampleRate), options.sampleRate);
+
+    // The engines log freeze/analysis to stdout; keep the table readable
+    std::cout.setstate(std::ios::failbit);
+
+    std::printf("seconds=%.1f block=%d runs=%d repeats=%.2f rate=%.0f\n",
+                options.seconds, options.blockSize, options.runs, options.repeats, options.sampleRate);
+    std::printf("variant          capture(MB) pass(ns/s) freeze(ms) frozen(ns/s)  speedup\n");
+
+    Result baseline = runVariant<DataBenderEngine>("default", options, left, right, nullptr);
+    runVariant<DataBenderEngine>("compact", options, left, right, &baseline, VARIANT_COMPACT);
+    runVariant<DataBenderEngine>("snap", options, left, right, &baseline, VARIANT_SNAP);
+    runVariant<DataBenderEngine>("stretch", options, left, right, &baseline, VARIANT_STRETCH);
+    runVariant<BasicDataBenderEngine<NoOnsetConfig>>("no-onsets", options, left, right, &baseline);
+    runVariant<BasicDataBenderEngine<LinearConfig>>("linear", options, left, right, &baseline);
+    runVariant<BasicDataBenderEngine<LooperConfig>>("looper", options, left, right, &baseline);
+    runVariant<BasicDataBenderEngine<CompactLooperConfig>>("looper-mono16", options, left, right, &baseline);
+
+    std::printf("\ngrains           active(avg) frozen(ns/s) per grain(ns/s)\n");
+    const int grainCounts[] = { 0, 4, 8, 16, 32, 48, 64 };
+    for (int grains : grainCounts) {
+        runGrains(grains, options, left, right);
+    }
+
+    std::printf("\nspectral frame   fft+ifft(us) analyze(us) frozen(ns/s)\n");
+    const int frameSizes[] = { 512, 1024, 2048 };
+    for (int frameSize : frameSizes) {
+        runSpectral(frameSize, options, left, right);
+    }
+
+    std::printf("\nrack adapter     latency pass(ns/s) frozen(ns/s)     pass   frozen\n");
+    Result rackBaseline = runRack("process(1)", true, 0, options, left, right, nullptr);
+    runRack("processSample", false, 0, options, left, right, &rackBaseline);
+    const int microBlocks[] = { 16, 32, 64, 128 };
+    for (int microBlock : microBlocks) {
+        runRack("micro-block", false, microBlock, options, left, right, &rackBaseline);
+    }
+
+    std::printf("\ncapture memory   setup(ms) huge(MB) read(ns) jump64(ns)  pages\n");
+    runCaptureMemory("heap", false, options);
+    runCaptureMemory("pinned", true, options);
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+// C embedding example for libdatabender: maps a raw interleaved float32
+// file read-only and feeds it straight from the mapping, with no copy.
+//
+//   DataBenderEmbed input.raw output.raw [options]
+//     --channels N     1 or 2 (default 2)
+//     --rate HZ        Sample rate (default 48000)
+//     --block B        Frames per call (default 256)
+//     --freeze-at SEC  Freeze once this much has played (default 2)
+//     --speed S        Playback speed while frozen (default 1)
+//     --repeats R      Repeats while frozen (default 0)
+//
+// Prints the meters, trim map and block timing when done. Raw files can be
+// made with e.g. "sox in.wav -t f32 in.raw".
+
+#include "databender.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define TRIM_MAP_CAPACITY 16
+
+static void printUsage(void) {
+    printf("Usage: DataBenderEmbed input.raw output.raw [--channels N] [--rate HZ] [--block B]"
+           " [--freeze-at SEC] [--speed S] [--repeats R]\n");
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+
+    int channels = 2;
+    float sampleRate = 48000.0f;
+    int blockSize = 256;
+    float freezeAt = 2.0f;
+    float speed = 1.0f;
+    float repeats = 0.0f;
+    for (int i = 3; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!value) {
+            printUsage();
+            return 1;
+        }
+        if (strcmp(arg, "--channels") == 0) {
+            channels = atoi(value);
+        } else if (strcmp(arg, "--rate") == 0) {
+            sampleRate = (float)atof(value);
+        } else if (strcmp(arg, "--block") == 0) {
+            blockSize = atoi(value);
+        } else if (strcmp(arg, "--freeze-at") == 0) {
+            freezeAt = (float)atof(value);
+        } else if (strcmp(arg, "--speed") == 0) {
+            speed = (float)atof(value);
+        } else if (strcmp(arg, "--repeats") == 0) {
+            repeats = (float)atof(value);
+        } else {
+            printUsage();
+            return 1;
+        }
+        ++i;
+    }
+    if ((channels != 1 && channels != 2) || blockSize <= 0) {
+        printUsage();
+        return 1;
+    }
+
+    int input = open(argv[1], O_RDONLY);
+    struct stat status;
+    if (input < 0 || fstat(input, &status) != 0) {
+        fprintf(stderr, "EMBED: Cannot open %s\n", argv[1]);
+        return 1;
+    }
+    size_t frameBytes = sizeof(float) * (size_t)channels;
+    long totalFrames = (long)((size_t)status.st_size / frameBytes);
+    if (totalFrames == 0) {
+        fprintf(stderr, "EMBED: %s holds no frames\n", argv[1]);
+        return 1;
+    }
+    const float* samples = (const float*)mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, input, 0);
+    close(input);
+    if (samples == (const float*)MAP_FAILED) {
+        fprintf(stderr, "EMBED: Cannot map %s\n", argv[1]);
+        return 1;
+    }
+
+    FILE* output = fopen(argv[2], "wb");
+    float* block = (float*)malloc(frameBytes * (size_t)blockSize);
+    databender_engine* engine = databender_create(DATABENDER_API_VERSION, sampleRate);
+    if (!output || !block || !engine) {
+        fprintf(stderr, "EMBED: Setup failed (library version %u.%u)\n",
+                databender_version() >> 16, databender_version() & 0xffff);
+        return 1;
+    }
+    databender_set_timing(engine, 1);
+
+    long freezeFrame = (long)(freezeAt * sampleRate);
+    int frozen = 0;
+    for (long frame = 0; frame < totalFrames; frame += blockSize) {
+        if (!frozen && frame >= freezeFrame) {
+            databender_set_freeze(engine, 1);
+            databender_set_playback_speed(engine, speed);
+            databender_set_repeats(engine, repeats);
+            frozen = 1;
+        }
+        int count = totalFrames - frame < blockSize ? (int)(totalFrames - frame) : blockSize;
+        if (databender_process_interleaved(engine, samples + frame * channels, block, channels, count) != DATABENDER_OK) {
+            fprintf(stderr, "EMBED: Processing failed\n");
+            return 1;
+        }
+        fwrite(block, frameBytes, (size_t)count, output);
+    }
+
+    databender_meters meters;
+    meters.size = sizeof(meters);
+    databender_read_meters(engine, &meters);
+    printf("Processed %ld frames (%d channel%s), frozen %s\n", totalFrames, channels,
+           channels == 1 ? "" : "s", meters.frozen ? "yes" : "no");
+    printf("Last block: in peak %.3f/%.3f rms %.3f/%.3f, out peak %.3f/%.3f rms %.3f/%.3f\n",
+           meters.input_peak[0], meters.input_peak[1], meters.input_rms[0], meters.input_rms[1],
+           meters.output_peak[0], meters.output_peak[1], meters.output_rms[0], meters.output_rms[1]);
+    printf("Speed %.2f, repeats %.2f, onsets %d, trimmed length %d\n",
+           meters.playback_speed, meters.repeats, meters.onset_count, meters.trimmed_length);
+
+    databender_segment segments[TRIM_MAP_CAPACITY];
+    int segmentCount = databender_read_trim_map(engine, segments, TRIM_MAP_CAPACITY);
+    printf("Trim map: %d segment%s\n", segmentCount, segmentCount == 1 ? "" : "s");
+    for (int i = 0; i < segmentCount && i < TRIM_MAP_CAPACITY; ++i) {
+        printf("  %8d +%d\n", segments[i].start, segments[i].length);
+    }
+
+    databender_stats stats;
+    stats.size = sizeof(stats);
+    databender_read_stats(engine, &stats);
+    printf("Timing: %llu blocks, mean %.2f ns/sample, p99 %.2f, max %.2f, overruns %llu\n",
+           (unsigned long long)stats.blocks, stats.mean_ns_per_sample, stats.p99_ns_per_sample,
+           stats.max_ns_per_sample, (unsigned long long)stats.overruns);
+    printf("Analysis memory: %llu of %llu bytes (peak %llu)\n",
+           (unsigned long long)stats.analysis_bytes_used, (unsigned long long)stats.analysis_budget,
+           (unsigned long long)stats.analysis_bytes_peak);
+
+    databender_destroy(engine);
+    free(block);
+    fclose(output);
+    munmap((void*)samples, (size_t)status.st_size);
+    return 0;
+}
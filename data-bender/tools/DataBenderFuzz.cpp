@@ -0,0 +1,844 @@
+// Differential fuzzer: drives BasicDataBenderEngine and the scalar
+// ReferenceEngine (ReferenceEngine.hpp) with the same random audio, block
+// splits and control changes, and checks their outputs match.
+//
+//   DataBenderFuzz [options]
+//     --cases N        Random cases to run (default 200)
+//     --seed S         First case seed (default 1); case i uses S + i
+//     --config NAME    small | linear | mono16 | raw | looper | default | all (default all)
+//     --frames N       Longest case in frames (default 60000)
+//     --tolerance T    Largest accepted difference per sample (default 0, bit-exact)
+//     --corpus DIR     Where minimized failures are saved (default fuzz-cases)
+//     --no-minimize    Save failing cases as generated
+//     --replay PATH    Replay saved cases (a file or a directory) instead
+//     --verbose        Keep the engine's log output
+//
+// Each case picks a configuration, a PRNG seed and float or double I/O, then
+// a list of blocks. A block has a length, a signal, control events at
+// sample offsets (freeze, speed, repeats, clear) and a driver: process()
+// with timestamped events, process() split at each event with the setters
+// called in between, or processSample() a frame at a time. The reference
+// renders the same case a frame at a time.
+//
+// Outputs must match exactly (or within --tolerance, for kernels that
+// reorder float math on purpose), as must the freeze state and trimmed
+// length after every block. A failing case is minimized by dropping blocks
+// and events, shortening blocks and simplifying signals while it still
+// fails, then written to the corpus as a text file. Replaying the corpus
+// after a change is the regression run: it exits non-zero if any case
+// still differs. Cases checked into data-bender/fuzz-cases are replayed by
+// the build.
+//
+// The small configurations use a 16384 frame ring so captures wrap and
+// takes loop within a short case. "default" is the shipped engine.
+
+#include "DataBenderEngineImpl.hpp"
+#include "ReferenceEngine.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Small ring, so captures wrap and takes loop within a case
+struct FuzzConfig : DefaultDataBenderConfig {
+    static constexpr int BUFFER_SECONDS = 1;
+    static constexpr int BUFFER_SAMPLE_RATE = 16384;
+};
+
+struct FuzzLinearConfig : FuzzConfig {
+    static constexpr int INTERPOLATION_ORDER = 1;
+};
+
+struct FuzzMono16Config : FuzzConfig {
+    static constexpr int CHANNELS = 1;
+    using Sample = int16_t;
+};
+
+// Raw playback with repeats: without trimming, jumps crossfade
+struct FuzzRawConfig : FuzzConfig {
+    static constexpr bool ENABLE_TRIMMING = false;
+};
+
+struct FuzzLooperConfig : FuzzConfig {
+    static constexpr bool ENABLE_REPEATS = false;
+    static constexpr bool ENABLE_TRIMMING = false;
+    static constexpr bool ENABLE_POST_FILTER = false;
+};
+
+template class BasicDataBenderEngine<FuzzConfig>;
+template class BasicDataBenderEngine<FuzzLinearConfig>;
+template class BasicDataBenderEngine<FuzzMono16Config>;
+template class BasicDataBenderEngine<FuzzRawConfig>;
+template class BasicDataBenderEngine<FuzzLooperConfig>;
+
+enum ConfigId {
+    CONFIG_SMALL = 0,
+    CONFIG_LINEAR,
+    CONFIG_MONO16,
+    CONFIG_RAW,
+    CONFIG_LOOPER,
+    CONFIG_DEFAULT,
+    NUM_CONFIGS
+};
+
+static const char* configNames[] = { "small", "linear", "mono16", "raw", "looper", "default" };
+
+enum Driver {
+    DRIVER_EVENTS = 0, // process() with DataBenderEvents
+    DRIVER_SPLIT,      // process() per span, setters between
+    DRIVER_SAMPLE,     // processSample(), float I/O only
+    NUM_DRIVERS
+};
+
+static const char* driverNames[] = { "events", "split", "sample" };
+
+enum EventKind {
+    EVENT_FREEZE = 0,
+    EVENT_SPEED,
+    EVENT_REPEATS,
+    EVENT_CLEAR,
+    NUM_EVENT_KINDS
+};
+
+static const char* eventNames[] = { "freeze", "speed", "repeats", "clear" };
+
+enum SignalKind {
+    SIGNAL_SILENCE = 0,
+    SIGNAL_SINE,
+    SIGNAL_NOISE,
+    SIGNAL_BURSTS,    // Sine gated on and off every period frames
+    SIGNAL_DC,
+    SIGNAL_THRESHOLD, // Sparse values around the silence threshold
+    NUM_SIGNALS
+};
+
+static const char* signalNames[] = { "silence", "sine", "noise", "bursts", "dc", "threshold" };
+
+struct Signal {
+    int kind = SIGNAL_SILENCE;
+    float amplitude = 0.0f;
+    int period = 100;
+    unsigned int seed = 1;
+};
+
+struct FuzzEvent {
+    int offset; // From the block start, up to and including its length
+    int kind;
+    float value;
+};
+
+struct Block {
+    int frames = 0;
+    int driver = DRIVER_EVENTS;
+    Signal signal;
+    std::vector<FuzzEvent> events; // Sorted by offset
+};
+
+struct FuzzCase {
+    int config = CONFIG_SMALL;
+    unsigned int seed = 1; // Engine PRNG seed
+    bool doubleIO = false;
+    std::vector<Block> blocks;
+};
+
+struct Mismatch {
+    bool found = false;
+    int block = -1;
+    long frame = 0; // From the start of the case
+    int channel = 0;
+    double expected = 0.0;
+    double actual = 0.0;
+    std::string what;
+};
+
+struct Options {
+    int cases = 200;
+    unsigned int seed = 1;
+    int config = -1; // -1 = all
+    int maxFrames = 60000;
+    double tolerance = 0.0;
+    std::string corpus = "fuzz-cases";
+    bool minimize = true;
+    std::vector<std::string> replay;
+    bool verbose = false;
+};
+
+static constexpr float SAMPLE_RATE = 48000.0f;
+
+// splitmix64, for case generation
+class Random {
+public:
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    double unit() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+    int below(int range) { return range > 0 ? static_cast<int>(next() % static_cast<uint64_t>(range)) : 0; }
+    int between(int low, int high) { return low + below(high - low + 1); }
+
+private:
+    uint64_t state;
+};
+
+//==============================================================================
+// Case generation
+
+static float signalValue(const Signal& signal, int frame, int channel) {
+    switch (signal.kind) {
+        case SIGNAL_SINE:
+            return signal.amplitude * std::sin(6.2831853f * frame / signal.period + channel * 0.5f);
+        case SIGNAL_NOISE: {
+            Random random((static_cast<uint64_t>(signal.seed) << 32) ^ (static_cast<uint64_t>(frame) << 1) ^ channel);
+            return signal.amplitude * static_cast<float>(random.unit() * 2.0 - 1.0);
+        }
+        case SIGNAL_BURSTS:
+            if ((frame / signal.period) % 2 != 0) {
+                return 0.0f;
+            }
+            return signal.amplitude * std::sin(6.2831853f * frame / 64.0f + channel * 0.5f);
+        case SIGNAL_DC:
+            return channel == 0 ? signal.amplitude : -signal.amplitude;
+        case SIGNAL_THRESHOLD: {
+            Random random((static_cast<uint64_t>(signal.seed) << 32) ^ (static_cast<uint64_t>(frame) << 1) ^ channel);
+            if (random.below(signal.period) != 0) {
+                return 0.0f;
+            }
+            float level = DefaultDataBenderConfig::SILENCE_THRESHOLD * static_cast<float>(0.9 + random.unit() * 0.2);
+            return random.below(2) ? level : -level;
+        }
+        default:
+            return 0.0f;
+    }
+}
+
+static Signal randomSignal(Random& random) {
+    Signal signal;
+    signal.kind = random.below(NUM_SIGNALS);
+    signal.amplitude = static_cast<float>(random.unit() < 0.2 ? 1.0 : random.unit());
+    signal.seed = static_cast<unsigned int>(random.next());
+    switch (signal.kind) {
+        case SIGNAL_SINE: signal.period = random.between(2, 2000); break;
+        case SIGNAL_BURSTS: signal.period = random.between(200, 5000); break;
+        case SIGNAL_THRESHOLD: signal.period = random.between(1, 4000); break;
+        default: break;
+    }
+    return signal;
+}
+
+static int randomBlockSize(Random& random) {
+    double choice = random.unit();
+    if (choice < 0.15) {
+        return random.between(1, 8);
+    }
+    if (choice < 0.6) {
+        return random.between(16, 512);
+    }
+    if (choice < 0.85) {
+        return 32 << random.below(8);
+    }
+    return random.between(513, 8192);
+}
+
+static float randomSpeed(Random& random) {
+    // Octave steps as the plugins set them, or anywhere in their range
+    if (random.unit() < 0.5) {
+        static const float octaves[] = { 0.25f, 0.5f, 1.0f, 2.0f, 4.0f };
+        return octaves[random.below(5)];
+    }
+    return static_cast<float>(0.25 + random.unit() * 3.75);
+}
+
+static FuzzCase generateCase(uint64_t seed, int config, int maxFrames) {
+    Random random(seed);
+    FuzzCase fuzzCase;
+    fuzzCase.config = config;
+    fuzzCase.seed = static_cast<unsigned int>(random.next()) | 1u;
+    fuzzCase.doubleIO = random.unit() < 0.2;
+
+    long target = maxFrames / 4 + random.below(maxFrames - maxFrames / 4);
+    long total = 0;
+    bool frozen = false;
+    Signal signal = randomSignal(random);
+    while (total < target) {
+        Block block;
+        block.frames = randomBlockSize(random);
+        block.driver = random.below(fuzzCase.doubleIO ? DRIVER_SAMPLE : NUM_DRIVERS);
+
+        // Signals last several blocks, so silent stretches get trimmed
+        if (random.unit() < block.frames / 3000.0) {
+            signal = randomSignal(random);
+        }
+        block.signal = signal;
+
+        // Frozen stretches run longer than recorded ones, so takes loop
+        // and repeats get to jump
+        if (random.unit() < block.frames / (frozen ? 30000.0 : 12000.0)) {
+            frozen = !frozen;
+            block.events.push_back({ random.between(0, block.frames), EVENT_FREEZE, frozen ? 1.0f : 0.0f });
+        }
+        bool first = fuzzCase.blocks.empty();
+        if (random.unit() < (first ? 0.5 : block.frames / 8000.0)) {
+            block.events.push_back({ random.between(0, block.frames), EVENT_SPEED, randomSpeed(random) });
+        }
+        if (random.unit() < (first ? 0.7 : block.frames / 8000.0)) {
+            float repeats = random.unit() < 0.5 ? 1.0f : static_cast<float>(random.unit());
+            block.events.push_back({ random.between(0, block.frames), EVENT_REPEATS, repeats });
+        }
+        if (random.unit() < block.frames / 150000.0) {
+            block.events.push_back({ random.between(0, block.frames), EVENT_CLEAR, 0.0f });
+        }
+        std::stable_sort(block.events.begin(), block.events.end(),
+                         [](const FuzzEvent& a, const FuzzEvent& b) { return a.offset < b.offset; });
+
+        total += block.frames;
+        fuzzCase.blocks.push_back(block);
+    }
+    return fuzzCase;
+}
+
+static long caseFrames(const FuzzCase& fuzzCase) {
+    long total = 0;
+    for (const Block& block : fuzzCase.blocks) {
+        total += block.frames;
+    }
+    return total;
+}
+
+static size_t caseEvents(const FuzzCase& fuzzCase) {
+    size_t total = 0;
+    for (const Block& block : fuzzCase.blocks) {
+        total += block.events.size();
+    }
+    return total;
+}
+
+//==============================================================================
+// Running a case
+
+template <typename Target>
+static void applySetter(Target& target, const FuzzEvent& event) {
+    switch (event.kind) {
+        case EVENT_FREEZE: target.setFreeze(event.value != 0.0f); break;
+        case EVENT_SPEED: target.setPlaybackSpeed(event.value); break;
+        case EVENT_REPEATS: target.setRepeats(event.value); break;
+        case EVENT_CLEAR: target.clearBuffer(); break;
+    }
+}
+
+// One block through the engine, the way its driver calls it
+template <typename Engine, typename IO>
+static void driveEngine(Engine& engine, const Block& block, const IO* inputL, const IO* inputR,
+                        IO* outputL, IO* outputR) {
+    const std::vector<FuzzEvent>& events = block.events;
+
+    if (block.driver == DRIVER_SAMPLE) {
+        if constexpr (std::is_same<IO, float>::value) {
+            size_t next = 0;
+            for (int i = 0; i < block.frames; ++i) {
+                while (next < events.size() && events[next].offset <= i) {
+                    applySetter(engine, events[next++]);
+                }
+                engine.processSample(inputL[i], inputR[i], outputL[i], outputR[i]);
+            }
+            while (next < events.size()) {
+                applySetter(engine, events[next++]);
+            }
+            return;
+        }
+    }
+
+    if (block.driver == DRIVER_EVENTS) {
+        // Clearing is not an event, so the block is split there
+        std::vector<DataBenderEvent> pending;
+        int position = 0;
+        for (size_t next = 0; next <= events.size(); ++next) {
+            bool last = next == events.size();
+            if (!last && events[next].kind != EVENT_CLEAR) {
+                DataBenderEvent::Type type = events[next].kind == EVENT_FREEZE ? DataBenderEvent::SET_FREEZE
+                                           : events[next].kind == EVENT_SPEED ? DataBenderEvent::SET_PLAYBACK_SPEED
+                                           : DataBenderEvent::SET_REPEATS;
+                pending.push_back({ events[next].offset - position, type, events[next].value });
+                continue;
+            }
+            int end = last ? block.frames : events[next].offset;
+            const IO* inputs[2] = { inputL + position, inputR + position };
+            IO* outputs[2] = { outputL + position, outputR + position };
+            engine.process(inputs, outputs, end - position, pending.data(), static_cast<int>(pending.size()));
+            pending.clear();
+            position = end;
+            if (!last) {
+                engine.clearBuffer();
+            }
+        }
+        return;
+    }
+
+    // Split at every event, calling the setters in between
+    int position = 0;
+    size_t next = 0;
+    while (position < block.frames || next < events.size()) {
+        int end = next < events.size() ? std::min(events[next].offset, block.frames) : block.frames;
+        if (end > position) {
+            const IO* inputs[2] = { inputL + position, inputR + position };
+            IO* outputs[2] = { outputL + position, outputR + position };
+            engine.process(inputs, outputs, end - position);
+            position = end;
+        }
+        if (next < events.size()) {
+            applySetter(engine, events[next++]);
+        }
+    }
+}
+
+static bool sameSample(double expected, double actual, double tolerance) {
+    if (std::isnan(expected) || std::isnan(actual)) {
+        return std::isnan(expected) && std::isnan(actual);
+    }
+    return tolerance > 0.0 ? std::fabs(actual - expected) <= tolerance : actual == expected;
+}
+
+template <typename Config, typename IO>
+static Mismatch runTyped(const FuzzCase& fuzzCase, double tolerance, ReferenceCoverage* coverage) {
+    using Engine = BasicDataBenderEngine<Config>;
+    std::unique_ptr<Engine> engine(new Engine());
+    std::unique_ptr<ReferenceEngine<Config>> reference(new ReferenceEngine<Config>());
+    engine->init(SAMPLE_RATE);
+    engine->setRandomSeed(fuzzCase.seed);
+    reference->setRandomSeed(fuzzCase.seed);
+
+    std::vector<IO> inputL, inputR, outputL, outputR, expectedL, expectedR;
+    Mismatch mismatch;
+    long caseFrame = 0;
+    for (size_t index = 0; index < fuzzCase.blocks.size(); ++index) {
+        const Block& block = fuzzCase.blocks[index];
+        inputL.resize(block.frames);
+        inputR.resize(block.frames);
+        outputL.assign(block.frames, IO(0));
+        outputR.assign(block.frames, IO(0));
+        expectedL.resize(block.frames);
+        expectedR.resize(block.frames);
+        for (int i = 0; i < block.frames; ++i) {
+            inputL[i] = signalValue(block.signal, i, 0);
+            inputR[i] = signalValue(block.signal, i, 1);
+        }
+
+        // Reference: a frame at a time, events before the frame they land on
+        size_t next = 0;
+        for (int i = 0; i < block.frames; ++i) {
+            while (next < block.events.size() && block.events[next].offset <= i) {
+                applySetter(*reference, block.events[next++]);
+            }
+            reference->processFrame(inputL[i], inputR[i], expectedL[i], expectedR[i]);
+        }
+        while (next < block.events.size()) {
+            applySetter(*reference, block.events[next++]);
+        }
+
+        driveEngine(*engine, block, inputL.data(), inputR.data(), outputL.data(), outputR.data());
+
+        for (int i = 0; i < block.frames && !mismatch.found; ++i) {
+            for (int channel = 0; channel < 2; ++channel) {
+                double expected = channel == 0 ? expectedL[i] : expectedR[i];
+                double actual = channel == 0 ? outputL[i] : outputR[i];
+                if (!sameSample(expected, actual, tolerance)) {
+                    mismatch.found = true;
+                    mismatch.frame = caseFrame + i;
+                    mismatch.channel = channel;
+                    mismatch.expected = expected;
+                    mismatch.actual = actual;
+                    mismatch.what = "output";
+                    break;
+                }
+            }
+        }
+        if (!mismatch.found && engine->getFreeze() != reference->getFreeze()) {
+            mismatch.found = true;
+            mismatch.frame = caseFrame + block.frames;
+            mismatch.expected = reference->getFreeze();
+            mismatch.actual = engine->getFreeze();
+            mismatch.what = "freeze state";
+        }
+        if (!mismatch.found && engine->getFreeze() && engine->getTrimmedLength() != reference->getTrimmedLength()) {
+            mismatch.found = true;
+            mismatch.frame = caseFrame + block.frames;
+            mismatch.expected = reference->getTrimmedLength();
+            mismatch.actual = engine->getTrimmedLength();
+            mismatch.what = "trimmed length";
+        }
+        if (mismatch.found) {
+            mismatch.block = static_cast<int>(index);
+            break;
+        }
+        caseFrame += block.frames;
+    }
+
+    if (coverage) {
+        const ReferenceCoverage& run = reference->getCoverage();
+        coverage->passthroughFrames += run.passthroughFrames;
+        coverage->rawFrames += run.rawFrames;
+        coverage->trimmedFrames += run.trimmedFrames;
+        coverage->jumps += run.jumps;
+        coverage->loops += run.loops;
+    }
+    return mismatch;
+}
+
+template <typename Config>
+static Mismatch runConfig(const FuzzCase& fuzzCase, double tolerance, ReferenceCoverage* coverage) {
+    return fuzzCase.doubleIO ? runTyped<Config, double>(fuzzCase, tolerance, coverage)
+                             : runTyped<Config, float>(fuzzCase, tolerance, coverage);
+}
+
+static Mismatch runCase(const FuzzCase& fuzzCase, double tolerance, ReferenceCoverage* coverage = nullptr) {
+    switch (fuzzCase.config) {
+        case CONFIG_LINEAR: return runConfig<FuzzLinearConfig>(fuzzCase, tolerance, coverage);
+        case CONFIG_MONO16: return runConfig<FuzzMono16Config>(fuzzCase, tolerance, coverage);
+        case CONFIG_RAW: return runConfig<FuzzRawConfig>(fuzzCase, tolerance, coverage);
+        case CONFIG_LOOPER: return runConfig<FuzzLooperConfig>(fuzzCase, tolerance, coverage);
+        case CONFIG_DEFAULT: return runConfig<DefaultDataBenderConfig>(fuzzCase, tolerance, coverage);
+        default: return runConfig<FuzzConfig>(fuzzCase, tolerance, coverage);
+    }
+}
+
+//==============================================================================
+// Minimizing
+
+// Greedy reduction: keep any simplification that still fails
+static FuzzCase minimize(FuzzCase fuzzCase, double tolerance, Mismatch& mismatch) {
+    static constexpr int MAX_ATTEMPTS = 3000;
+    int attempts = 0;
+    auto stillFails = [&](const FuzzCase& candidate) {
+        ++attempts;
+        Mismatch result = runCase(candidate, tolerance);
+        if (result.found) {
+            mismatch = result;
+        }
+        return result.found;
+    };
+
+    // Nothing after the first differing block matters
+    fuzzCase.blocks.resize(mismatch.block + 1);
+
+    bool progress = true;
+    while (progress && attempts < MAX_ATTEMPTS) {
+        progress = false;
+
+        // Runs of blocks, longest first
+        for (size_t run = fuzzCase.blocks.size() / 2; run >= 1 && attempts < MAX_ATTEMPTS; run /= 2) {
+            for (size_t start = 0; start + run <= fuzzCase.blocks.size() && fuzzCase.blocks.size() > 1;) {
+                FuzzCase candidate = fuzzCase;
+                candidate.blocks.erase(candidate.blocks.begin() + start, candidate.blocks.begin() + start + run);
+                if (stillFails(candidate)) {
+                    fuzzCase = candidate;
+                    fuzzCase.blocks.resize(std::min(fuzzCase.blocks.size(), static_cast<size_t>(mismatch.block + 1)));
+                    progress = true;
+                } else {
+                    start += run;
+                }
+            }
+        }
+
+        // Single events
+        for (size_t index = 0; index < fuzzCase.blocks.size(); ++index) {
+            for (size_t event = 0; event < fuzzCase.blocks[index].events.size();) {
+                FuzzCase candidate = fuzzCase;
+                candidate.blocks[index].events.erase(candidate.blocks[index].events.begin() + event);
+                if (stillFails(candidate)) {
+                    fuzzCase = candidate;
+                    progress = true;
+                } else {
+                    ++event;
+                }
+            }
+        }
+
+        // Shorter blocks, simpler signals and the plainest driver
+        for (size_t index = 0; index < fuzzCase.blocks.size(); ++index) {
+            Block& block = fuzzCase.blocks[index];
+            if (block.frames > 1) {
+                FuzzCase candidate = fuzzCase;
+                Block& shorter = candidate.blocks[index];
+                shorter.frames = block.frames / 2;
+                for (FuzzEvent& event : shorter.events) {
+                    event.offset = static_cast<int>(static_cast<long>(event.offset) * shorter.frames / block.frames);
+                }
+                if (stillFails(candidate)) {
+                    fuzzCase = candidate;
+                    progress = true;
+                }
+            }
+            if (fuzzCase.blocks[index].signal.kind != SIGNAL_SILENCE) {
+                FuzzCase candidate = fuzzCase;
+                candidate.blocks[index].signal = Signal();
+                if (stillFails(candidate)) {
+                    fuzzCase = candidate;
+                    progress = true;
+                }
+            }
+            if (fuzzCase.blocks[index].driver != DRIVER_SPLIT) {
+                FuzzCase candidate = fuzzCase;
+                candidate.blocks[index].driver = DRIVER_SPLIT;
+                if (stillFails(candidate)) {
+                    fuzzCase = candidate;
+                    progress = true;
+                }
+            }
+        }
+
+        if (fuzzCase.doubleIO) {
+            FuzzCase candidate = fuzzCase;
+            candidate.doubleIO = false;
+            if (stillFails(candidate)) {
+                fuzzCase = candidate;
+                progress = true;
+            }
+        }
+    }
+
+    mismatch = runCase(fuzzCase, tolerance);
+    return fuzzCase;
+}
+
+//==============================================================================
+// Case files
+
+static int findName(const char* const* names, int count, const std::string& name) {
+    for (int i = 0; i < count; ++i) {
+        if (name == names[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool saveCase(const FuzzCase& fuzzCase, const std::string& path, const Mismatch& mismatch) {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    file.precision(9);
+    file << "# DataBenderFuzz case - replay with: DataBenderFuzz --replay " << path << "\n";
+    file << "# First difference: " << mismatch.what << " at frame " << mismatch.frame << ", channel "
+         << mismatch.channel << " (reference " << mismatch.expected << ", engine " << mismatch.actual << ")\n";
+    file << "config " << configNames[fuzzCase.config] << "\n";
+    file << "seed " << fuzzCase.seed << "\n";
+    file << "io " << (fuzzCase.doubleIO ? "double" : "float") << "\n";
+    for (const Block& block : fuzzCase.blocks) {
+        file << "block " << block.frames << " " << driverNames[block.driver] << " "
+             << signalNames[block.signal.kind] << " " << block.signal.amplitude << " "
+             << block.signal.period << " " << block.signal.seed << "\n";
+        for (const FuzzEvent& event : block.events) {
+            file << "event " << event.offset << " " << eventNames[event.kind] << " " << event.value << "\n";
+        }
+    }
+    return static_cast<bool>(file);
+}
+
+static bool loadCase(const std::string& path, FuzzCase& fuzzCase, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "cannot open";
+        return false;
+    }
+    fuzzCase = FuzzCase();
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        std::istringstream fields(line);
+        std::string keyword;
+        if (!(fields >> keyword) || keyword[0] == '#') {
+            continue;
+        }
+
+        bool ok = true;
+        std::string name;
+        if (keyword == "config") {
+            ok = static_cast<bool>(fields >> name) && (fuzzCase.config = findName(configNames, NUM_CONFIGS, name)) >= 0;
+        } else if (keyword == "seed") {
+            ok = static_cast<bool>(fields >> fuzzCase.seed);
+        } else if (keyword == "io") {
+            ok = static_cast<bool>(fields >> name) && (name == "float" || name == "double");
+            fuzzCase.doubleIO = name == "double";
+        } else if (keyword == "block") {
+            Block block;
+            std::string driver, signal;
+            ok = static_cast<bool>(fields >> block.frames >> driver >> signal >> block.signal.amplitude >>
+                                   block.signal.period >> block.signal.seed);
+            block.driver = findName(driverNames, NUM_DRIVERS, driver);
+            block.signal.kind = findName(signalNames, NUM_SIGNALS, signal);
+            ok = ok && block.frames >= 0 && block.driver >= 0 && block.signal.kind >= 0 && block.signal.period > 0;
+            fuzzCase.blocks.push_back(block);
+        } else if (keyword == "event") {
+            FuzzEvent event;
+            ok = !fuzzCase.blocks.empty() && static_cast<bool>(fields >> event.offset >> name >> event.value);
+            event.kind = findName(eventNames, NUM_EVENT_KINDS, name);
+            ok = ok && event.kind >= 0 && event.offset >= 0 && event.offset <= fuzzCase.blocks.back().frames &&
+                 (fuzzCase.blocks.back().events.empty() || fuzzCase.blocks.back().events.back().offset <= event.offset);
+            if (ok) {
+                fuzzCase.blocks.back().events.push_back(event);
+            }
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            error = "bad line " + std::to_string(lineNumber);
+            return false;
+        }
+    }
+    for (const Block& block : fuzzCase.blocks) {
+        if (fuzzCase.doubleIO && block.driver == DRIVER_SAMPLE) {
+            error = "processSample blocks need float I/O";
+            return false;
+        }
+    }
+    return true;
+}
+
+//==============================================================================
+
+static void printMismatch(const Mismatch& mismatch) {
+    std::printf("  %s differs at frame %ld (block %d, channel %d): reference %.9g, engine %.9g\n",
+                mismatch.what.c_str(), mismatch.frame, mismatch.block, mismatch.channel,
+                mismatch.expected, mismatch.actual);
+}
+
+static int replay(const Options& options) {
+    std::vector<std::string> paths;
+    for (const std::string& path : options.replay) {
+        if (std::filesystem::is_directory(path)) {
+            for (const auto& entry : std::filesystem::directory_iterator(path)) {
+                if (entry.is_regular_file() && entry.path().extension() == ".txt") {
+                    paths.push_back(entry.path().string());
+                }
+            }
+        } else {
+            paths.push_back(path);
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    int failures = 0;
+    for (const std::string& path : paths) {
+        FuzzCase fuzzCase;
+        std::string error;
+        if (!loadCase(path, fuzzCase, error)) {
+            std::printf("ERROR %s: %s\n", path.c_str(), error.c_str());
+            ++failures;
+            continue;
+        }
+        Mismatch mismatch = runCase(fuzzCase, options.tolerance);
+        std::printf("%s %s\n", mismatch.found ? "FAIL" : "pass", path.c_str());
+        if (mismatch.found) {
+            printMismatch(mismatch);
+            ++failures;
+        }
+    }
+    std::printf("%zu cases replayed, %d failed\n", paths.size(), failures);
+    return failures > 0 ? 1 : 0;
+}
+
+static int fuzz(const Options& options) {
+    int failures = 0;
+    long totalFrames = 0;
+    ReferenceCoverage coverage;
+    for (int i = 0; i < options.cases; ++i) {
+        uint64_t seed = options.seed + static_cast<uint64_t>(i);
+        int config = options.config >= 0 ? options.config : static_cast<int>(seed % NUM_CONFIGS);
+        FuzzCase fuzzCase = generateCase(seed, config, options.maxFrames);
+        totalFrames += caseFrames(fuzzCase);
+
+        Mismatch mismatch = runCase(fuzzCase, options.tolerance, &coverage);
+        if (!mismatch.found) {
+            continue;
+        }
+        ++failures;
+        std::printf("FAIL case seed %llu (%s, %s I/O, %zu blocks)\n", static_cast<unsigned long long>(seed),
+                    configNames[config], fuzzCase.doubleIO ? "double" : "float", fuzzCase.blocks.size());
+        printMismatch(mismatch);
+
+        if (options.minimize) {
+            fuzzCase = minimize(fuzzCase, options.tolerance, mismatch);
+            std::printf("  minimized to %zu blocks, %zu events, %ld frames\n", fuzzCase.blocks.size(),
+                        caseEvents(fuzzCase), caseFrames(fuzzCase));
+            printMismatch(mismatch);
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(options.corpus, error);
+        std::string path = options.corpus + "/case-" + configNames[config] + "-" + std::to_string(seed) + ".txt";
+        if (saveCase(fuzzCase, path, mismatch)) {
+            std::printf("  saved %s\n", path.c_str());
+        } else {
+            std::printf("  could not save %s\n", path.c_str());
+        }
+    }
+    std::printf("%d cases, %ld frames, %d failed\n", options.cases, totalFrames, failures);
+    std::printf("Covered %ld passthrough, %ld raw frozen and %ld trimmed frozen frames, %ld repeat jumps, %ld loops\n",
+                coverage.passthroughFrames, coverage.rawFrames, coverage.trimmedFrames, coverage.jumps, coverage.loops);
+    return failures > 0 ? 1 : 0;
+}
+
+static void printUsage() {
+    std::printf("Usage: DataBenderFuzz [--cases N] [--seed S] [--config small|linear|mono16|raw|looper|default|all]"
+                " [--frames N] [--tolerance T] [--corpus DIR] [--no-minimize] [--replay PATH] [--verbose]\n");
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--cases" && hasValue) {
+            options.cases = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--config" && hasValue) {
+            std::string name = argv[++i];
+            options.config = name == "all" ? -1 : findName(configNames, NUM_CONFIGS, name);
+            if (name != "all" && options.config < 0) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--frames" && hasValue) {
+            options.maxFrames = std::max(100, std::atoi(argv[++i]));
+        } else if (arg == "--tolerance" && hasValue) {
+            options.tolerance = std::max(0.0, std::atof(argv[++i]));
+        } else if (arg == "--corpus" && hasValue) {
+            options.corpus = argv[++i];
+        } else if (arg == "--no-minimize") {
+            options.minimize = false;
+        } else if (arg == "--replay" && hasValue) {
+            options.replay.push_back(argv[++i]);
+        } else if (arg == "--verbose") {
+            options.verbose = true;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // The engine logs every freeze; a fuzz run freezes thousands of times
+    std::streambuf* engineLog = std::cout.rdbuf();
+    if (!options.verbose) {
+        std::cout.rdbuf(nullptr);
+    }
+    int result = options.replay.empty() ? fuzz(options) : replay(options);
+    std::cout.rdbuf(engineLog);
+    std::cout.clear();
+    return result;
+}
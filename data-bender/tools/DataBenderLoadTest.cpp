@@ -0,0 +1,350 @@
+// Host-simulation load test: N DataBenderEngine instances driven from M
+// worker threads the way a DAW graph or VCV Rack would drive them.
+//
+//   DataBenderLoadTest [options]
+//     --instances N    Largest instance count (default 256)
+//     --sweep          Run 1, 2, 4 ... N instead of only N
+//     --threads M      Worker threads (default: hardware concurrency)
+//     --seconds S      Simulated audio per run (default 5)
+//     --block B        Host block size (default 256)
+//     --pattern P      fixed | jitter | vcv | mixed (default mixed)
+//     --no-toggle      Do not randomly toggle freeze/speed/repeats
+//     --rate HZ        Sample rate (default 48000)
+//
+// Reports sustained throughput, per-block latency percentiles, graph cycles
+// that missed their real-time deadline, resident memory per instance and an
+// instances-per-core estimate for capacity planning.
+
+#include "DataBenderEngine.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+enum Pattern {
+    PATTERN_FIXED = 0,  // Constant host block size
+    PATTERN_JITTER,     // Varying block sizes (live input, odd buffer sizes)
+    PATTERN_VCV,        // processSample calls, as VCV Rack's Module::process
+    NUM_PATTERNS
+};
+
+static const char* patternNames[] = { "fixed", "jitter", "vcv" };
+
+struct Options {
+    int maxInstances = 256;
+    bool sweep = false;
+    int threads = 0;
+    float seconds = 5.0f;
+    int blockSize = 256;
+    int pattern = -1; // -1 = mixed
+    bool toggle = true;
+    float sampleRate = 48000.0f;
+};
+
+struct Instance {
+    DataBenderEngine* engine = nullptr;
+    int pattern = PATTERN_FIXED;
+    uint32_t random = 1;
+};
+
+struct WorkerResult {
+    std::vector<uint32_t> blockLatencyNs;
+    uint64_t samples = 0;
+    uint64_t cycles = 0;
+    uint64_t missedCycles = 0;
+    double busyNs = 0.0;
+};
+
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static double residentMegabytes() {
+#if defined(__linux__)
+    FILE* file = std::fopen("/proc/self/statm", "r");
+    if (!file) {
+        return 0.0;
+    }
+    long pages = 0;
+    long resident = 0;
+    if (std::fscanf(file, "%ld %ld", &pages, &resident) != 2) {
+        resident = 0;
+    }
+    std::fclose(file);
+    return resident * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+#else
+    return 0.0;
+#endif
+}
+
+// Random control changes, the way automation or a performer would
+static void maybeToggle(Instance& instance, float sampleRate, int frames) {
+    // On average every half second per instance
+    uint32_t roll = nextRandom(instance.random) % static_cast<uint32_t>(sampleRate * 0.5f);
+    if (roll >= static_cast<uint32_t>(frames)) {
+        return;
+    }
+
+    DataBenderEngine& engine = *instance.engine;
+    switch (nextRandom(instance.random) % 3) {
+        case 0:
+            engine.setFreeze(!engine.getFreeze());
+            break;
+        case 1:
+            engine.setPlaybackSpeed(std::pow(2.0f, static_cast<float>(nextRandom(instance.random) % 5) - 2.0f));
+            break;
+        default:
+            engine.setRepeats((nextRandom(instance.random) % 101) / 100.0f);
+            break;
+    }
+}
+
+static void workerMain(std::vector<Instance*> instances, const Options& options, const std::vector<float>& signal,
+                       std::atomic<bool>& start, WorkerResult& result) {
+    std::vector<float> outL(options.blockSize);
+    std::vector<float> outR(options.blockSize);
+    int signalLength = static_cast<int>(signal.size()) - options.blockSize;
+    uint64_t totalFrames = static_cast<uint64_t>(options.seconds * options.sampleRate);
+    double periodNs = options.blockSize * 1.0e9 / options.sampleRate;
+    uint32_t jitter = 0x12345u + static_cast<uint32_t>(instances.size());
+
+    result.blockLatencyNs.reserve(instances.size() * (totalFrames / options.blockSize + 1));
+
+    while (!start.load()) {
+        std::this_thread::yield();
+    }
+
+    int signalPos = 0;
+    for (uint64_t frame = 0; frame < totalFrames; frame += options.blockSize) {
+        // One graph cycle: every instance on this worker processes one host block
+        Clock::time_point cycleStart = Clock::now();
+
+        for (Instance* instance : instances) {
+            const float* inputs[2] = { signal.data() + signalPos, signal.data() + signalPos };
+            float* outputs[2] = { outL.data(), outR.data() };
+
+            Clock::time_point blockStart = Clock::now();
+            switch (instance->pattern) {
+                case PATTERN_FIXED:
+                    instance->engine->process(inputs, outputs, options.blockSize);
+                    break;
+                case PATTERN_JITTER: {
+                    // Split the host block into uneven pieces
+                    int done = 0;
+                    while (done < options.blockSize) {
+                        int piece = 1 + static_cast<int>(nextRandom(jitter) % options.blockSize);
+                        piece = std::min(piece, options.blockSize - done);
+                        const float* pieceIn[2] = { inputs[0] + done, inputs[1] + done };
+                        float* pieceOut[2] = { outputs[0] + done, outputs[1] + done };
+                        instance->engine->process(pieceIn, pieceOut, piece);
+                        done += piece;
+                    }
+                    break;
+                }
+                default:
+                    for (int i = 0; i < options.blockSize; ++i) {
+                        instance->engine->processSample(inputs[0][i], inputs[1][i], outputs[0][i], outputs[1][i]);
+                    }
+                    break;
+            }
+            result.blockLatencyNs.push_back(static_cast<uint32_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - blockStart).count()));
+            result.samples += options.blockSize;
+        }
+
+        double cycleNs = static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - cycleStart).count());
+        result.busyNs += cycleNs;
+        result.cycles++;
+        if (cycleNs > periodNs) {
+            result.missedCycles++;
+        }
+
+        // Control changes come from the message thread in a real host, so
+        // they happen between cycles and are not timed
+        if (options.toggle) {
+            for (Instance* instance : instances) {
+                maybeToggle(*instance, options.sampleRate, options.blockSize);
+            }
+        }
+
+        signalPos = (signalPos + options.blockSize) % signalLength;
+    }
+}
+
+static void runLoad(int numInstances, const Options& options, const std::vector<float>& signal) {
+    double rssBefore = residentMegabytes();
+
+    std::vector<Instance> instances(numInstances);
+    uint32_t seed = 0xC0FFEEu;
+    for (int i = 0; i < numInstances; ++i) {
+        instances[i].engine = new DataBenderEngine();
+        instances[i].engine->init(options.sampleRate);
+        instances[i].engine->setRandomSeed(nextRandom(seed));
+        instances[i].pattern = options.pattern >= 0 ? options.pattern : i % NUM_PATTERNS;
+        instances[i].random = nextRandom(seed) | 1u;
+
+        // A couple of seconds of material so freezes have something to play
+        std::vector<float> outL(options.blockSize);
+        std::vector<float> outR(options.blockSize);
+        int preroll = static_cast<int>(2.0f * options.sampleRate);
+        for (int frame = 0; frame < preroll; frame += options.blockSize) {
+            int pos = frame % (static_cast<int>(signal.size()) - options.blockSize);
+            const float* inputs[2] = { signal.data() + pos, signal.data() + pos };
+            float* outputs[2] = { outL.data(), outR.data() };
+            instances[i].engine->process(inputs, outputs, options.blockSize);
+        }
+    }
+
+    double rssAfter = residentMegabytes();
+
+    int numThreads = std::max(1, std::min(options.threads, numInstances));
+    std::vector<std::vector<Instance*>> assignments(numThreads);
+    for (int i = 0; i < numInstances; ++i) {
+        assignments[i % numThreads].push_back(&instances[i]);
+    }
+
+    std::vector<WorkerResult> results(numThreads);
+    std::vector<std::thread> workers;
+    std::atomic<bool> start{false};
+    for (int t = 0; t < numThreads; ++t) {
+        workers.emplace_back(workerMain, assignments[t], std::cref(options), std::cref(signal),
+                             std::ref(start), std::ref(results[t]));
+    }
+
+    Clock::time_point wallStart = Clock::now();
+    start = true;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double wallSeconds = std::chrono::duration<double>(Clock::now() - wallStart).count();
+
+    std::vector<uint32_t> latencies;
+    uint64_t samples = 0;
+    uint64_t cycles = 0;
+    uint64_t missed = 0;
+    double busyNs = 0.0;
+    for (auto& result : results) {
+        latencies.insert(latencies.end(), result.blockLatencyNs.begin(), result.blockLatencyNs.end());
+        samples += result.samples;
+        cycles += result.cycles;
+        missed += result.missedCycles;
+        busyNs += result.busyNs;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    auto percentile = [&](double fraction) {
+        if (latencies.empty()) {
+            return 0.0;
+        }
+        size_t index = std::min(latencies.size() - 1, static_cast<size_t>(latencies.size() * fraction));
+        return latencies[index] / 1000.0;
+    };
+
+    // Capacity: how many instances one core sustains in real time, from the
+    // average cost of an instance-second of audio
+    double nsPerInstanceSecond = busyNs / (static_cast<double>(samples) / options.sampleRate);
+    double instancesPerCore = nsPerInstanceSecond > 0.0 ? 1.0e9 / nsPerInstanceSecond : 0.0;
+
+    std::printf("%9d %7d %9.1f %8.2f %10.2f %9.1f %9.1f %9.1f %9.1f %8.2f %10.1f\n",
+                numInstances, numThreads,
+                rssAfter, (rssAfter - rssBefore) / numInstances,
+                samples / wallSeconds / 1.0e6,
+                samples / options.sampleRate / wallSeconds,
+                percentile(0.5), percentile(0.99), percentile(1.0),
+                cycles ? 100.0 * missed / cycles : 0.0,
+                instancesPerCore);
+    std::fflush(stdout);
+
+    for (auto& instance : instances) {
+        delete instance.engine;
+    }
+}
+
+static void printUsage() {
+    std::printf("Usage: DataBenderLoadTest [--instances N] [--sweep] [--threads M] [--seconds S]"
+                " [--block B] [--pattern fixed|jitter|vcv|mixed] [--no-toggle] [--rate HZ]\n");
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    options.threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--instances" && hasValue) {
+            options.maxInstances = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--sweep") {
+            options.sweep = true;
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--seconds" && hasValue) {
+            options.seconds = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--block" && hasValue) {
+            options.blockSize = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--pattern" && hasValue) {
+            std::string name = argv[++i];
+            options.pattern = -1;
+            for (int p = 0; p < NUM_PATTERNS; ++p) {
+                if (name == patternNames[p]) {
+                    options.pattern = p;
+                }
+            }
+            if (options.pattern < 0 && name != "mixed") {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--no-toggle") {
+            options.toggle = false;
+        } else if (arg == "--rate" && hasValue) {
+            options.sampleRate = static_cast<float>(std::atof(argv[++i]));
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // Bursts of tone and noise with gaps, so trimming has real work to do
+    std::vector<float> signal(static_cast<size_t>(options.sampleRate * 4.0f) + options.blockSize);
+    uint32_t noise = 0xBEEFu;
+    for (size_t i = 0; i < signal.size(); ++i) {
+        bool audible = (i / static_cast<size_t>(options.sampleRate * 0.25f)) % 3 != 2;
+        float tone = std::sin(i * 0.031f) * 0.4f;
+        float hiss = (static_cast<float>(nextRandom(noise) & 0xFFFF) / 32768.0f - 1.0f) * 0.05f;
+        signal[i] = audible ? tone + hiss : 0.0f;
+    }
+
+    // Engine control logging would swamp the report
+    std::cout.setstate(std::ios::failbit);
+
+    std::printf("pattern=%s block=%d rate=%.0f seconds=%.1f toggle=%s\n",
+                options.pattern >= 0 ? patternNames[options.pattern] : "mixed",
+                options.blockSize, options.sampleRate, options.seconds, options.toggle ? "on" : "off");
+    std::printf("instances threads   RSS(MB) MB/inst  Msmp/s   realtime  p50(us)   p99(us)   max(us)  miss(%%) inst/core\n");
+
+    if (options.sweep) {
+        for (int n = 1; n < options.maxInstances; n *= 2) {
+            runLoad(n, options, signal);
+        }
+    }
+    runLoad(options.maxInstances, options, signal);
+    return 0;
+}
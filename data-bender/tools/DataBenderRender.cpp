@@ -0,0 +1,292 @@
+// Offline renderer: runs a WAV file through DataBenderEngine.
+//
+//   DataBenderRender input.wav output.wav [options]
+//     --block N        Block size in frames (default 512)
+//     --freeze-at SEC  Freeze the buffer at this time (default: never, repeatable)
+//     --unfreeze-at SEC  Unfreeze at this time (repeatable)
+//     --speed X        Playback speed while frozen (default 1)
+//     --repeats R      Repeats amount 0..1 (default 0)
+//     --speed-at SEC:X Change the speed at this time (repeatable)
+//     --repeats-at SEC:R  Change repeats at this time (repeatable)
+//     --speed-ramp N   Glide speed changes over N samples (default 0)
+//     --slots N        Snapshot slots (default 0)
+//     --snapshot-at SEC:SLOT  Store the frozen take in a slot (repeatable)
+//     --recall-at SEC:SLOT    Play a stored take, -1 = live (repeatable)
+//     --tail SEC       Extra seconds rendered after the input ends (default 0)
+//     --double         Process with double-precision I/O
+//     --compact        Silence-gated capture (silence is never stored)
+//     --snap-onsets    Snap repeat jumps to the nearest onset
+//     --preserve-pitch Speed changes tempo only while frozen (time stretch)
+//     --granular       Granular playback while frozen
+//     --grain-density N   Grains per second (default 20)
+//     --grain-length SEC  Grain length (default 0.05)
+//     --grain-spray SEC   Grain start spread behind the playhead (default 0.1)
+//     --spectral       Spectral freeze while frozen
+//     --spectral-size N   Spectral frame size, a power of two (default 2048)
+//     --stats          Print per-block timing statistics when done
+//     --trace FILE     Write a Chrome/Perfetto trace (DATABENDER_TRACE builds)
+//
+// Freeze and automation are passed to the engine as timestamped events, so
+// the output is sample-exact and does not depend on --block.
+
+#include "DataBenderEngine.hpp"
+#include "TraceRing.hpp"
+#include "WavFile.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// Event stamped with an absolute frame in the render
+struct TimedEvent {
+    int frame;
+    DataBenderEvent::Type type;
+    float value;
+};
+
+// Command-line automation, before conversion to frames
+struct TimedValue {
+    float seconds;
+    DataBenderEvent::Type type;
+    float value;
+};
+
+static void printUsage() {
+    std::cout << "Usage: DataBenderRender input.wav output.wav [--block N] [--freeze-at SEC]"
+              << " [--speed X] [--repeats R] [--speed-at SEC:X] [--repeats-at SEC:R] [--speed-ramp N]"
+              << " [--unfreeze-at SEC] [--slots N] [--snapshot-at SEC:SLOT] [--recall-at SEC:SLOT]"
+              << " [--tail SEC] [--double] [--compact] [--snap-onsets] [--preserve-pitch] [--granular]"
+              << " [--grain-density N] [--grain-length SEC] [--grain-spray SEC] [--spectral] [--spectral-size N]"
+              << " [--stats] [--trace FILE]" << std::endl;
+}
+
+// Runs the input through the engine block by block with I/O of type T
+// (float, or double for the double-precision path)
+template <typename T>
+static void render(DataBenderEngine& engine, const std::vector<T>& inputL, const std::vector<T>& inputR,
+                   std::vector<T>& outputL, std::vector<T>& outputR, int blockSize,
+                   const std::vector<TimedEvent>& timeline) {
+    int inputFrames = static_cast<int>(inputL.size());
+    int totalFrames = static_cast<int>(outputL.size());
+    size_t nextEvent = 0;
+    std::vector<DataBenderEvent> blockEvents;
+    blockEvents.reserve(timeline.size());
+
+    // Input for blocks past (or straddling) the end of the file
+    std::vector<T> padL(blockSize, T(0));
+    std::vector<T> padR(blockSize, T(0));
+
+    for (int frame = 0; frame < totalFrames; frame += blockSize) {
+        int numFrames = std::min(blockSize, totalFrames - frame);
+
+        // Hand this block's events to the engine with block-relative offsets
+        blockEvents.clear();
+        while (nextEvent < timeline.size() && timeline[nextEvent].frame < frame + numFrames) {
+            const TimedEvent& timed = timeline[nextEvent++];
+            blockEvents.push_back({ std::max(0, timed.frame - frame), timed.type, timed.value });
+        }
+
+        const T* inputs[2] = { padL.data(), padR.data() };
+        if (frame + numFrames <= inputFrames) {
+            inputs[0] = inputL.data() + frame;
+            inputs[1] = inputR.data() + frame;
+        } else {
+            int available = std::max(0, inputFrames - frame);
+            std::fill(padL.begin(), padL.end(), T(0));
+            std::fill(padR.begin(), padR.end(), T(0));
+            if (available > 0) {
+                std::copy(inputL.begin() + frame, inputL.end(), padL.begin());
+                std::copy(inputR.begin() + frame, inputR.end(), padR.begin());
+            }
+        }
+
+        T* outputs[2] = { outputL.data() + frame, outputR.data() + frame };
+        engine.process(inputs, outputs, numFrames, blockEvents.data(), static_cast<int>(blockEvents.size()));
+    }
+}
+
+// Parses "SEC:VALUE"
+static bool parseTimedValue(const char* text, float& seconds, float& value) {
+    const char* colon = std::strchr(text, ':');
+    if (!colon) {
+        return false;
+    }
+    seconds = static_cast<float>(std::atof(text));
+    value = static_cast<float>(std::atof(colon + 1));
+    return seconds >= 0.0f;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+
+    std::string inputPath = argv[1];
+    std::string outputPath = argv[2];
+    int blockSize = 512;
+    float speed = 1.0f;
+    float repeats = 0.0f;
+    float tailSeconds = 0.0f;
+    int speedRamp = 0;
+    int slots = 0;
+    std::vector<TimedValue> automation;
+    bool useDouble = false;
+    bool printStats = false;
+    bool compact = false;
+    bool snapOnsets = false;
+    bool preservePitch = false;
+    bool granular = false;
+    float grainDensity = 20.0f;
+    float grainLength = 0.05f;
+    float grainSpray = 0.1f;
+    bool spectral = false;
+    int spectralSize = 2048;
+    std::string tracePath;
+
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--block" && hasValue) {
+            blockSize = std::max(1, std::atoi(argv[++i]));
+        } else if ((arg == "--freeze-at" || arg == "--unfreeze-at") && hasValue) {
+            TimedValue timed;
+            timed.seconds = static_cast<float>(std::atof(argv[++i]));
+            timed.type = DataBenderEvent::SET_FREEZE;
+            timed.value = arg == "--freeze-at" ? 1.0f : 0.0f;
+            automation.push_back(timed);
+        } else if (arg == "--speed" && hasValue) {
+            speed = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--repeats" && hasValue) {
+            repeats = static_cast<float>(std::atof(argv[++i]));
+        } else if ((arg == "--speed-at" || arg == "--repeats-at" || arg == "--snapshot-at" || arg == "--recall-at")
+                   && hasValue) {
+            TimedValue timed;
+            if (arg == "--speed-at") {
+                timed.type = DataBenderEvent::SET_PLAYBACK_SPEED;
+            } else if (arg == "--repeats-at") {
+                timed.type = DataBenderEvent::SET_REPEATS;
+            } else if (arg == "--snapshot-at") {
+                timed.type = DataBenderEvent::TAKE_SNAPSHOT;
+            } else {
+                timed.type = DataBenderEvent::RECALL_SNAPSHOT;
+            }
+            if (!parseTimedValue(argv[++i], timed.seconds, timed.value)) {
+                printUsage();
+                return 1;
+            }
+            automation.push_back(timed);
+        } else if (arg == "--speed-ramp" && hasValue) {
+            speedRamp = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--slots" && hasValue) {
+            slots = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--tail" && hasValue) {
+            tailSeconds = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--double") {
+            useDouble = true;
+        } else if (arg == "--compact") {
+            compact = true;
+        } else if (arg == "--snap-onsets") {
+            snapOnsets = true;
+        } else if (arg == "--preserve-pitch") {
+            preservePitch = true;
+        } else if (arg == "--granular") {
+            granular = true;
+        } else if (arg == "--grain-density" && hasValue) {
+            grainDensity = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--grain-length" && hasValue) {
+            grainLength = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--grain-spray" && hasValue) {
+            grainSpray = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--spectral") {
+            spectral = true;
+        } else if (arg == "--spectral-size" && hasValue) {
+            spectralSize = std::atoi(argv[++i]);
+        } else if (arg == "--stats") {
+            printStats = true;
+        } else if (arg == "--trace" && hasValue) {
+            tracePath = argv[++i];
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    WavFile input;
+    if (!input.read(inputPath)) {
+        std::cerr << "Could not read " << inputPath << std::endl;
+        return 1;
+    }
+
+#ifdef DATABENDER_TRACE
+    if (!tracePath.empty() && !TraceRing::global().startFlusher(tracePath)) {
+        return 1;
+    }
+#else
+    if (!tracePath.empty()) {
+        std::cerr << "Tracing is compiled out - reconfigure with -DDATABENDER_TRACE=ON" << std::endl;
+    }
+#endif
+
+    DataBenderEngine engine;
+    engine.init(input.sampleRate);
+    if (compact) {
+        engine.setCompactCapture(true);
+    }
+    engine.setPlaybackSpeed(speed);
+    engine.setRepeats(repeats);
+    engine.setOnsetSnap(snapOnsets);
+    engine.setPreservePitch(preservePitch);
+    engine.setGranularMode(granular);
+    engine.setGrainDensity(grainDensity);
+    engine.setGrainLength(grainLength);
+    engine.setGrainSpray(grainSpray);
+    if (!engine.setSpectralFrameSize(spectralSize)) {
+        return 1;
+    }
+    engine.setSpectralFreeze(spectral);
+    engine.setSpeedRampLength(speedRamp);
+    engine.setSnapshotSlots(slots);
+    engine.setTimingEnabled(printStats);
+
+    int inputFrames = input.getNumFrames();
+    int totalFrames = inputFrames + static_cast<int>(tailSeconds * input.sampleRate);
+
+    // Absolute-time event list, in render order
+    std::vector<TimedEvent> timeline;
+    for (const TimedValue& timed : automation) {
+        timeline.push_back({ static_cast<int>(timed.seconds * input.sampleRate), timed.type, timed.value });
+    }
+    std::stable_sort(timeline.begin(), timeline.end(),
+                     [](const TimedEvent& a, const TimedEvent& b) { return a.frame < b.frame; });
+    WavFile output;
+    output.sampleRate = input.sampleRate;
+    output.left.resize(totalFrames);
+    output.right.resize(totalFrames);
+
+    if (useDouble) {
+        std::vector<double> inL(input.left.begin(), input.left.end());
+        std::vector<double> inR(input.right.begin(), input.right.end());
+        std::vector<double> outL(totalFrames), outR(totalFrames);
+        render(engine, inL, inR, outL, outR, blockSize, timeline);
+        std::copy(outL.begin(), outL.end(), output.left.begin());
+        std::copy(outR.begin(), outR.end(), output.right.begin());
+    } else {
+        render(engine, input.left, input.right, output.left, output.right, blockSize, timeline);
+    }
+
+#ifdef DATABENDER_TRACE
+    TraceRing::global().stopFlusher();
+#endif
+
+    if (!output.write(outputPath)) {
+        std::cerr << "Could not write " << outputPath << std::endl;
+        return 1;
+    }
+
+    if (printStats) {
+        engine.getStats().dump(std::cout);
+    }
+    return 0;
+}
@@ -0,0 +1,462 @@
+// Real-time safety harness: runs every engine mode inside the RT scope of
+// DataBenderEngine::process and fails if anything in the audio path
+// allocates, frees, locks or makes a blocking call.
+//
+// Only meaningful in a DATABENDER_RT_CHECK build (CMake option of the same
+// name), where the build runs it after linking so regressions fail the build.
+
+#include "DataBenderEngine.hpp"
+#include "RtCheck.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#ifndef DATABENDER_RT_CHECK
+#error "DataBenderRtCheck needs a DATABENDER_RT_CHECK build"
+#endif
+
+static const float SAMPLE_RATE = 44100.0f;
+static const int BLOCK_SIZE = 256;
+
+// Feed bursts of tone separated by silence so trimming finds segments
+static void capture(DataBenderEngine& engine, int numBlocks, bool withSilence) {
+    static float inL[BLOCK_SIZE];
+    static float inR[BLOCK_SIZE];
+    static float outL[BLOCK_SIZE];
+    static float outR[BLOCK_SIZE];
+    static long frame = 0;
+
+    const float* inputs[2] = { inL, inR };
+    float* outputs[2] = { outL, outR };
+
+    for (int block = 0; block < numBlocks; ++block) {
+        for (int i = 0; i < BLOCK_SIZE; ++i, ++frame) {
+            bool audible = !withSilence || (frame / 8192) % 2 == 0;
+            inL[i] = audible ? 0.5f * std::sin(frame * 0.03f) : 0.0f;
+            inR[i] = audible ? 0.5f * std::sin(frame * 0.05f) : 0.0f;
+        }
+        engine.process(inputs, outputs, BLOCK_SIZE);
+    }
+}
+
+// Same signal level well below the silence threshold - no segments, so
+// frozen playback takes the raw (crossfading) path
+static void captureQuiet(DataBenderEngine& engine, int numBlocks) {
+    static float inL[BLOCK_SIZE];
+    static float outL[BLOCK_SIZE];
+    static float outR[BLOCK_SIZE];
+
+    const float* inputs[2] = { inL, inL };
+    float* outputs[2] = { outL, outR };
+
+    for (int block = 0; block < numBlocks; ++block) {
+        for (int i = 0; i < BLOCK_SIZE; ++i) {
+            inL[i] = 0.0005f * std::sin((block * BLOCK_SIZE + i) * 0.02f);
+        }
+        engine.process(inputs, outputs, BLOCK_SIZE);
+    }
+}
+
+static void play(DataBenderEngine& engine, int numBlocks) {
+    static float silence[BLOCK_SIZE];
+    static float outL[BLOCK_SIZE];
+    static float outR[BLOCK_SIZE];
+
+    const float* inputs[2] = { silence, silence };
+    float* outputs[2] = { outL, outR };
+    for (int block = 0; block < numBlocks; ++block) {
+        engine.process(inputs, outputs, BLOCK_SIZE);
+    }
+}
+
+// Freeze or unfreeze with a SET_FREEZE event in the middle of a block, the
+// way hosts deliver automation, so the freeze itself runs inside process()
+static void freezeEvent(DataBenderEngine& engine, bool freeze) {
+    static float silence[BLOCK_SIZE];
+    static float outL[BLOCK_SIZE];
+    static float outR[BLOCK_SIZE];
+
+    const float* inputs[2] = { silence, silence };
+    float* outputs[2] = { outL, outR };
+    DataBenderEvent event = { BLOCK_SIZE / 2, DataBenderEvent::SET_FREEZE, freeze ? 1.0f : 0.0f };
+    engine.process(inputs, outputs, BLOCK_SIZE, &event, 1);
+}
+
+// Blocks until an event freeze prepared in the background has swapped in;
+// one that never does fails the mode
+static int missedFreezes = 0;
+
+static void playUntilFrozen(DataBenderEngine& engine) {
+    for (int block = 0; block < 5000 && !engine.getFreeze(); ++block) {
+        play(engine, 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (!engine.getFreeze()) {
+        ++missedFreezes;
+    }
+}
+
+// Double-precision I/O: capture, then raw frozen playback through the
+// double post filter
+static void processDouble(DataBenderEngine& engine, int numBlocks, bool quiet) {
+    static double inL[BLOCK_SIZE];
+    static double outL[BLOCK_SIZE];
+    static double outR[BLOCK_SIZE];
+
+    const double* inputs[2] = { inL, inL };
+    double* outputs[2] = { outL, outR };
+
+    for (int block = 0; block < numBlocks; ++block) {
+        for (int i = 0; i < BLOCK_SIZE; ++i) {
+            inL[i] = (quiet ? 0.0005 : 0.5) * std::sin((block * BLOCK_SIZE + i) * 0.02);
+        }
+        engine.process(inputs, outputs, BLOCK_SIZE);
+    }
+}
+
+// One processSample call per frame, as VCV Rack drives the module
+static void processSamples(DataBenderEngine& engine, int numFrames, bool quiet) {
+    static long frame = 0;
+    float outL, outR;
+    for (int i = 0; i < numFrames; ++i, ++frame) {
+        float input = (quiet ? 0.0005f : 0.5f) * std::sin(frame * 0.03f);
+        bool audible = (frame / 8192) % 2 == 0;
+        engine.processSample(audible ? input : 0.0f, audible ? input : 0.0f, outL, outR);
+    }
+}
+
+static bool runMode(const char* name, void (*scenario)(DataBenderEngine&)) {
+    // Construction and setup are not real-time; only process() is checked
+    DataBenderEngine* engine = new DataBenderEngine();
+    engine->init(SAMPLE_RATE);
+    engine->setRandomSeed(1234);
+
+    unsigned long before = RtCheck::getViolationCount();
+    int missedBefore = missedFreezes;
+    scenario(*engine);
+    unsigned long found = RtCheck::getViolationCount() - before;
+    bool missed = missedFreezes != missedBefore;
+
+    delete engine;
+
+    std::printf("%-28s %s", name, found == 0 && !missed ? "ok\n" : "FAILED");
+    if (found != 0) {
+        std::printf(" (%lu violations)\n", found);
+    } else if (missed) {
+        std::printf(" (event freeze never landed)\n");
+    }
+    return found == 0 && !missed;
+}
+
+int main() {
+    if (!RtCheck::hooksInstalled()) {
+        std::printf("RT CHECK: hooks are not supported on this platform, skipping\n");
+        return 0;
+    }
+
+    bool ok = true;
+
+    ok &= runMode("passthrough", [](DataBenderEngine& engine) {
+        capture(engine, 400, true);
+    });
+
+    ok &= runMode("trimmed-frozen", [](DataBenderEngine& engine) {
+        capture(engine, 400, true);
+        engine.setFreeze(true);
+        play(engine, 400);
+    });
+
+    ok &= runMode("trimmed-frozen repeats", [](DataBenderEngine& engine) {
+        capture(engine, 400, true);
+        engine.setRepeats(1.0f);
+        engine.setPlaybackSpeed(2.0f);
+        engine.setFreeze(true);
+        play(engine, 2000);
+    });
+
+    ok &= runMode("raw-frozen", [](DataBenderEngine& engine) {
+        captureQuiet(engine, 400);
+        engine.setFreeze(true);
+        play(engine, 400);
+    });
+
+    ok &= runMode("raw-frozen crossfade", [](DataBenderEngine& engine) {
+        captureQuiet(engine, 400);
+        engine.setRepeats(1.0f);
+        engine.setPlaybackSpeed(0.5f);
+        engine.setFreeze(true);
+        play(engine, 2000);
+    });
+
+    ok &= runMode("freeze/unfreeze cycles", [](DataBenderEngine& engine) {
+        for (int cycle = 0; cycle < 4; ++cycle) {
+            capture(engine, 100, true);
+            engine.setFreeze(true);
+            play(engine, 100);
+            engine.setFreeze(false);
+        }
+        engine.clearBuffer();
+        capture(engine, 100, false);
+    });
+
+    ok &= runMode("buffer wrap", [](DataBenderEngine& engine) {
+        // More than 60 seconds so the ring wraps
+        capture(engine, static_cast<int>(62.0f * SAMPLE_RATE / BLOCK_SIZE), true);
+        engine.setFreeze(true);
+        play(engine, 200);
+    });
+
+    ok &= runMode("onset snapping", [](DataBenderEngine& engine) {
+        engine.setOnsetSnap(true);
+        capture(engine, 400, true);
+        engine.setRepeats(1.0f);
+        engine.setFreeze(true);
+        play(engine, 2000);
+        engine.setFreeze(false);
+        captureQuiet(engine, 400);
+        engine.setFreeze(true);
+        play(engine, 2000);
+    });
+
+    ok &= runMode("granular", [](DataBenderEngine& engine) {
+        // Full voice pool over trimmed and then raw takes, with a speed ramp
+        engine.setGranularMode(true);
+        engine.setGrainDensity(2000.0f);
+        engine.setGrainLength(0.05f);
+        capture(engine, 400, true);
+        engine.setFreeze(true);
+        play(engine, 400);
+        engine.setSpeedRampLength(4096);
+        engine.setPlaybackSpeed(-1.5f);
+        play(engine, 400);
+        engine.setFreeze(false);
+        captureQuiet(engine, 400);
+        engine.setFreeze(true);
+        play(engine, 400);
+    });
+
+    ok &= runMode("preserve pitch", [](DataBenderEngine& engine) {
+        // Trimmed then raw takes, with repeats and a speed ramp
+        engine.setPreservePitch(true);
+        capture(engine, 400, true);
+        engine.setRepeats(1.0f);
+        engine.setFreeze(true);
+        play(engine, 400);
+        engine.setSpeedRampLength(4096);
+        engine.setPlaybackSpeed(0.5f);
+        play(engine, 400);
+        engine.setFreeze(false);
+        captureQuiet(engine, 400);
+        engine.setFreeze(true);
+        play(engine, 400);
+    });
+
+    ok &= runMode("spectral freeze", [](DataBenderEngine& engine) {
+        // Trimmed and raw takes, then a snapshot recall and a speed ramp
+        engine.setSpectralFreeze(true);
+        engine.setSnapshotSlots(1);
+        capture(engine, 400, true);
+        engine.setFreeze(true);
+        play(engine, 400);
+        engine.takeSnapshot(0);
+        play(engine, 10);
+        engine.setFreeze(false);
+        captureQuiet(engine, 400);
+        engine.setFreeze(true);
+        play(engine, 400);
+        engine.recallSnapshot(0);
+        engine.setSpeedRampLength(4096);
+        engine.setPlaybackSpeed(0.25f);
+        play(engine, 400);
+    });
+
+    ok &= runMode("compact capture", [](DataBenderEngine& engine) {
+        engine.setCompactCapture(true);
+        capture(engine, 400, true);
+        engine.setRepeats(1.0f);
+        engine.setFreeze(true);
+        play(engine, 400);
+    });
+
+    ok &= runMode("compact capture wrap", [](DataBenderEngine& engine) {
+        // Over 120 seconds of half-silent input fills the compact ring
+        engine.setCompactCapture(true);
+        capture(engine, static_cast<int>(125.0f * SAMPLE_RATE / BLOCK_SIZE), true);
+        engine.setFreeze(true);
+        play(engine, 200);
+    });
+
+    ok &= runMode("snapshots", [](DataBenderEngine& engine) {
+        // Take, overwrite (copy-on-write) and recall frozen takes
+        engine.setSnapshotSlots(2);
+        capture(engine, 400, true);
+        engine.setFreeze(true);
+        engine.takeSnapshot(0);
+        play(engine, 10);
+        engine.setFreeze(false);
+        capture(engine, static_cast<int>(62.0f * SAMPLE_RATE / BLOCK_SIZE), true);
+        engine.setFreeze(true);
+        engine.takeSnapshot(1);
+        play(engine, 10);
+        engine.recallSnapshot(0);
+        play(engine, 200);
+        engine.recallSnapshot(1);
+        play(engine, 200);
+        engine.recallSnapshot(DataBenderEngine::LIVE_TAKE);
+        play(engine, 200);
+    });
+
+    ok &= runMode("rate change", [](DataBenderEngine& engine) {
+        // The converted ring swaps in on the audio thread, once while
+        // recording and once frozen with snapshots waiting
+        engine.setSnapshotSlots(1);
+        engine.setOnsetSnap(true);
+        capture(engine, static_cast<int>(62.0f * SAMPLE_RATE / BLOCK_SIZE), true);
+        engine.convertSampleRate(48000.0f);
+        while (engine.isConvertingSampleRate()) {
+            capture(engine, 1, true);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        engine.setFreeze(true);
+        engine.convertSampleRate(SAMPLE_RATE);
+        engine.takeSnapshot(0);
+        while (engine.isConvertingSampleRate()) {
+            play(engine, 1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        engine.setRepeats(1.0f);
+        play(engine, 400);
+    });
+
+    ok &= runMode("capture bus reader", [](DataBenderEngine& engine) {
+        // Reader freezes the writer's ring, then outlives it
+        DataBenderEngine* writer = new DataBenderEngine();
+        writer->init(SAMPLE_RATE);
+        writer->publishCapture("rt-check");
+        engine.attachCapture("rt-check");
+        capture(*writer, 400, true);
+        capture(engine, 400, true);
+        writer->setFreeze(true);
+        engine.setRepeats(1.0f);
+        engine.setFreeze(true);
+        play(engine, 200);
+        delete writer;
+        play(engine, 200);
+    });
+
+    ok &= runMode("event freeze", [](DataBenderEngine& engine) {
+        // Trimmed and raw takes frozen and released by events, with onset
+        // snapping and then spectral playback
+        engine.setOnsetSnap(true);
+        capture(engine, 400, true);
+        engine.setRepeats(1.0f);
+        freezeEvent(engine, true);
+        play(engine, 400);
+        freezeEvent(engine, false);
+        captureQuiet(engine, 400);
+        freezeEvent(engine, true);
+        play(engine, 400);
+        freezeEvent(engine, false);
+        engine.setSpectralFreeze(true);
+        capture(engine, 400, true);
+        freezeEvent(engine, true);
+        play(engine, 400);
+    });
+
+    ok &= runMode("event freeze wrap", [](DataBenderEngine& engine) {
+        capture(engine, static_cast<int>(62.0f * SAMPLE_RATE / BLOCK_SIZE), true);
+        freezeEvent(engine, true);
+        play(engine, 200);
+    });
+
+    ok &= runMode("event freeze compact", [](DataBenderEngine& engine) {
+        engine.setCompactCapture(true);
+        capture(engine, 400, true);
+        freezeEvent(engine, true);
+        play(engine, 200);
+    });
+
+    ok &= runMode("event freeze reader", [](DataBenderEngine& engine) {
+        DataBenderEngine* writer = new DataBenderEngine();
+        writer->init(SAMPLE_RATE);
+        writer->publishCapture("rt-check-events");
+        engine.attachCapture("rt-check-events");
+        capture(*writer, 400, true);
+        freezeEvent(engine, true);
+        playUntilFrozen(engine);
+        play(engine, 200);
+        delete writer;
+    });
+
+    ok &= runMode("timing enabled", [](DataBenderEngine& engine) {
+        engine.setTimingEnabled(true);
+        capture(engine, 200, true);
+        engine.setFreeze(true);
+        play(engine, 200);
+    });
+
+    ok &= runMode("double precision", [](DataBenderEngine& engine) {
+        processDouble(engine, 400, true);
+        engine.setRepeats(1.0f);
+        engine.setFreeze(true);
+        processDouble(engine, 2000, true);
+        engine.setFreeze(false);
+        processDouble(engine, 200, false);
+        engine.setFreeze(true);
+        processDouble(engine, 400, false);
+    });
+
+    ok &= runMode("per sample", [](DataBenderEngine& engine) {
+        // Trimmed and raw takes with a speed ramp and a snapshot recall, then
+        // again in micro-block mode
+        engine.setSnapshotSlots(1);
+        processSamples(engine, 100000, false);
+        engine.setRepeats(1.0f);
+        engine.setFreeze(true);
+        engine.takeSnapshot(0);
+        processSamples(engine, 50000, false);
+        engine.setFreeze(false);
+        processSamples(engine, 100000, true);
+        engine.setFreeze(true);
+        engine.setSpeedRampLength(4096);
+        engine.setPlaybackSpeed(0.5f);
+        engine.recallSnapshot(0);
+        processSamples(engine, 50000, false);
+        engine.setMicroBlockSize(64);
+        processSamples(engine, 50000, false);
+        engine.setFreeze(false);
+        processSamples(engine, 50000, false);
+    });
+
+    ok &= runMode("long capture", [](DataBenderEngine& engine) {
+        std::string path = "databender-rtcheck-capture.raw";
+        if (!engine.enableLongCapture(path, 30.0f)) {
+            return;
+        }
+        capture(engine, 600, true);
+        engine.setRepeats(0.5f);
+        engine.setFreeze(true);
+        play(engine, 600);
+        engine.disableLongCapture();
+        std::remove(path.c_str());
+    });
+
+    ok &= runMode("long capture event freeze", [](DataBenderEngine& engine) {
+        std::string path = "databender-rtcheck-capture.raw";
+        if (!engine.enableLongCapture(path, 30.0f)) {
+            return;
+        }
+        capture(engine, 600, true);
+        freezeEvent(engine, true);
+        playUntilFrozen(engine);
+        play(engine, 600);
+        freezeEvent(engine, false);
+        engine.disableLongCapture();
+        std::remove(path.c_str());
+    });
+
+    std::printf(ok ? "RT CHECK: all modes real-time safe\n" : "RT CHECK: violations found\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+// Trace ring stress check: several threads push events flat out while the
+// flusher drains, so writers lap the reader and reuse slots it is reading.
+// Every event in the resulting trace must be exactly one push() call - its
+// name, phase and track are all derived from its argument, so fields mixed
+// from two calls are caught.
+//
+// Only meaningful in a DATABENDER_TRACE build (CMake option of the same
+// name), where the build runs it after linking so regressions fail the build.
+
+#include "TraceRing.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef DATABENDER_TRACE
+#error "DataBenderTraceStress needs a DATABENDER_TRACE build"
+#endif
+
+static const int NUM_THREADS = 4;
+static const long MIN_EVENTS = 200000;  // Per thread, and more until the ring has lapped
+static const long MAX_EVENTS = 10000000;
+static const uint32_t TRACK_BASE = 1000000;
+
+static const char* const NAMES[] = { "stress-a", "stress-b", "stress-c", "stress-d", "stress-e" };
+static const int NUM_NAMES = 5;
+static const char PHASES[] = { 'B', 'E', 'i' };
+
+// Event `counter` of thread `thread` - everything follows from its argument
+static const char* nameFor(int thread, long counter) { return NAMES[(counter + thread) % NUM_NAMES]; }
+static char phaseFor(long counter) { return PHASES[counter % 3]; }
+static int64_t argFor(int thread, long counter) { return (static_cast<int64_t>(counter) << 8) | thread; }
+
+static void writer(int thread, long* pushed) {
+    TraceRing& ring = TraceRing::global();
+    long counter = 0;
+    while (counter < MAX_EVENTS && (counter < MIN_EVENTS || ring.getDroppedEvents() == 0)) {
+        ring.push(phaseFor(counter), nameFor(thread, counter), TRACK_BASE + thread, argFor(thread, counter));
+        ++counter;
+    }
+    *pushed = counter;
+}
+
+int main() {
+    const std::string path = "trace-stress.json";
+    TraceRing& ring = TraceRing::global();
+    if (!ring.startFlusher(path)) {
+        return 1;
+    }
+
+    std::vector<std::thread> threads;
+    long pushed[NUM_THREADS] = {};
+    for (int thread = 0; thread < NUM_THREADS; ++thread) {
+        threads.emplace_back(writer, thread, &pushed[thread]);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    ring.stopFlusher();
+
+    long totalPushed = 0;
+    for (long count : pushed) {
+        totalPushed += count;
+    }
+
+    std::ifstream file(path);
+    std::string line;
+    long emitted = 0;
+    long mixed = 0;
+    long lastCounter[NUM_THREADS];
+    double lastTimestamp[NUM_THREADS];
+    for (int thread = 0; thread < NUM_THREADS; ++thread) {
+        lastCounter[thread] = -1;
+        lastTimestamp[thread] = 0.0;
+    }
+
+    while (std::getline(file, line)) {
+        if (line.compare(0, 9, "{\"name\":\"") != 0) {
+            continue;
+        }
+        char name[64] = {};
+        char phase = 0;
+        double timestamp = 0.0;
+        unsigned int track = 0;
+        long long arg = 0;
+        const char* args = std::strstr(line.c_str(), "\"value\":");
+        if (std::sscanf(line.c_str(), "{\"name\":\"%63[^\"]\",\"ph\":\"%c\",\"ts\":%lf,\"pid\":1,\"tid\":%u",
+                        name, &phase, &timestamp, &track) != 4 ||
+            !args || std::sscanf(args, "\"value\":%lld", &arg) != 1) {
+            std::printf("MIXED: Unparseable event: %s\n", line.c_str());
+            ++mixed;
+            continue;
+        }
+        ++emitted;
+
+        // Per thread, counters rise and timestamps never go back
+        int thread = static_cast<int>(arg & 0xff);
+        long counter = static_cast<long>(arg >> 8);
+        bool consistent = thread < NUM_THREADS && counter >= 0 && counter < pushed[thread] &&
+                          track == TRACK_BASE + thread && phase == phaseFor(counter) &&
+                          std::strcmp(name, nameFor(thread, counter)) == 0 &&
+                          counter > lastCounter[thread] && timestamp >= lastTimestamp[thread];
+        if (!consistent) {
+            if (mixed < 10) {
+                std::printf("MIXED: %s\n", line.c_str());
+            }
+            ++mixed;
+            continue;
+        }
+        lastCounter[thread] = counter;
+        lastTimestamp[thread] = timestamp;
+    }
+    file.close();
+    std::remove(path.c_str());
+
+    uint64_t dropped = ring.getDroppedEvents();
+    std::printf("TRACE STRESS: %ld events pushed from %d threads, %ld emitted, %llu dropped, %ld inconsistent\n",
+                totalPushed, NUM_THREADS, emitted, static_cast<unsigned long long>(dropped), mixed);
+
+    if (mixed > 0 || emitted == 0 || emitted > totalPushed) {
+        std::printf("TRACE STRESS: FAILED\n");
+        return 1;
+    }
+    if (dropped == 0) {
+        std::printf("TRACE STRESS: FAILED - the writers never lapped the flusher\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,289 @@
+#pragma once
+
+#include "DataBenderEngine.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Deliberately simple scalar model of what BasicDataBenderEngine<Config>
+// does with capture, freeze, silence trimming, playback speed, repeats and
+// the post filter, for differential testing (see DataBenderFuzz.cpp).
+//
+// Nothing here is optimized. Freezing copies the take out of the ring in
+// chronological order, and trimming concatenates its audible runs into a
+// second copy, so playback is plain indexing with no ring arithmetic, page
+// tables or segment walks. Every value is computed with the same float
+// operations in the same order as the engine, so outputs should match bit
+// for bit.
+//
+// Not modelled: granular, spectral and pitch-preserving playback,
+// snapshots, compact and long capture, onset snapping, speed ramps and
+// sample rate conversion.
+
+// What a run exercised, for judging fuzz coverage
+struct ReferenceCoverage {
+    long passthroughFrames = 0;
+    long rawFrames = 0;
+    long trimmedFrames = 0;
+    long jumps = 0;
+    long loops = 0;
+};
+
+template <typename Config>
+class ReferenceEngine {
+public:
+    using Sample = typename Config::Sample;
+
+    static constexpr int CAPTURE_FRAMES = Config::BUFFER_SECONDS * Config::BUFFER_SAMPLE_RATE;
+    static constexpr int CROSSFADE_LENGTH = Config::CROSSFADE_LENGTH;
+
+    ReferenceEngine() : ringL(CAPTURE_FRAMES), ringR(CAPTURE_FRAMES) {}
+
+    void setRandomSeed(unsigned int seed) { randomState = seed ? seed : 0x9E3779B9u; }
+    void setPlaybackSpeed(float speed) { playbackSpeed = speed; }
+    void setRepeats(float value) { repeats = value; }
+    bool getFreeze() const { return frozen; }
+    int getTrimmedLength() const { return static_cast<int>(trimmedL.size()); }
+    const ReferenceCoverage& getCoverage() const { return coverage; }
+
+    void setFreeze(bool freeze) {
+        if (freeze && !frozen) {
+            buildTake();
+            readPosition = 0.0f;
+            trimmedReadPosition = 0.0f;
+        }
+        frozen = freeze;
+    }
+
+    void clearBuffer() {
+        std::fill(ringL.begin(), ringL.end(), Sample());
+        std::fill(ringR.begin(), ringR.end(), Sample());
+        writePosition = 0;
+        wrapped = false;
+        readPosition = 0.0f;
+        takeL.clear();
+        takeR.clear();
+        trimmedL.clear();
+        trimmedR.clear();
+    }
+
+    template <typename IO>
+    void processFrame(IO inputL, IO inputR, IO& outputL, IO& outputR) {
+        if (!frozen) {
+            outputL = inputL;
+            outputR = inputR;
+            ++coverage.passthroughFrames;
+            record(static_cast<float>(inputL), static_cast<float>(inputR));
+            return;
+        }
+
+        float left = 0.0f;
+        float right = 0.0f;
+        if (!trimmedL.empty()) {
+            ++coverage.trimmedFrames;
+            readTake(trimmedL, trimmedR, trimmedReadPosition, false, left, right);
+            outputL = left;
+            outputR = right;
+            return;
+        }
+        if (takeL.empty()) {
+            outputL = IO(0);
+            outputR = IO(0);
+            return;
+        }
+        ++coverage.rawFrames;
+        readTake(takeL, takeR, readPosition, true, left, right);
+        outputL = left;
+        outputR = right;
+        if constexpr (Config::ENABLE_POST_FILTER) {
+            postFilter(outputL, outputR);
+        }
+    }
+
+private:
+    static float toFloat(Sample value) { return CaptureSample<Sample>::toFloat(value); }
+
+    void record(float inputL, float inputR) {
+        ringL[writePosition] = CaptureSample<Sample>::fromFloat(inputL);
+        ringR[writePosition] = CaptureSample<Sample>::fromFloat(Config::CHANNELS == 2 ? inputR : inputL);
+        if (++writePosition == CAPTURE_FRAMES) {
+            writePosition = 0;
+            wrapped = true;
+        }
+    }
+
+    // Copy the take oldest first, then its audible runs
+    void buildTake() {
+        int length = wrapped ? CAPTURE_FRAMES : writePosition;
+        int oldest = wrapped ? writePosition : 0;
+        takeL.resize(length);
+        takeR.resize(length);
+        for (int i = 0; i < length; ++i) {
+            takeL[i] = toFloat(ringL[(oldest + i) % CAPTURE_FRAMES]);
+            takeR[i] = toFloat(ringR[(oldest + i) % CAPTURE_FRAMES]);
+        }
+
+        trimmedL.clear();
+        trimmedR.clear();
+        if constexpr (Config::ENABLE_TRIMMING) {
+            // Silence is judged a MIN_SILENCE_LENGTH block at a time; a run
+            // of audible blocks is kept when it is long enough
+            int audioStart = -1;
+            for (int block = 0; block < length; block += Config::MIN_SILENCE_LENGTH) {
+                bool silent = true;
+                for (int i = block; i < std::min(block + Config::MIN_SILENCE_LENGTH, length); ++i) {
+                    if (std::abs(takeL[i]) > Config::SILENCE_THRESHOLD || std::abs(takeR[i]) > Config::SILENCE_THRESHOLD) {
+                        silent = false;
+                    }
+                }
+                if (!silent && audioStart < 0) {
+                    audioStart = block;
+                } else if (silent && audioStart >= 0) {
+                    keepAudio(audioStart, block);
+                    audioStart = -1;
+                }
+            }
+            if (audioStart >= 0) {
+                keepAudio(audioStart, length);
+            }
+        }
+    }
+
+    void keepAudio(int start, int end) {
+        if (end - start < Config::MIN_AUDIO_LENGTH) {
+            return;
+        }
+        trimmedL.insert(trimmedL.end(), takeL.begin() + start, takeL.begin() + end);
+        trimmedR.insert(trimmedR.end(), takeR.begin() + start, takeR.begin() + end);
+    }
+
+    // One frame of looped playback with repeats, crossfading where the
+    // playhead loops (and, for raw takes, where it jumps)
+    void readTake(const std::vector<float>& left, const std::vector<float>& right, float& position,
+                  bool crossfadeJumps, float& outputL, float& outputR) {
+        int length = static_cast<int>(left.size());
+        int loopLength = length > 2 * CROSSFADE_LENGTH ? length - CROSSFADE_LENGTH : length;
+
+        if (Config::ENABLE_REPEATS && repeats > 0.0f) {
+            if (randomUnit() < repeats * 0.0003f) {
+                int maxSkipBack = static_cast<int>(repeats * length * 0.02f);
+                int skipBack = randomBelow(maxSkipBack) + length / 200;
+                ++coverage.jumps;
+                if (crossfadeJumps) {
+                    startCrossfade(left, right, static_cast<int>(position));
+                }
+                position = position - skipBack;
+                if (position < 0.0f) {
+                    position = loopLength + position;
+                }
+            }
+        }
+
+        if (position >= loopLength) {
+            ++coverage.loops;
+            if (loopLength < length) {
+                startCrossfade(left, right, static_cast<int>(position));
+            }
+            position -= loopLength;
+            if (position >= loopLength) {
+                position = 0.0f;
+            }
+        }
+
+        int index = static_cast<int>(position);
+        outputL = left[index];
+        outputR = right[index];
+        if constexpr (Config::INTERPOLATION_ORDER == 1) {
+            int next = (index + 1) % length;
+            float fraction = position - index;
+            outputL += (left[next] - outputL) * fraction;
+            outputR += (right[next] - outputR) * fraction;
+        }
+
+        if (inCrossfade) {
+            float fadeOut = 0.5f * (1.0f + std::cos(static_cast<float>(crossfadeIndex) / CROSSFADE_LENGTH * 3.14159f));
+            float fadeIn = 1.0f - fadeOut;
+            outputL = (crossfadeL[crossfadeIndex] * fadeOut) + (outputL * fadeIn);
+            outputR = (crossfadeR[crossfadeIndex] * fadeOut) + (outputR * fadeIn);
+            if (++crossfadeIndex == CROSSFADE_LENGTH) {
+                inCrossfade = false;
+            }
+        }
+
+        position += playbackSpeed;
+    }
+
+    void startCrossfade(const std::vector<float>& left, const std::vector<float>& right, int position) {
+        int length = static_cast<int>(left.size());
+        for (int i = 0; i < CROSSFADE_LENGTH; ++i) {
+            int index = ((position + i) % length + length) % length;
+            crossfadeL[i] = left[index];
+            crossfadeR[i] = right[index];
+        }
+        inCrossfade = true;
+        crossfadeIndex = 0;
+    }
+
+    // DC blocker then one-pole smoother, computed at I/O precision
+    template <typename IO>
+    void postFilter(IO& left, IO& right) {
+        const IO dcGain = IO(1) - IO(PostFilter::DC_BLOCK_COEFF);
+        const IO inputGain = IO(1) - IO(PostFilter::SMOOTHING_FACTOR);
+        const IO feedback = IO(PostFilter::SMOOTHING_FACTOR);
+        IO dcL = static_cast<IO>(dcBlockL);
+        IO dcR = static_cast<IO>(dcBlockR);
+
+        IO outputL = left - dcL;
+        dcL = dcL + (outputL * dcGain);
+        outputL = outputL - dcL;
+        IO outputR = right - dcR;
+        dcR = dcR + (outputR * dcGain);
+        outputR = outputR - dcR;
+
+        left = (outputL * inputGain) + (static_cast<IO>(lastOutputL) * feedback);
+        right = (outputR * inputGain) + (static_cast<IO>(lastOutputR) * feedback);
+        dcBlockL = dcL;
+        dcBlockR = dcR;
+        lastOutputL = left;
+        lastOutputR = right;
+    }
+
+    // xorshift32, as the engine
+    unsigned int nextRandom() {
+        randomState ^= randomState << 13;
+        randomState ^= randomState >> 17;
+        randomState ^= randomState << 5;
+        return randomState;
+    }
+    float randomUnit() { return static_cast<float>(nextRandom() >> 8) * (1.0f / 16777216.0f); }
+    int randomBelow(int range) {
+        return range > 0 ? static_cast<int>(nextRandom() % static_cast<unsigned int>(range)) : 0;
+    }
+
+    std::vector<Sample> ringL;
+    std::vector<Sample> ringR;
+    int writePosition = 0;
+    bool wrapped = false;
+
+    bool frozen = false;
+    std::vector<float> takeL;
+    std::vector<float> takeR;
+    std::vector<float> trimmedL;
+    std::vector<float> trimmedR;
+    float readPosition = 0.0f;
+    float trimmedReadPosition = 0.0f;
+    float playbackSpeed = 1.0f;
+    float repeats = 0.0f;
+    unsigned int randomState = 0x9E3779B9u;
+    ReferenceCoverage coverage;
+
+    float crossfadeL[CROSSFADE_LENGTH];
+    float crossfadeR[CROSSFADE_LENGTH];
+    int crossfadeIndex = 0;
+    bool inCrossfade = false;
+
+    double dcBlockL = 0.0;
+    double dcBlockR = 0.0;
+    double lastOutputL = 0.0;
+    double lastOutputR = 0.0;
+};
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Minimal WAV reader/writer for the offline tools.
+// Reads 16/24/32-bit PCM and 32-bit float, mono or stereo, into planar
+// float channels. Writes 32-bit float stereo.
+struct WavFile {
+    float sampleRate = 44100.0f;
+    std::vector<float> left;
+    std::vector<float> right;
+
+    int getNumFrames() const { return static_cast<int>(left.size()); }
+
+    bool read(const std::string& path) {
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+
+        std::vector<uint8_t> bytes;
+        uint8_t chunk[65536];
+        size_t count;
+        while ((count = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            bytes.insert(bytes.end(), chunk, chunk + count);
+        }
+        std::fclose(file);
+
+        if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0 || std::memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+            return false;
+        }
+
+        int format = 0;
+        int channels = 0;
+        int bitsPerSample = 0;
+        const uint8_t* data = nullptr;
+        size_t dataSize = 0;
+
+        size_t pos = 12;
+        while (pos + 8 <= bytes.size()) {
+            uint32_t size = readU32(&bytes[pos + 4]);
+            const uint8_t* body = &bytes[pos + 8];
+            if (pos + 8 + size > bytes.size()) {
+                size = static_cast<uint32_t>(bytes.size() - pos - 8);
+            }
+
+            if (std::memcmp(&bytes[pos], "fmt ", 4) == 0 && size >= 16) {
+                format = body[0] | (body[1] << 8);
+                channels = body[2] | (body[3] << 8);
+                sampleRate = static_cast<float>(readU32(body + 4));
+                bitsPerSample = body[14] | (body[15] << 8);
+                // WAVE_FORMAT_EXTENSIBLE keeps the real format in the sub-format GUID
+                if (format == 0xFFFE && size >= 26) {
+                    format = body[24] | (body[25] << 8);
+                }
+            } else if (std::memcmp(&bytes[pos], "data", 4) == 0) {
+                data = body;
+                dataSize = size;
+            }
+            pos += 8 + size + (size & 1);
+        }
+
+        if (!data || channels < 1 || (format != 1 && format != 3)) {
+            return false;
+        }
+
+        int bytesPerSample = bitsPerSample / 8;
+        size_t numFrames = dataSize / (bytesPerSample * channels);
+        left.resize(numFrames);
+        right.resize(numFrames);
+
+        for (size_t i = 0; i < numFrames; ++i) {
+            const uint8_t* frame = data + i * bytesPerSample * channels;
+            left[i] = decode(frame, format, bitsPerSample);
+            right[i] = channels > 1 ? decode(frame + bytesPerSample, format, bitsPerSample) : left[i];
+        }
+        return true;
+    }
+
+    bool write(const std::string& path) const {
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+
+        uint32_t numFrames = static_cast<uint32_t>(left.size());
+        uint32_t dataSize = numFrames * 2 * sizeof(float);
+        uint32_t rate = static_cast<uint32_t>(sampleRate);
+
+        uint8_t header[44];
+        std::memcpy(header, "RIFF", 4);
+        writeU32(header + 4, 36 + dataSize);
+        std::memcpy(header + 8, "WAVEfmt ", 8);
+        writeU32(header + 16, 16);
+        writeU16(header + 20, 3); // IEEE float
+        writeU16(header + 22, 2);
+        writeU32(header + 24, rate);
+        writeU32(header + 28, rate * 2 * sizeof(float));
+        writeU16(header + 32, 2 * sizeof(float));
+        writeU16(header + 34, 32);
+        std::memcpy(header + 36, "data", 4);
+        writeU32(header + 40, dataSize);
+        std::fwrite(header, 1, sizeof(header), file);
+
+        std::vector<float> interleaved(numFrames * 2);
+        for (uint32_t i = 0; i < numFrames; ++i) {
+            interleaved[i * 2] = left[i];
+            interleaved[i * 2 + 1] = right[i];
+        }
+        std::fwrite(interleaved.data(), sizeof(float), interleaved.size(), file);
+        std::fclose(file);
+        return true;
+    }
+
+private:
+    static uint32_t readU32(const uint8_t* p) {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    static void writeU32(uint8_t* p, uint32_t value) {
+        p[0] = value & 0xFF;
+        p[1] = (value >> 8) & 0xFF;
+        p[2] = (value >> 16) & 0xFF;
+        p[3] = (value >> 24) & 0xFF;
+    }
+
+    static void writeU16(uint8_t* p, uint16_t value) {
+        p[0] = value & 0xFF;
+        p[1] = (value >> 8) & 0xFF;
+    }
+
+    static float decode(const uint8_t* p, int format, int bitsPerSample) {
+        if (format == 3) {
+            float value;
+            std::memcpy(&value, p, sizeof(float));
+            return value;
+        }
+        switch (bitsPerSample) {
+            case 16: return static_cast<int16_t>(p[0] | (p[1] << 8)) / 32768.0f;
+            case 24: return static_cast<int32_t>((p[0] << 8) | (p[1] << 16) | (static_cast<uint32_t>(p[2]) << 24)) / 2147483648.0f;
+            case 32: return static_cast<int32_t>(readU32(p)) / 2147483648.0f;
+            default: return 0.0f;
+        }
+    }
+};
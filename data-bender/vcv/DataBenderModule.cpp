@@ -17,24 +17,38 @@ DataBenderModule::DataBenderModule() {
 }
 
 void DataBenderModule::process(const ProcessArgs& args) {
-    // Prepare input arrays
-    const float* inputs[2] = {
-        inputs[INPUT_L].getVoltages(),
-        inputs[INPUT_R].getVoltages()
-    };
-    
-    // Prepare output arrays
-    float* outputs[2] = {
-        outputs[OUTPUT_L].getVoltages(),
-        outputs[OUTPUT_R].getVoltages()
-    };
-    
-    // Process audio through the engine
-    engine.process(inputs, outputs, args.samples);
+    // Menu changes land here, between frames
+    int microBlock = microBlockRequest.load(std::memory_order_relaxed);
+    if (microBlock != engine.getMicroBlockSize()) {
+        engine.setMicroBlockSize(microBlock);
+    }
+    
+    // Rack calls once per frame; a lone left input feeds both channels
+    float inputL = inputs[INPUT_L].getVoltage();
+    float inputR = inputs[INPUT_R].getNormalVoltage(inputL);
+    float outputL, outputR;
+    engine.processSample(inputL / VOLTAGE_SCALE, inputR / VOLTAGE_SCALE, outputL, outputR);
+    
+    outputs[OUTPUT_L].setVoltage(outputL * VOLTAGE_SCALE);
+    outputs[OUTPUT_R].setVoltage(outputR * VOLTAGE_SCALE);
 }
 
 void DataBenderModule::onSampleRateChange() {
-    engine.setSampleRate(APP->engine->getSampleRate());
+    // Keep the capture, converted to the new rate in the background
+    engine.convertSampleRate(APP->engine->getSampleRate());
+}
+
+json_t* DataBenderModule::dataToJson() {
+    json_t* rootJ = json_object();
+    json_object_set_new(rootJ, "microBlock", json_integer(microBlockRequest.load()));
+    return rootJ;
+}
+
+void DataBenderModule::dataFromJson(json_t* rootJ) {
+    json_t* microBlockJ = json_object_get(rootJ, "microBlock");
+    if (microBlockJ) {
+        microBlockRequest = static_cast<int>(json_integer_value(microBlockJ));
+    }
 }
 
 // DataBenderWidget implementation
@@ -55,4 +69,45 @@ DataBenderWidget::DataBenderWidget(DataBenderModule* module) {
     // Add outputs
     addOutput(createOutputCentered<PJ301MPort>(mm2px(Vec(7.5, 85)), module, DataBenderModule::OUTPUT_L));
     addOutput(createOutputCentered<PJ301MPort>(mm2px(Vec(22.5, 85)), module, DataBenderModule::OUTPUT_R));
-} 
\ No newline at end of file
+} 
+
+void DataBenderWidget::appendContextMenu(Menu* menu) {
+    DataBenderModule* module = dynamic_cast<DataBenderModule*>(this->module);
+    if (!module) {
+        return;
+    }
+    
+    menu->addChild(new MenuSeparator);
+    
+    // Cheaper processing for a few samples of latency
+    static const int microBlocks[] = { 0, 16, 32, 64, 128 };
+    menu->addChild(createIndexSubmenuItem("Micro-block",
+        { "Off", "16 samples latency", "32 samples latency", "64 samples latency", "128 samples latency" },
+        [=]() {
+            int current = module->microBlockRequest.load();
+            for (int i = 0; i < 5; ++i) {
+                if (microBlocks[i] == current) {
+                    return static_cast<size_t>(i);
+                }
+            }
+            return static_cast<size_t>(0);
+        },
+        [=](size_t index) { module->microBlockRequest = microBlocks[index]; }
+    ));
+    
+    menu->addChild(createBoolMenuItem("Timing statistics", "",
+        [=]() { return module->engine.isTimingEnabled(); },
+        [=](bool enabled) { module->engine.setTimingEnabled(enabled); }
+    ));
+    
+    if (module->engine.isTimingEnabled()) {
+        EngineStats::Snapshot total = module->getEngineStats().getTotal();
+        menu->addChild(createMenuLabel(string::f("p99 %.1f ns/sample, max %.1f ns/sample",
+            total.p99NsPerSample, total.maxNsPerSample)));
+        menu->addChild(createMenuLabel(string::f("Overruns: %llu",
+            (unsigned long long) module->getEngineStats().getOverruns())));
+        menu->addChild(createMenuItem("Reset statistics", "",
+            [=]() { module->engine.getStats().reset(); }
+        ));
+    }
+}
@@ -2,6 +2,7 @@
 
 #include "rack.hpp"
 #include "../core/DataBenderEngine.hpp"
+#include <atomic>
 
 using namespace rack;
 
@@ -27,15 +28,29 @@ struct DataBenderModule : Module {
         NUM_LIGHTS
     };
     
+    // Rack audio is +-5V and the engine works in +-1.0 full scale, so
+    // inputs are divided by 5 and outputs multiplied back
+    static constexpr float VOLTAGE_SCALE = 5.0f;
+    
     DataBenderEngine engine;
     
+    // Micro-block size chosen in the menu (0 = off), applied by process()
+    std::atomic<int> microBlockRequest{0};
+    
     DataBenderModule();
     
     void process(const ProcessArgs& args) override;
     void onSampleRateChange() override;
+    json_t* dataToJson() override;
+    void dataFromJson(json_t* rootJ) override;
+    
+    // Per-block timing statistics
+    const EngineStats& getEngineStats() const { return engine.getStats(); }
 };
 
 // VCV Rack Widget
 struct DataBenderWidget : ModuleWidget {
     DataBenderWidget(DataBenderModule* module);
+    
+    void appendContextMenu(Menu* menu) override;
 }; 
\ No newline at end of file